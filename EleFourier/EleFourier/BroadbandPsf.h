@@ -0,0 +1,370 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_BROADBANDPSF_H
+#define _ELEFOURIER_BROADBANDPSF_H
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/PrunedDft.h"
+
+#include <algorithm> // copy_n, fill_n
+#include <atomic>
+#include <complex>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <utility> // forward, pair
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Polychromatic PSF engine, which integrates monochromatic PSFs over wavelengths in parallel.
+ * @tparam T The real value type
+ * @details
+ * For each parameter (e.g. a field position or a set of Zernike coefficients) and each wavelength,
+ * the engine computes:
+ * - The pupil amplitude, with a user-provided function;
+ * - The PSF amplitude, with a complex DFT of the pupil shape;
+ * - The PSF intensity, i.e. the squared modulus of the amplitude;
+ * - The MTF on the broadband frequency grid, with a real `PrunedDft` which subsamples the output
+ *   by the ratio of the pupil shape to the broadband shape;
+ * and accumulates the MTFs of the wavelengths.
+ * Then, for each parameter, the broadband PSF is the normalized inverse real DFT of the MTF sum.
+ *
+ * Each thread owns a set of plans and an MTF accumulator, created at construction by the thread itself,
+ * such that their pages are first touched by it (by planning or by the first pupil), i.e. are local to its NUMA node.
+ * The (parameter, wavelength) work items are distributed dynamically, one at a time, from a shared atomic counter,
+ * which balances uneven per-wavelength costs.
+ * Items are enumerated parameter-major, such that consecutive items of a thread mostly share a parameter:
+ * the thread accumulates into its private accumulator, and adds it to the shared sum of the parameter
+ * (under a per-parameter lock) only when it switches to another parameter.
+ * Accumulators and sums are distinct allocations of whole planes, which prevents false sharing.
+ *
+ * \code
+ * BroadbandPsf engine({1024, 1024}, {512, 512});
+ * const auto psfs = engine.run(params, lambdas, [&](long p, long l, Fits::PtrRaster<std::complex<double>>& pupil) {
+ *   phases[p].evalAmplitude(wavelengths[l], pupil); // Must be thread-safe
+ * });
+ * const auto broadband = psfs.section(0); // Broadband PSF of the first parameter
+ * \endcode
+ */
+template <typename T>
+class BasicBroadbandPsf {
+
+public:
+  /**
+   * @brief The pupil amplitude value type.
+   */
+  using Complex = std::complex<T>;
+
+  /**
+   * @brief Constructor.
+   * @param pupilShape The pupil shape, a multiple of the broadband shape
+   * @param broadbandShape The broadband PSF shape
+   * @param threads The number of threads, or 0 for `omp_get_max_threads()`
+   * @param policy The planning policy
+   */
+  BasicBroadbandPsf(
+      const Fits::Position<2>& pupilShape,
+      const Fits::Position<2>& broadbandShape,
+      long threads = 0,
+      const PlanningPolicy& policy = PlanningPolicy()) :
+      m_pupilShape(pupilShape), m_broadbandShape(broadbandShape), m_stride(ratio(pupilShape, broadbandShape)),
+      m_workers(threads > 0 ? threads : omp_get_max_threads()), m_items(m_workers.size(), 0) {
+    const long count = m_workers.size();
+#pragma omp parallel for schedule(static, 1) num_threads(count)
+    for (long t = 0; t < count; ++t) {
+      m_workers[t].reset(new Worker(m_pupilShape, m_broadbandShape, m_stride, policy));
+    }
+  }
+
+  /**
+   * @brief Get the pupil shape.
+   */
+  const Fits::Position<2>& pupilShape() const {
+    return m_pupilShape;
+  }
+
+  /**
+   * @brief Get the broadband PSF shape.
+   */
+  const Fits::Position<2>& broadbandShape() const {
+    return m_broadbandShape;
+  }
+
+  /**
+   * @brief Get the number of threads.
+   */
+  long threads() const {
+    return m_workers.size();
+  }
+
+  /**
+   * @brief Get the number of work items processed by each thread during the last run.
+   */
+  const std::vector<long>& itemCounts() const {
+    return m_items;
+  }
+
+  /**
+   * @brief Compute the broadband PSFs.
+   * @param params The number of parameters
+   * @param lambdas The number of wavelengths
+   * @param pupil The pupil function `pupil(param, lambda, plane)`,
+   *        which fills `plane` (a `Fits::PtrRaster<std::complex<T>>` of the pupil shape) and must be thread-safe
+   * @return The stack of broadband PSFs, one plane per parameter
+   * @details
+   * This is `integrate(accumulate(params, lambdas, 0, params * lambdas, pupil))`.
+   * If the pupil function throws, the remaining items are skipped, and the first exception is rethrown.
+   */
+  template <typename TPupil>
+  Fits::VecRaster<T, 3> run(long params, long lambdas, TPupil&& pupil) {
+    auto sums = accumulate(params, lambdas, 0, params * lambdas, std::forward<TPupil>(pupil));
+    sums.resize(params, std::vector<Complex>(mtfSize(), Complex(0))); // Without wavelengths, no parameter is touched
+    return integrate(sums);
+  }
+
+  /**
+   * @brief Compute the range of the parameters of a range of work items.
+   * @param lambdas The number of wavelengths
+   * @param begin The first item
+   * @param end The item past the last one
+   * @return The first parameter and the parameter past the last one, or `{0, 0}` for an empty range
+   */
+  static std::pair<long, long> paramRange(long lambdas, long begin, long end) {
+    if (end <= begin) {
+      return {0, 0};
+    }
+    return {begin / lambdas, (end - 1) / lambdas + 1};
+  }
+
+  /**
+   * @brief Compute the MTF sums of a range of work items.
+   * @param params The number of parameters
+   * @param lambdas The number of wavelengths
+   * @param begin The first item, where item `i` is parameter `i / lambdas` and wavelength `i % lambdas`
+   * @param end The item past the last one
+   * @param pupil The pupil function, as for `run()`
+   * @return The MTF sums of the parameters of the range (see `paramRange()`), one per parameter
+   * @details
+   * This is the first stage of `run()`, which allows splitting the items, e.g. across processes
+   * (see `BasicMpiBroadbandPsf`), and adding the partial sums before `integrate()`.
+   * Only the parameters of the range are allocated, such that memory scales with the range and not with `params`.
+   */
+  template <typename TPupil>
+  std::vector<std::vector<Complex>> accumulate(long params, long lambdas, long begin, long end, TPupil&& pupil) {
+    if (begin < 0 || end < begin || end > params * lambdas) {
+      throw std::invalid_argument(
+          "Invalid item range [" + std::to_string(begin) + ", " + std::to_string(end) + ") for " +
+          std::to_string(params * lambdas) + " items");
+    }
+    const auto range = paramRange(lambdas, begin, end);
+    std::vector<std::vector<Complex>> sums(range.second - range.first, std::vector<Complex>(mtfSize(), Complex(0)));
+    std::vector<std::mutex> locks(sums.size());
+    std::atomic<long> next(begin);
+    const long threadCount = threads();
+    std::exception_ptr error;
+    std::mutex errorLock;
+
+#pragma omp parallel num_threads(threadCount)
+    {
+      const long t = omp_get_thread_num();
+      auto& worker = *m_workers[t];
+      long items = 0;
+      try {
+        for (long i = next++; i < end; i = next++) {
+          const long p = i / lambdas;
+          if (p - range.first != worker.param) {
+            worker.flush(sums, locks);
+            worker.param = p - range.first;
+          }
+          auto plane = worker.pupilToPsf.inBuffer();
+          pupil(p, i % lambdas, plane);
+          worker.accumulate();
+          ++items;
+        }
+        worker.flush(sums, locks);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorLock);
+        if (not error) {
+          error = std::current_exception();
+        }
+        next = end; // Stop the other threads
+        worker.reset();
+      }
+      m_items[t] = items;
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return sums;
+  }
+
+  /**
+   * @brief Compute the broadband PSFs from the MTF sums.
+   * @param sums The MTF sums, one per parameter, as returned by `accumulate()`
+   * @return The stack of broadband PSFs, one plane per parameter
+   */
+  Fits::VecRaster<T, 3> integrate(const std::vector<std::vector<Complex>>& sums) {
+    const long params = sums.size();
+    const long size = mtfSize();
+    for (const auto& sum : sums) {
+      if (long(sum.size()) != size) {
+        throw std::invalid_argument(
+            "MTF sum size " + std::to_string(sum.size()) + " does not match MTF size " + std::to_string(size));
+      }
+    }
+    Fits::VecRaster<T, 3> psfs({m_broadbandShape[0], m_broadbandShape[1], params});
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threads())
+    for (long p = 0; p < params; ++p) {
+      auto& inverse = m_workers[omp_get_thread_num()]->mtfToBroadband;
+      std::copy_n(sums[p].data(), size, inverse.inBuffer().data());
+      const auto psf = inverse.transform().normalize().outBuffer();
+      const long stride = psf.shape()[0]; // Padded if in place
+      for (long y = 0; y < m_broadbandShape[1]; ++y) {
+        std::copy_n(psf.data() + y * stride, m_broadbandShape[0], &psfs[{0, y, p}]);
+      }
+    }
+    return psfs;
+  }
+
+  /**
+   * @brief Get the number of values of an MTF sum.
+   */
+  long mtfSize() const {
+    const auto& shape = m_workers[0]->mtf.outShape();
+    return shape[0] * shape[1];
+  }
+
+private:
+  /**
+   * @brief The plans and accumulator of a thread.
+   */
+  struct Worker {
+
+    /** @brief Constructor. */
+    Worker(
+        const Fits::Position<2>& pupil,
+        const Fits::Position<2>& broadband,
+        long stride,
+        const PlanningPolicy& policy) :
+        pupilToPsf(pupil, 1, policy),
+        mtf(pupil, {0, 0}, pupil, stride, 1, policy), mtfToBroadband(broadband, 1, policy),
+        acc(mtf.outBuffer().size(), Complex(0)), param(-1) {}
+
+    /** @brief Process the pupil in the input buffer and add its MTF to the accumulator. */
+    void accumulate() {
+      pupilToPsf.transform().pipe(mtf.window(), Norm2());
+      const auto data = mtf.transform().outBuffer();
+      T* a = reinterpret_cast<T*>(acc.data());
+      const T* d = reinterpret_cast<const T*>(data.data());
+      const long size = 2 * acc.size();
+#pragma omp simd
+      for (long i = 0; i < size; ++i) {
+        a[i] += d[i];
+      }
+    }
+
+    /** @brief Add the accumulator to the shared sum of its parameter, and reset it. */
+    void flush(std::vector<std::vector<Complex>>& sums, std::vector<std::mutex>& locks) {
+      if (param < 0) {
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(locks[param]);
+        multiplyAccumulateData(sums[param].data(), acc.data(), Complex(1), acc.size());
+      }
+      reset();
+    }
+
+    /** @brief Reset the accumulator. */
+    void reset() {
+      std::fill(acc.begin(), acc.end(), Complex(0));
+      param = -1;
+    }
+
+    /** @brief The pupil to PSF amplitude transform. */
+    BasicComplexDft<T> pupilToPsf;
+
+    /** @brief The PSF intensity to subsampled MTF transform. */
+    BasicPrunedRealDft<T> mtf;
+
+    /** @brief The MTF to broadband PSF transform. */
+    typename BasicRealDft<T>::Inverse mtfToBroadband;
+
+    /** @brief The MTF accumulator. */
+    std::vector<Complex> acc;
+
+    /** @brief The parameter of the accumulator, relative to the first parameter of the range, or -1 if empty. */
+    long param;
+  };
+
+  /**
+   * @brief Compute the ratio of the pupil shape to the broadband shape.
+   */
+  static long ratio(const Fits::Position<2>& pupil, const Fits::Position<2>& broadband) {
+    const long stride = broadband[0] > 0 ? pupil[0] / broadband[0] : 0;
+    if (stride < 1 || pupil[0] != stride * broadband[0] || pupil[1] != stride * broadband[1]) {
+      throw std::invalid_argument(
+          "Pupil shape " + std::to_string(pupil[0]) + "x" + std::to_string(pupil[1]) +
+          " is not a multiple of broadband shape " + std::to_string(broadband[0]) + "x" + std::to_string(broadband[1]));
+    }
+    return stride;
+  }
+
+  /**
+   * @brief The pupil shape.
+   */
+  Fits::Position<2> m_pupilShape;
+
+  /**
+   * @brief The broadband PSF shape.
+   */
+  Fits::Position<2> m_broadbandShape;
+
+  /**
+   * @brief The subsampling factor.
+   */
+  long m_stride;
+
+  /**
+   * @brief The per-thread workers.
+   */
+  std::vector<std::unique_ptr<Worker>> m_workers;
+
+  /**
+   * @brief The per-thread item counts.
+   */
+  std::vector<long> m_items;
+};
+
+/**
+ * @brief Double precision broadband PSF engine.
+ */
+using BroadbandPsf = BasicBroadbandPsf<double>;
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
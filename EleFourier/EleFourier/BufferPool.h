@@ -0,0 +1,226 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_BUFFERPOOL_H
+#define _ELEFOURIER_BUFFERPOOL_H
+
+#include "EleFourier/FftwTraits.h"
+
+#include <cstddef> // size_t
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility> // pair
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Recycling allocator of FFTW buffers.
+ * @details
+ * Released buffers are not freed, but cached by size and precision,
+ * such that allocating a buffer of the same size (e.g. for a `DftPlan` of the same geometry) is free.
+ * Buffers are allocated with the FFTW library of their precision, and therefore keep the SIMD alignment
+ * which allows plans to be shared across buffers (see `FftwPlanner`).
+ *
+ * Pooling is opt-in: `DftPlan`s allocate with FFTW directly unless they are given a pool.
+ * Per-thread arenas (see `local()`) let a thread recycle its buffers without contention.
+ *
+ * Optionally, fresh buffers are zero-filled by the allocating thread (see the constructor).
+ * With the first-touch policy of Linux, this binds their pages to the NUMA node of that thread,
+ * at the cost of an extra write pass, which is useless when planning (e.g. `FFTW_MEASURE`) overwrites the buffer.
+ *
+ * The total size of the cached buffers is bounded by a capacity, above which released buffers are freed.
+ * The default capacity is small (64 MiB), because an arena keeps its cached buffers as long as its thread,
+ * and worker threads (e.g. of OpenMP) often live as long as the program.
+ * The pool is thread-safe, and buffers can be released from another thread than the allocating one.
+ * Cached buffers are freed by `purge()` and by the destructor.
+ *
+ * \code
+ * auto pool = BufferPool::local();
+ * double* data = pool->allocate<double>(1024);
+ * pool->release(data, 1024);
+ * double* again = pool->allocate<double>(1024); // Same buffer, no allocation
+ * \endcode
+ */
+class BufferPool {
+
+public:
+  /**
+   * @brief The default capacity, in bytes.
+   */
+  static constexpr std::size_t defaultCapacity = std::size_t(1) << 26;
+
+  /**
+   * @brief Constructor.
+   * @param capacity The maximum total size of the cached buffers, in bytes
+   * @param firstTouch Whether to zero-fill fresh buffers in the allocating thread
+   */
+  explicit BufferPool(std::size_t capacity = defaultCapacity, bool firstTouch = false);
+
+  /**
+   * @brief Destructor.
+   * @details
+   * Cached buffers are freed; buffers in use are not tracked and must be released beforehand.
+   */
+  ~BufferPool();
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool(BufferPool&&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+  BufferPool& operator=(BufferPool&&) = delete;
+
+  /**
+   * @brief Get the arena of the calling thread.
+   * @details
+   * The arena is created at first call, and lives as long as its thread or the buffers drawn from it,
+   * whichever is longer (`DftPlan` holds the pool it allocates from).
+   */
+  static std::shared_ptr<BufferPool> local();
+
+  /**
+   * @brief Get a buffer of given number of values.
+   * @tparam T The value type, which sets the precision
+   */
+  template <typename T>
+  T* allocate(long size) {
+    using Traits = FftwTraits<typename FftwReal<T>::Type>;
+    return static_cast<T*>(allocate(Traits::Index, sizeof(T) * size, Traits::malloc, Traits::free));
+  }
+
+  /**
+   * @brief Return a buffer to the pool.
+   * @param data The buffer, as returned by `allocate()`
+   * @param size The number of values, as given to `allocate()`
+   */
+  template <typename T>
+  void release(T* data, long size) {
+    using Traits = FftwTraits<typename FftwReal<std::remove_const_t<T>>::Type>;
+    release(Traits::Index, sizeof(T) * size, const_cast<std::remove_const_t<T>*>(data));
+  }
+
+  /**
+   * @brief Check whether fresh buffers are zero-filled.
+   */
+  bool firstTouch() const {
+    return m_firstTouch;
+  }
+
+  /**
+   * @brief Get the capacity, in bytes.
+   */
+  std::size_t capacity() const;
+
+  /**
+   * @brief Set the capacity, in bytes.
+   * @details
+   * Cached buffers are freed as needed to fit the new capacity.
+   */
+  void capacity(std::size_t bytes);
+
+  /**
+   * @brief Get the total size of the cached buffers, in bytes.
+   */
+  std::size_t cachedBytes() const;
+
+  /**
+   * @brief Get the number of allocations served from the cache.
+   */
+  long hits() const;
+
+  /**
+   * @brief Get the number of allocations which required a fresh buffer.
+   */
+  long misses() const;
+
+  /**
+   * @brief Free the cached buffers.
+   */
+  void purge();
+
+private:
+  /**
+   * @brief The freeing function type.
+   */
+  using Deleter = void (*)(void*);
+
+  /**
+   * @brief Get a buffer of given precision index and size.
+   */
+  void* allocate(std::size_t index, std::size_t bytes, void* (*allocator)(std::size_t), Deleter deleter);
+
+  /**
+   * @brief Return a buffer of given precision index and size.
+   */
+  void release(std::size_t index, std::size_t bytes, void* data);
+
+  /**
+   * @brief Free cached buffers until the cached size fits the capacity.
+   * @warning
+   * The mutex must be held.
+   */
+  void shrink(std::size_t capacity);
+
+  /**
+   * @brief The mutex.
+   */
+  mutable std::mutex m_mutex;
+
+  /**
+   * @brief The capacity.
+   */
+  std::size_t m_capacity;
+
+  /**
+   * @brief The first-touch flag.
+   */
+  bool m_firstTouch;
+
+  /**
+   * @brief The cached size.
+   */
+  std::size_t m_cached;
+
+  /**
+   * @brief The hit count.
+   */
+  long m_hits;
+
+  /**
+   * @brief The miss count.
+   */
+  long m_misses;
+
+  /**
+   * @brief The cached buffers, by precision index and size in bytes.
+   */
+  std::map<std::pair<std::size_t, std::size_t>, std::vector<void*>> m_free;
+
+  /**
+   * @brief The freeing function of each precision index.
+   */
+  std::map<std::size_t, Deleter> m_deleters;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
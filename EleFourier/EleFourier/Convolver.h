@@ -0,0 +1,401 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_CONVOLVER_H
+#define _ELEFOURIER_CONVOLVER_H
+
+#include "EleFourier/Dft.h"
+
+#include <algorithm> // copy_n, fill_n, min
+#include <chrono>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Batched FFT convolution engine with cached filter spectra.
+ * @tparam T The real value type
+ * @details
+ * A convolver owns a single pair of real DFT plans (direct and inverse) of fixed plane shape and batch size,
+ * through which all the images are processed, `batch` planes at a time.
+ * Filters are registered once by identifier as spatial kernels, and their spectra are cached,
+ * such that convolving an image costs one direct and one inverse transform, and a single fused multiplication,
+ * which also performs normalization.
+ *
+ * Kernels may be smaller than the plane shape; they are centered at pixel `kernelShape / 2`.
+ * Two modes are provided:
+ * - `convolveStack()` convolves images of the plane shape, with periodic boundary conditions;
+ * - `convolveTiled()` convolves images of any shape, with zero boundary conditions,
+ *   using the overlap-save method: the image is split into overlapping tiles of the plane shape,
+ *   from which only the pixels unaffected by the periodicity are kept.
+ *   The tile step is `shape - kernelShape + 1`, such that the plane shape should be much larger than the kernels.
+ *
+ * The convolver keeps track of the number of processed images and of the time spent convolving them,
+ * from which `throughput()` is computed.
+ *
+ * \code
+ * Convolver convolver({512, 512}, 16);
+ * convolver.addFilter("psf_vis", psf);
+ * convolver.convolveStack("psf_vis", stack); // In place, 16 images at a time
+ * convolver.convolveTiled("psf_vis", hugeImage, result); // Overlap-save
+ * logger.info() << convolver.throughput() << " images/s";
+ * \endcode
+ */
+template <typename T>
+class BasicConvolver {
+
+public:
+  /**
+   * @brief The real DFT plan type.
+   */
+  using Dft = BasicRealDft<T>;
+
+  /**
+   * @brief The filter spectrum type.
+   */
+  using Spectrum = Fits::VecRaster<std::complex<T>>;
+
+  /**
+   * @brief Constructor.
+   * @param shape The plane shape
+   * @param batch The number of planes processed at once
+   * @param policy The planning policy
+   */
+  BasicConvolver(const Fits::Position<2>& shape, long batch = 1, const PlanningPolicy& policy = PlanningPolicy()) :
+      m_dft(shape, batch, policy), m_inverse(m_dft.inverse()), m_filters(), m_count(0), m_seconds(0) {}
+
+  /**
+   * @brief Get the plane shape.
+   */
+  const Fits::Position<2>& shape() const {
+    return m_dft.logicalShape();
+  }
+
+  /**
+   * @brief Get the batch size.
+   */
+  long batch() const {
+    return m_dft.count();
+  }
+
+  /**
+   * @brief Compute and cache the spectrum of a filter.
+   * @param id The filter identifier
+   * @param kernel The spatial kernel, of shape lower or equal to the plane shape
+   * @details
+   * If a filter with the same identifier exists, it is replaced.
+   */
+  template <typename TRaster>
+  const Spectrum& addFilter(const std::string& id, const TRaster& kernel) {
+    const auto& planeShape = shape();
+    const Fits::Position<2> kernelShape {kernel.shape()[0], kernel.shape()[1]};
+    if (kernelShape[0] > planeShape[0] || kernelShape[1] > planeShape[1]) {
+      throw std::invalid_argument("Kernel of filter " + id + " is larger than the plane shape");
+    }
+    Dft dft(planeShape, 1, m_dft.policy());
+    auto plane = dft.inBuffer();
+    const long stride = plane.shape()[0];
+    std::fill_n(plane.data(), plane.size(), T(0));
+    const auto* k = kernel.data();
+    const long cx = kernelShape[0] / 2;
+    const long cy = kernelShape[1] / 2;
+    for (long y = 0; y < kernelShape[1]; ++y) {
+      const long wy = (y - cy + planeShape[1]) % planeShape[1]; // Center at origin
+      for (long x = 0; x < kernelShape[0]; ++x) {
+        const long wx = (x - cx + planeShape[0]) % planeShape[0];
+        plane.data()[wx + wy * stride] = k[x + y * kernelShape[0]];
+      }
+    }
+    dft.transform().normalize(); // Normalization of the inverse transform, once for all
+    const auto coefficients = dft.outBuffer();
+    Filter filter {kernelShape, Spectrum(dft.outShape())};
+    std::copy_n(coefficients.data(), coefficients.size(), filter.spectrum.data());
+    return (m_filters[id] = std::move(filter)).spectrum;
+  }
+
+  /**
+   * @brief Check whether a filter was registered.
+   */
+  bool hasFilter(const std::string& id) const {
+    return m_filters.count(id);
+  }
+
+  /**
+   * @brief Get the spectrum of a filter, normalized for the inverse transform.
+   */
+  const Spectrum& spectrum(const std::string& id) const {
+    return filter(id).spectrum;
+  }
+
+  /**
+   * @brief Forget a filter.
+   */
+  void removeFilter(const std::string& id) {
+    m_filters.erase(id);
+  }
+
+  /**
+   * @brief Convolve a stack of images of the plane shape, in place, with periodic boundary conditions.
+   * @param id The filter identifier
+   * @param stack The stack of images, a contiguous 2D or 3D raster with planes of the plane shape
+   */
+  template <typename TRaster>
+  void convolveStack(const std::string& id, TRaster& stack) {
+    const auto& spectrum = filter(id).spectrum;
+    const auto& planeShape = shape();
+    if (stack.shape()[0] != planeShape[0] || stack.shape()[1] != planeShape[1]) {
+      throw std::invalid_argument("Image shape differs from the plane shape");
+    }
+    const long size = planeShape[0] * planeShape[1];
+    const long count = stack.size() / size;
+    const auto begin = std::chrono::steady_clock::now();
+    auto* data = stack.data();
+    for (long first = 0; first < count; first += batch()) {
+      const long n = std::min(batch(), count - first);
+      for (long i = 0; i < n; ++i) {
+        copyIn(data + (first + i) * size, planeShape, m_dft.inBuffer(i));
+      }
+      process(spectrum);
+      for (long i = 0; i < n; ++i) {
+        copyOut(m_inverse.outBuffer(i), planeShape, data + (first + i) * size);
+      }
+    }
+    record(begin, count);
+  }
+
+  /**
+   * @brief Convolve an image of any shape with zero boundary conditions, using overlap-save.
+   * @param id The filter identifier
+   * @param image The input image, a contiguous 2D raster
+   * @param result The output image, a contiguous 2D raster of the shape of `image`
+   */
+  template <typename TIn, typename TOut>
+  void convolveTiled(const std::string& id, const TIn& image, TOut& result) {
+    const auto& f = filter(id);
+    const Fits::Position<2> imageShape {image.shape()[0], image.shape()[1]};
+    if (result.shape()[0] != imageShape[0] || result.shape()[1] != imageShape[1]) {
+      throw std::invalid_argument("Input and output shapes differ");
+    }
+    const auto& planeShape = shape();
+    const Fits::Position<2> step {planeShape[0] - f.kernelShape[0] + 1, planeShape[1] - f.kernelShape[1] + 1};
+    const Fits::Position<2> margin {
+        f.kernelShape[0] - 1 - f.kernelShape[0] / 2,
+        f.kernelShape[1] - 1 - f.kernelShape[1] / 2}; // First valid pixel of the tiles
+    const long nx = (imageShape[0] + step[0] - 1) / step[0];
+    const long ny = (imageShape[1] + step[1] - 1) / step[1];
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<Fits::Position<2>> corners; // Lower-left corners of the valid regions in the image
+    corners.reserve(batch());
+    for (long t = 0; t < nx * ny; ++t) {
+      const Fits::Position<2> corner {(t % nx) * step[0], (t / nx) * step[1]};
+      fillTile(image, imageShape, {corner[0] - margin[0], corner[1] - margin[1]}, m_dft.inBuffer(corners.size()));
+      corners.push_back(corner);
+      if (static_cast<long>(corners.size()) == batch() || t == nx * ny - 1) {
+        process(f.spectrum);
+        for (std::size_t i = 0; i < corners.size(); ++i) {
+          emptyTile(m_inverse.outBuffer(i), margin, step, corners[i], imageShape, result);
+        }
+        corners.clear();
+      }
+    }
+    record(begin, 1);
+  }
+
+  /**
+   * @brief Get the number of convolved images.
+   */
+  long count() const {
+    return m_count;
+  }
+
+  /**
+   * @brief Get the time spent convolving, in seconds.
+   */
+  double seconds() const {
+    return m_seconds;
+  }
+
+  /**
+   * @brief Get the throughput, in images per second.
+   */
+  double throughput() const {
+    return m_seconds > 0 ? m_count / m_seconds : 0;
+  }
+
+  /**
+   * @brief Reset the image count and timer.
+   */
+  void resetStatistics() {
+    m_count = 0;
+    m_seconds = 0;
+  }
+
+private:
+  /**
+   * @brief A cached filter.
+   */
+  struct Filter {
+    /**
+     * @brief The shape of the spatial kernel.
+     */
+    Fits::Position<2> kernelShape;
+
+    /**
+     * @brief The spectrum of the kernel, centered at the origin and normalized.
+     */
+    Spectrum spectrum;
+  };
+
+  /**
+   * @brief Get a filter or throw.
+   */
+  const Filter& filter(const std::string& id) const {
+    const auto it = m_filters.find(id);
+    if (it == m_filters.end()) {
+      throw std::invalid_argument("Unknown filter: " + id);
+    }
+    return it->second;
+  }
+
+  /**
+   * @brief Convolve the whole batch.
+   */
+  void process(const Spectrum& spectrum) {
+    m_dft.transform().multiply(spectrum);
+    m_inverse.transform();
+  }
+
+  /**
+   * @brief Copy an image into a (possibly padded) plane.
+   */
+  template <typename U>
+  static void copyIn(const U* image, const Fits::Position<2>& shape, Fits::PtrRaster<T> plane) {
+    const long stride = plane.shape()[0];
+    for (long y = 0; y < shape[1]; ++y) {
+      std::copy_n(image + y * shape[0], shape[0], plane.data() + y * stride);
+    }
+  }
+
+  /**
+   * @brief Copy a (possibly padded) plane into an image.
+   */
+  template <typename U>
+  static void copyOut(Fits::PtrRaster<T> plane, const Fits::Position<2>& shape, U* image) {
+    const long stride = plane.shape()[0];
+    for (long y = 0; y < shape[1]; ++y) {
+      std::copy_n(plane.data() + y * stride, shape[0], image + y * shape[0]);
+    }
+  }
+
+  /**
+   * @brief Copy a region of an image into a plane, with zero padding outside the image.
+   */
+  template <typename TIn>
+  void fillTile(
+      const TIn& image,
+      const Fits::Position<2>& imageShape,
+      const Fits::Position<2>& offset,
+      Fits::PtrRaster<T> plane) const {
+    const auto& planeShape = shape();
+    const long stride = plane.shape()[0];
+    const auto* in = image.data();
+    for (long y = 0; y < planeShape[1]; ++y) {
+      T* row = plane.data() + y * stride;
+      const long iy = offset[1] + y;
+      if (iy < 0 || iy >= imageShape[1]) {
+        std::fill_n(row, planeShape[0], T(0));
+        continue;
+      }
+      for (long x = 0; x < planeShape[0]; ++x) {
+        const long ix = offset[0] + x;
+        row[x] = (ix < 0 || ix >= imageShape[0]) ? T(0) : in[ix + iy * imageShape[0]];
+      }
+    }
+  }
+
+  /**
+   * @brief Copy the valid region of a plane into an image.
+   */
+  template <typename TOut>
+  static void emptyTile(
+      Fits::PtrRaster<T> plane,
+      const Fits::Position<2>& margin,
+      const Fits::Position<2>& step,
+      const Fits::Position<2>& corner,
+      const Fits::Position<2>& imageShape,
+      TOut& result) {
+    const long stride = plane.shape()[0];
+    const long width = std::min(step[0], imageShape[0] - corner[0]);
+    const long height = std::min(step[1], imageShape[1] - corner[1]);
+    auto* out = result.data();
+    for (long y = 0; y < height; ++y) {
+      std::copy_n(
+          plane.data() + margin[0] + (margin[1] + y) * stride,
+          width,
+          out + corner[0] + (corner[1] + y) * imageShape[0]);
+    }
+  }
+
+  /**
+   * @brief Update the statistics.
+   */
+  void record(const std::chrono::steady_clock::time_point& begin, long count) {
+    m_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    m_count += count;
+  }
+
+  /**
+   * @brief The direct plan.
+   */
+  Dft m_dft;
+
+  /**
+   * @brief The inverse plan, which shares the buffers of the direct plan.
+   */
+  typename Dft::Inverse m_inverse;
+
+  /**
+   * @brief The cached filters.
+   */
+  std::map<std::string, Filter> m_filters;
+
+  /**
+   * @brief The number of convolved images.
+   */
+  long m_count;
+
+  /**
+   * @brief The time spent convolving, in seconds.
+   */
+  double m_seconds;
+};
+
+/**
+ * @brief Double precision convolver.
+ */
+using Convolver = BasicConvolver<double>;
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -25,20 +25,91 @@
 namespace Euclid {
 namespace Fourier {
 
+/**
+ * @brief Real DFT plan of given precision.
+ * @tparam T The real value type, i.e. `float`, `double` or `long double`
+ */
+template <typename T>
+using BasicRealDft = DftPlan<BasicRealDftType<T>>;
+
+/**
+ * @brief Complex DFT plan of given precision.
+ * @tparam T The real value type, i.e. `float`, `double` or `long double`
+ */
+template <typename T>
+using BasicComplexDft = DftPlan<BasicComplexDftType<T>>;
+
+/**
+ * @brief Complex DFT plan with Hermitian symmetry of given precision.
+ * @tparam T The real value type, i.e. `float`, `double` or `long double`
+ */
+template <typename T>
+using BasicHermitianComplexDft = DftPlan<BasicHermitianComplexDftType<T>>;
+
 /**
  * @brief Real DFT plan.
  */
-using RealDft = DftPlan<RealDftType>;
+using RealDft = BasicRealDft<double>;
 
 /**
  * @brief Complex DFT plan.
  */
-using ComplexDft = DftPlan<ComplexDftType>;
+using ComplexDft = BasicComplexDft<double>;
 
 /**
  * @brief Complex DFT plan with Hermitian symmetry.
  */
-using HermitianComplexDft = DftPlan<HermitianComplexDftType>;
+using HermitianComplexDft = BasicHermitianComplexDft<double>;
+
+/**
+ * @brief Single precision real DFT plan.
+ */
+using RealDftF = BasicRealDft<float>;
+
+/**
+ * @brief Single precision complex DFT plan.
+ */
+using ComplexDftF = BasicComplexDft<float>;
+
+/**
+ * @brief Long double precision real DFT plan.
+ */
+using RealDftL = BasicRealDft<long double>;
+
+/**
+ * @brief Long double precision complex DFT plan.
+ */
+using ComplexDftL = BasicComplexDft<long double>;
+
+/**
+ * @brief Complex DFT plan along the rows.
+ */
+using ComplexRowDft = DftPlan<ComplexRowDftType>;
+
+/**
+ * @brief Complex DFT plan along the columns.
+ */
+using ComplexColumnDft = DftPlan<ComplexColumnDftType>;
+
+/**
+ * @brief Real DFT plan along the rows.
+ */
+using RealRowDft = DftPlan<RealRowDftType>;
+
+/**
+ * @brief Real DFT plan along the columns.
+ */
+using RealColumnDft = DftPlan<RealColumnDftType>;
+
+/**
+ * @brief Three-dimensional complex DFT plan over the stack.
+ */
+using ComplexStackDft = DftPlan<ComplexStackDftType>;
+
+/**
+ * @brief Three-dimensional real DFT plan over the stack.
+ */
+using RealStackDft = DftPlan<RealStackDftType>;
 
 } // namespace Fourier
 } // namespace Euclid
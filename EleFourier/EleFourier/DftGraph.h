@@ -0,0 +1,319 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_DFTGRAPH_H
+#define _ELEFOURIER_DFTGRAPH_H
+
+#include "EleFourier/DftPlan.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Fixed-size pool of threads which execute tasks in submission order.
+ * @details
+ * The destructor completes the queued tasks before joining the threads.
+ */
+class TaskPool {
+
+public:
+  /**
+   * @brief Constructor.
+   * @param threads The number of threads, or 0 for `omp_get_max_threads()`
+   */
+  explicit TaskPool(long threads = 0);
+
+  /**
+   * @brief Non-copyable.
+   */
+  TaskPool(const TaskPool&) = delete;
+
+  /**
+   * @brief Non-copyable.
+   */
+  TaskPool& operator=(const TaskPool&) = delete;
+
+  /**
+   * @brief Destructor.
+   */
+  ~TaskPool();
+
+  /**
+   * @brief Get the number of threads.
+   */
+  long threads() const {
+    return m_threads.size();
+  }
+
+  /**
+   * @brief Queue a task.
+   * @return The future of the task, which holds the exception thrown by the task, if any
+   */
+  template <typename TFunc>
+  std::future<void> submit(TFunc&& func) {
+    auto task = std::make_shared<std::packaged_task<void()>>(std::forward<TFunc>(func));
+    auto future = task->get_future();
+    post([task]() {
+      (*task)();
+    });
+    return future;
+  }
+
+private:
+  /**
+   * @brief Queue a type-erased task.
+   */
+  void post(std::function<void()> task);
+
+  /**
+   * @brief The loop of each thread.
+   */
+  void work();
+
+  /**
+   * @brief The queue mutex.
+   */
+  std::mutex m_mutex;
+
+  /**
+   * @brief The queue condition, notified on push and stop.
+   */
+  std::condition_variable m_condition;
+
+  /**
+   * @brief The task queue.
+   */
+  std::deque<std::function<void()>> m_queue;
+
+  /**
+   * @brief The stop flag.
+   */
+  bool m_stop;
+
+  /**
+   * @brief The threads.
+   */
+  std::vector<std::thread> m_threads;
+};
+
+/**
+ * @brief Directed acyclic graph of transforms and pointwise stages, executed asynchronously on a `TaskPool`.
+ * @details
+ * Nodes are tasks which declare the buffers they read and write (identified by their address).
+ * Dependencies are derived from the declaration order, like for instructions of a sequential program:
+ * a node runs after the last node which wrote one of its buffers,
+ * and, if it writes a buffer, after all the nodes which read it since then.
+ * Explicit dependencies can be added with `after()`.
+ * Nodes are therefore added in the order of the equivalent synchronous code,
+ * and independent branches (e.g. the transforms of a filter and of an image) are executed concurrently.
+ *
+ * Transform nodes, created with `transform()`, write both the input and output buffers of the plan,
+ * because FFTW may destroy the input of some transforms.
+ * Plans which share buffers (see `DftPlan::inverse()` and `DftPlan::compose()`) are hence ordered,
+ * and so are their pending scale factors, which are associated to the buffers.
+ *
+ * \code
+ * RealDft filterDft(shape);
+ * RealDft imageDft(shape, count);
+ * auto inverse = imageDft.inverse();
+ * DftGraph graph;
+ * graph.transform(filterDft);
+ * graph.transform(imageDft); // Concurrent with filterDft's
+ * graph.add(
+ *     "convolve",
+ *     [&](long) { imageDft.normalizeLazily().multiply(filterDft.outBuffer()); },
+ *     {filterDft.outStack().data()},
+ *     {imageDft.outStack().data()}); // After both transforms
+ * graph.transform(inverse);
+ * TaskPool pool(2);
+ * graph.run(pool).get();
+ * \endcode
+ *
+ * A graph can be run repeatedly, but not concurrently with itself.
+ * To overlap the stages of consecutive inputs of a stream (e.g. reading input `k + 1` while transforming input `k`),
+ * several graphs, each over its own plans and buffers, are run in rotation with `stream()`,
+ * and tasks receive the index of the input.
+ */
+class DftGraph {
+
+public:
+  /**
+   * @brief The task type, which receives the index of the run.
+   */
+  using Task = std::function<void(long)>;
+
+  /**
+   * @brief Add a node.
+   * @param name The node name, e.g. for debugging
+   * @param task The task
+   * @param reads The buffers read by the task
+   * @param writes The buffers written by the task
+   * @return The node index
+   */
+  long add(
+      const std::string& name,
+      Task task,
+      const std::vector<const void*>& reads,
+      const std::vector<const void*>& writes);
+
+  /**
+   * @brief Add a transform node.
+   * @details
+   * The plan must outlive the graph.
+   */
+  template <typename TType>
+  long transform(DftPlan<TType>& plan, const std::string& name = "transform") {
+    const void* in = plan.inStack().data();
+    const void* out = plan.outStack().data();
+    return add(
+        name,
+        [&plan](long) {
+          plan.transform();
+        },
+        {},
+        {in, out});
+  }
+
+  /**
+   * @brief Make a node depend on another one, in addition to its buffer dependencies.
+   * @param node The node
+   * @param dependency The node which must complete before, added before `node`
+   */
+  void after(long node, long dependency);
+
+  /**
+   * @brief Get the number of nodes.
+   */
+  long size() const {
+    return m_nodes.size();
+  }
+
+  /**
+   * @brief Get the name of a node.
+   */
+  const std::string& name(long node) const {
+    return m_nodes.at(node).name;
+  }
+
+  /**
+   * @brief Get the dependencies of a node, in increasing order.
+   */
+  const std::vector<long>& dependencies(long node) const {
+    return m_nodes.at(node).dependencies;
+  }
+
+  /**
+   * @brief Execute the graph asynchronously.
+   * @param pool The thread pool
+   * @param index The index passed to the tasks
+   * @return The future of the execution, which is ready when all the nodes have completed
+   * @details
+   * If a task throws, the nodes which have not started yet are skipped, and the first exception is set to the future.
+   * The graph must not be modified or destroyed before the future is ready.
+   */
+  std::future<void> run(TaskPool& pool, long index = 0) const;
+
+  /**
+   * @brief Execute a sequence of graphs in rotation, over a stream of inputs.
+   * @param pool The thread pool
+   * @param graphs The graphs, which must not share buffers
+   * @param count The number of inputs
+   * @return The number of processed inputs
+   * @details
+   * Input `k` is processed by graph `k % graphs.size()`, with index `k`,
+   * as soon as the graph has completed input `k - graphs.size()`,
+   * such that up to `graphs.size()` inputs are in flight.
+   * Tasks of different graphs run concurrently,
+   * which means that shared resources (e.g. a file read by each graph) must be protected by the tasks themselves.
+   * If a task throws, no more inputs are started, and the first exception is rethrown once the runs have completed.
+   */
+  static long stream(TaskPool& pool, const std::vector<DftGraph>& graphs, long count);
+
+private:
+  /**
+   * @brief A node.
+   */
+  struct Node {
+
+    /** @brief The name. */
+    std::string name;
+
+    /** @brief The task. */
+    Task task;
+
+    /** @brief The nodes to be completed before. */
+    std::vector<long> dependencies;
+
+    /** @brief The nodes which depend on this one. */
+    std::vector<long> successors;
+  };
+
+  /**
+   * @brief The accesses to a buffer.
+   */
+  struct Access {
+
+    /** @brief The last writing node, or -1. */
+    long writer = -1;
+
+    /** @brief The nodes which read the buffer since the last writing. */
+    std::vector<long> readers;
+  };
+
+  /**
+   * @brief The state of a run.
+   */
+  struct Run;
+
+  /**
+   * @brief Add a dependency if not already present.
+   */
+  void depend(long node, long dependency);
+
+  /**
+   * @brief Execute a node and schedule its ready successors.
+   */
+  void execute(TaskPool& pool, const std::shared_ptr<Run>& run, long node) const;
+
+  /**
+   * @brief The nodes.
+   */
+  std::vector<Node> m_nodes;
+
+  /**
+   * @brief The accesses, by buffer.
+   */
+  std::map<const void*, Access> m_accesses;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -20,53 +20,37 @@
 #ifndef _ELEFOURIER_DFTPLAN_H
 #define _ELEFOURIER_DFTPLAN_H
 
+#include "EleFourier/BufferPool.h"
 #include "EleFourier/DftType.h"
+#include "EleFourier/FastSize.h"
+#include "EleFourier/FftwPlanner.h"
+#include "EleFourier/Kernels.h"
+#include "EleFourier/PlanStats.h"
+#include "EleFourier/PlanningPolicy.h"
 
+#include <algorithm> // copy_n, fill_n, min
 #include <cassert>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility> // exchange, move
 
 namespace Euclid {
 namespace Fourier {
 
-/**
- * @brief Singleton class to be instantiated by FFTW user classes (e.g. in constructor or destructor)
- * to ensure proper cleanup at program ending.
- * @details
- * The destructor, which is executed once (at the end of the program), calls `fftw_cleanup()`.
- */
-class FftwGlobalsCleaner {
-private:
-  /**
-   * @brief Private constructor.
-   */
-  FftwGlobalsCleaner() {}
-
-public:
-  /**
-   * @brief Destructor.
-   * @details
-   * Frees FFTW's globals.
-   */
-  ~FftwGlobalsCleaner() {
-    fftw_cleanup();
-  }
-
-  /**
-   * @brief Instantiate the singleton, to trigger cleanup at destruction.
-   */
-  static FftwGlobalsCleaner& instantiate() {
-    static FftwGlobalsCleaner instance;
-    return instance;
-  }
-};
-
 /**
  * @brief Initialize a FFTW buffer.
+ * @details
+ * The buffer is allocated by the FFTW library of the precision of `T` (e.g. `fftwf_malloc()` for `float`).
  * @warning
- * Data should be freed with `fftw_free()`.
+ * Data should be freed with the matching `FftwTraits::free()`, e.g. `fftw_free()` for `double`.
  */
 template <typename T>
 Fits::PtrRaster<T, 3> initFftwBuffer(const Fits::Position<2>& shape, long count, T* data) {
-  T* d = data ? data : (T*)fftw_malloc(sizeof(T) * shapeSize(shape) * count);
+  using Traits = FftwTraits<typename FftwReal<T>::Type>;
+  T* d = data ? data : (T*)Traits::malloc(sizeof(T) * shapeSize(shape) * count);
   return {{shape[0], shape[1], count}, d};
 }
 
@@ -78,13 +62,15 @@ Fits::PtrRaster<T, 3> initFftwBuffer(const Fits::Position<2>& shape, long count,
  * It is design to compose transforms (e.g. direct and inverse DFTs) efficiently.
  * 
  * On memory side, one plan comes with an input buffer and an output buffer,
- * which are allocated at plan construction.
+ * which are allocated at plan construction, with FFTW,
+ * or from a `BufferPool` if one is given, which recycles the buffers of destroyed plans.
  * Obviously, it is optimal to work directly in the buffers,
  * and avoid performing copies before and after transforms.
  * 
  * The most classical use case is to call the forward transform and later the inverse transform.
  * To this end, `inverse()` creates an inverse plan with shared buffers (see example below).
- * It is also possible to pipe transforms with `compose()`.
+ * It is also possible to pipe transforms with `compose()`,
+ * or through a pointwise function with `pipe()`, e.g. to feed a transform with the intensity of another's output.
  * 
  * Another classical use case is to perform the same transform on several inputs.
  * For this purpose, 3D stacks of 2D data are stored in the buffers instead of a single 2D data,
@@ -97,6 +83,15 @@ Fits::PtrRaster<T, 3> initFftwBuffer(const Fits::Position<2>& shape, long count,
  * - The user fills the input buffer;
  * - The user calls `transform()` - now, the input buffer is garbage
  * - The user reads the output buffer.
+ *
+ * Planning rigor and time limit are set by a `PlanningPolicy`,
+ * and planning can be made almost free in repeated runs by enabling the wisdom registry (see `FftwWisdom`).
+ * Planning and execution times can be monitored by enabling the statistics registry (see `PlanStats`).
+ * Data of shapes with large prime factors, for which FFTW is slow, can be zero-padded to a fast shape
+ * with `padded()`, `load()` and `crop()`.
+ * Construction is thread-safe, and plans of identical geometry are planned once and shared (see `FftwPlanner`).
+ * 
+ * The precision is that of the DFT type, e.g. `DftPlan<BasicRealDftType<float>>` relies on `fftwf_` functions.
  * 
  * Here is a classical example to perform a convolution in Fourier domain:
  * 
@@ -112,6 +107,38 @@ Fits::PtrRaster<T, 3> initFftwBuffer(const Fits::Position<2>& shape, long count,
  * ... // Do something with filtered, which contains the convolved signal
  * \endcode
  * 
+ * With `PlanningPolicy::inPlace()`, the input and output buffers share the same memory,
+ * which halves the memory footprint.
+ * The buffers are then views of different types and shapes over the same bytes.
+ * For real transforms, the rows of the real buffer are padded to `2 * (width / 2 + 1)` values,
+ * such that `inShape()` (resp. `outShape()` for inverse transforms) is larger than `logicalShape()`,
+ * and the trailing one or two columns are garbage.
+ * As for out-of-place transforms, the input buffer is garbage after `transform()`:
+ * \code
+ * RealDft dft(shape, count, PlanningPolicy().inPlace());
+ * auto inverse = dft.inverse(); // Also in place, in the same memory
+ * dft.inBuffer() = ... ; // Assign data in the first shape[0] columns
+ * dft.transform(); // Now, dft.outBuffer() contains the coefficients
+ * inverse.transform().normalize(); // Now, inverse.outBuffer() contains the signal, padding included
+ * \endcode
+ * 
+ * `normalize()` and `scale()` apply the factor to the output buffer in place.
+ * Scaling can also be made lazy, on request, with `normalizeLazily()` and `scaleLazily()`,
+ * which do not touch the data, but multiply a pending scale factor associated to the output buffer.
+ * The pending factor follows the data through the plans which share the buffer:
+ * `transform()` forwards the factor of the input buffer to the output buffer (transforms are linear),
+ * the fused kernels (`multiply()`, `multiplyScale()`, `pipe()` and `crop()`) apply it in the same pass,
+ * and `flush()`, `normalize()` and `scale()` apply it in place.
+ * The buffer accessors (`inBuffer()`, `outStack()`...) have no side effects, and can be called concurrently:
+ * they never apply the factor, which means that their values are unscaled until it is applied.
+ * For example, normalizing lazily before filtering makes normalization free:
+ * \code
+ * dft.transform().normalizeLazily().multiply(filter); // Single pass
+ * inverse.transform(); // inverse.outBuffer() is normalized
+ * \endcode
+ * Overwriting a buffer which has a pending factor (e.g. the output buffer of a lazily normalized plan)
+ * requires resetting the factor with `discardScale()` on the plan whose output it is, or using `load()`.
+ * 
  * Computation follows FFTW's conventions on formats and scaling, i.e.:
  * - If a buffer has Hermitian symmetry, it is of size `(width / 2 + 1) * height` instead of `width * height`;
  * - None of the transforms are scaled, which means that a factor `width * height` is introduced
@@ -149,6 +176,11 @@ public:
    */
   using OutValue = typename Type::OutValue;
 
+  /**
+   * @brief The real value type, which sets the precision.
+   */
+  using Real = typename Type::Real;
+
 private:
   enum BufferOwning
   {
@@ -161,30 +193,140 @@ private:
    * @brief Constructor.
    * @param shape The logical plane shape
    * @param count The number of planes
+   * @param policy The planning policy
    * @param inData The pre-existing input buffer, or `nullptr` to allocate a new one
    * @param outData The pre-existing output buffer, or `nullptr` to allocate a new one
-   */
-  DftPlan(Fits::Position<2> shape, long count, InValue* inData, OutValue* outData) :
-      m_shape {shape}, m_inShape {Type::inShape(shape)}, m_outShape {Type::outShape(shape)}, m_count {count},
-      m_owning {BufferOwning((inData ? DoesNotOwn : OwnsIn) | (outData ? DoesNotOwn : OwnsOut))},
-      m_in {initFftwBuffer<InValue>(m_inShape, m_count, inData)},
-      m_out {initFftwBuffer<OutValue>(m_outShape, m_count, outData)}, m_plan {initFftwPlan<Type>(m_in, m_out)} {}
+   * @param inScale The pending scale factor of the pre-existing input buffer, or `nullptr`
+   * @param outScale The pending scale factor of the pre-existing output buffer, or `nullptr`
+   * @param pool The pool in which new buffers are allocated, or `nullptr` to allocate them with FFTW directly
+   */
+  DftPlan(
+      Fits::Position<2> shape,
+      long count,
+      const PlanningPolicy& policy,
+      InValue* inData,
+      OutValue* outData,
+      std::shared_ptr<Real> inScale = nullptr,
+      std::shared_ptr<Real> outScale = nullptr,
+      std::shared_ptr<BufferPool> pool = nullptr) :
+      m_shape {shape}, m_inShape {inBufferShape(shape, policy)}, m_outShape {outBufferShape(shape, policy)},
+      m_count {count}, m_policy {policy}, m_owning {owning(policy, inData, outData)}, m_pool {std::move(pool)},
+      m_in {initFftwBuffer<InValue>(m_inShape, m_count, inData ? inData : allocate<InValue>(m_inShape))},
+      m_out {initFftwBuffer<OutValue>(
+          m_outShape,
+          m_count,
+          outData ? outData :
+                    (policy.isInPlace() ? reinterpret_cast<OutValue*>(m_in.data()) : allocate<OutValue>(m_outShape)))},
+      m_plan {}, m_inScale {inScale ? inScale : std::make_shared<Real>(1)},
+      m_outScale {outScale ? outScale : (policy.isInPlace() ? m_inScale : std::make_shared<Real>(1))},
+      m_stats {initStats(shape, count, policy)} {
+    try {
+      m_plan = FftwPlanner::instance().plan<Type>(m_shape, m_count, m_policy, m_in, m_out);
+    } catch (...) {
+      releaseBuffers(); // The destructor is not called
+      throw;
+    }
+  }
 
 public:
   /**
    * @brief Constructor.
    * @param shape The logical plane shape
    * @param count The number of planes
-   */
-  DftPlan(Fits::Position<2> shape, long count = 1) : DftPlan(shape, count, nullptr, nullptr) {
-    assert(not(m_sharing & SharesIn));
-    assert(not(m_sharing & SharesOut));
+   * @param policy The planning policy
+   * @param pool The pool in which buffers are allocated, or `nullptr` to allocate them with FFTW directly
+   * @details
+   * With a pool, e.g. the arena of the calling thread (see `BufferPool::local()`),
+   * buffers are drawn from it and returned to it at destruction, such that plans of the same geometry recycle memory.
+   */
+  DftPlan(
+      Fits::Position<2> shape,
+      long count = 1,
+      const PlanningPolicy& policy = PlanningPolicy(),
+      std::shared_ptr<BufferPool> pool = nullptr) :
+      DftPlan(shape, count, policy, nullptr, nullptr, nullptr, nullptr, std::move(pool)) {
+    assert(m_owning & OwnsIn);
+    assert(policy.isInPlace() || (m_owning & OwnsOut));
   }
 
-  DftPlan(const DftPlan&) = default;
-  DftPlan(DftPlan&&) = default;
-  DftPlan& operator=(const DftPlan&) = default;
-  DftPlan& operator=(DftPlan&&) = default;
+  /**
+   * @brief Create a plan of the smallest fast shape which can hold a given shape (see `fastShape()`).
+   * @param shape The minimum logical plane shape
+   * @param count The number of planes
+   * @param policy The planning policy
+   * @details
+   * Pair it with `load()`, which zero-pads into the input buffer, and `crop()`, which crops the output buffer,
+   * such that data of any shape get the fast path of FFTW:
+   * \code
+   * auto dft = RealDft::padded({1001, 997}); // Logical shape is 1008x1000
+   * auto inverse = dft.inverse();
+   * dft.load(image).transform().multiply(filter);
+   * inverse.transform().normalizeLazily().crop(result); // result has the shape of image, normalized in the same pass
+   * \endcode
+   * As the DFT of the padded input is not that of the input, the padded shape is only suited to methods
+   * which are not sensitive to the zero-padding, e.g. linear convolution with kernels smaller than the padding.
+   */
+  static DftPlan padded(
+      const Fits::Position<2>& shape,
+      long count = 1,
+      const PlanningPolicy& policy = PlanningPolicy(),
+      std::shared_ptr<BufferPool> pool = nullptr) {
+    return DftPlan(fastShape(shape), count, policy, std::move(pool));
+  }
+
+  /**
+   * @brief Non-copyable.
+   * @details
+   * Copies would share the buffers while both owning them.
+   * Use `inverse()` or `compose()` for non-owning plans which share buffers.
+   */
+  DftPlan(const DftPlan&) = delete;
+
+  /**
+   * @brief Move constructor.
+   * @details
+   * The buffer ownership and plan are transferred without copy or planning,
+   * such that plans can be stored by value in containers.
+   * The buffers themselves do not move:
+   * plans which share them (e.g. from `inverse()`) and views remain valid.
+   * The moved-from plan owns nothing and should only be destroyed or assigned.
+   */
+  DftPlan(DftPlan&& other) :
+      m_shape {other.m_shape}, m_inShape {other.m_inShape}, m_outShape {other.m_outShape}, m_count {other.m_count},
+      m_policy {other.m_policy}, m_owning {std::exchange(other.m_owning, DoesNotOwn)}, m_pool {std::move(other.m_pool)},
+      m_in {other.m_in}, m_out {other.m_out}, m_plan {std::move(other.m_plan)},
+      m_inScale {std::move(other.m_inScale)}, m_outScale {std::move(other.m_outScale)},
+      m_stats {std::move(other.m_stats)} {}
+
+  /**
+   * @brief Non-copyable.
+   */
+  DftPlan& operator=(const DftPlan&) = delete;
+
+  /**
+   * @brief Move assignment.
+   * @details
+   * The buffers owned by this plan are released beforehand.
+   */
+  DftPlan& operator=(DftPlan&& other) {
+    if (this != &other) {
+      releaseBuffers();
+      m_shape = other.m_shape;
+      m_inShape = other.m_inShape;
+      m_outShape = other.m_outShape;
+      m_count = other.m_count;
+      m_policy = other.m_policy;
+      m_owning = std::exchange(other.m_owning, DoesNotOwn);
+      m_pool = std::move(other.m_pool);
+      m_in = other.m_in;
+      m_out = other.m_out;
+      m_plan = std::move(other.m_plan);
+      m_inScale = std::move(other.m_inScale);
+      m_outScale = std::move(other.m_outScale);
+      m_stats = std::move(other.m_stats);
+    }
+    return *this;
+  }
 
   /**
    * @brief Create the inverse `DftPlan` with shared buffers.
@@ -197,9 +339,11 @@ public:
    * @warning
    * This plan (`planA` from the snippet) is the owner of the buffers, which will be freed by its destructor,
    * which means that the buffers of the inverse plan (`planB`) has the same life cycle.
+   * 
+   * The inverse plan inherits the planning policy of this plan, and therefore its placement.
    */
   Inverse inverse() {
-    return {m_shape, m_count, m_out.data(), m_in.data()};
+    return {m_shape, m_count, m_policy, m_out.data(), m_in.data(), m_outScale, m_inScale, m_pool};
   }
 
   /**
@@ -213,27 +357,24 @@ public:
    * @warning
    * This plan (`planA` from the snippet) is the owner of its output buffer, which will be freed by its destructor,
    * which means that the input buffer of the composed plan (`planB`) has the same life cycle.
+   * 
+   * The composed plan inherits the planning policy of this plan.
+   * If it is in place, its output buffer is its input buffer, i.e. this plan's output buffer.
    */
   template <typename TPlan>
   TPlan compose(const Fits::Position<2>& shape) {
-    assert(outShape() == TPlan::Type::inShape(shape));
-    return {shape, m_count, m_out.data(), nullptr};
+    assert(outShape() == TPlan::inBufferShape(shape, m_policy));
+    return {shape, m_count, m_policy, m_out.data(), nullptr, m_outScale, nullptr, m_pool};
   }
 
   /**
    * @brief Destructor.
    * @warning
-   * Buffers are freed.
+   * Buffers are freed or returned to their pool.
    * If data has to outlive the `DftPlan` object, buffers should be copied beforehand.
    */
   ~DftPlan() {
-    fftw_destroy_plan(m_plan);
-    if (m_owning & OwnsIn) {
-      fftw_free(m_in.data());
-    }
-    if (m_owning & OwnsOut) {
-      fftw_free(m_out.data());
-    }
+    releaseBuffers();
     FftwGlobalsCleaner::instantiate();
   }
 
@@ -251,8 +392,17 @@ public:
     return m_shape;
   }
 
+  /**
+   * @brief Get the planning policy.
+   */
+  const PlanningPolicy& policy() const {
+    return m_policy;
+  }
+
   /**
    * @brief Get the input buffer shape.
+   * @details
+   * This is the padded shape for in-place real transforms.
    */
   const Fits::Position<2>& inShape() const {
     return m_inShape;
@@ -260,6 +410,8 @@ public:
 
   /**
    * @brief Access the input buffer.
+   * @details
+   * The values do not include the pending scale factor of the buffer, if any (see `scaleLazily()`).
    * @warning
    * Contains garbage after `execute()` has been called.
    */
@@ -274,8 +426,25 @@ public:
     return m_in.section(index);
   }
 
+  /**
+   * @brief Access the whole input stack.
+   * @copydetails inBuffer()
+   */
+  const Fits::PtrRaster<const InValue, 3> inStack() const {
+    return {m_in.shape(), m_in.data()};
+  }
+
+  /**
+   * @copydoc inStack()
+   */
+  Fits::PtrRaster<InValue, 3> inStack() {
+    return m_in;
+  }
+
   /**
    * @brief Get the output buffer shape.
+   * @details
+   * This is the padded shape for in-place inverse real transforms.
    */
   const Fits::Position<2>& outShape() const {
     return m_outShape;
@@ -283,6 +452,8 @@ public:
 
   /**
    * @brief Access the output buffer.
+   * @details
+   * The values do not include the pending scale factor of the buffer, if any (see `scaleLazily()`).
    */
   const Fits::PtrRaster<const OutValue> outBuffer(long index = 0) const {
     return m_out.section(index);
@@ -295,33 +466,451 @@ public:
     return m_out.section(index);
   }
 
+  /**
+   * @brief Access the whole output stack.
+   * @copydetails outBuffer()
+   */
+  const Fits::PtrRaster<const OutValue, 3> outStack() const {
+    return {m_out.shape(), m_out.data()};
+  }
+
+  /**
+   * @copydoc outStack()
+   */
+  Fits::PtrRaster<OutValue, 3> outStack() {
+    return m_out;
+  }
+
   /**
    * @brief Get the normalization factor.
    */
   double normalizationFactor() const {
-    return m_shape[0] * m_shape[1];
+    return Type::normalizationFactor(m_shape, m_count);
   }
 
   /**
    * @brief Compute the transform.
+   * @details
+   * The pending scale factor of the input buffer is forwarded to the output buffer.
    */
   DftPlan& transform() {
-    fftw_execute(m_plan);
+    const Real factor = *m_inScale;
+    *m_inScale = 1; // Input is garbage now
+    if (m_stats) {
+      const auto start = std::chrono::steady_clock::now();
+      executeFftwPlan<Type>(m_plan.get(), m_in, m_out);
+      record(start);
+    } else {
+      executeFftwPlan<Type>(m_plan.get(), m_in, m_out);
+    }
+    *m_outScale = factor;
+    return *this;
+  }
+
+  /**
+   * @brief Compute the transform of external buffers.
+   * @param in The input raster or stack, of the shape of `inStack()`
+   * @param out The output raster or stack, of the shape of `outStack()`
+   * @details
+   * The plan is executed on the given buffers instead of its own, without copy,
+   * such that a single planned geometry can process data which lives elsewhere (e.g. in a `VecRaster`).
+   * As FFTW's new-array execution functions are thread-safe,
+   * this method can be called concurrently on the same plan with different buffers.
+   *
+   * The buffers must have the alignment of the plan buffers,
+   * which is the case when they are allocated with `fftw_malloc()` (or the matching precision) or a `BufferPool`,
+   * and they must be identical if the plan is in place, distinct otherwise.
+   * Pending scale factors are neither applied nor forwarded, and the input buffer may be overwritten.
+   * Throws `std::invalid_argument` if the requirements are not met.
+   */
+  template <typename TIn, typename TOut>
+  const DftPlan& transform(TIn& in, TOut& out) const {
+    const void* inData = in.data();
+    const void* outData = out.data();
+    if (in.size() != m_in.size() || out.size() != m_out.size()) {
+      throw std::invalid_argument(
+          "External buffer sizes (" + std::to_string(in.size()) + ", " + std::to_string(out.size()) +
+          ") differ from the plan buffer sizes (" + std::to_string(m_in.size()) + ", " +
+          std::to_string(m_out.size()) + ")");
+    }
+    if (alignment(inData) != alignment(m_in.data()) || alignment(outData) != alignment(m_out.data())) {
+      throw std::invalid_argument("External buffers are not aligned like the plan buffers (use fftw_malloc())");
+    }
+    if ((inData == outData) != m_policy.isInPlace()) {
+      throw std::invalid_argument(
+          m_policy.isInPlace() ? "External buffers of an in-place plan must be identical" :
+                                 "External buffers of an out-of-place plan must be distinct");
+    }
+    Fits::PtrRaster<InValue, 3> inView(m_in.shape(), in.data());
+    Fits::PtrRaster<OutValue, 3> outView(m_out.shape(), out.data());
+    if (m_stats) {
+      const auto start = std::chrono::steady_clock::now();
+      executeFftwPlan<Type>(m_plan.get(), inView, outView);
+      record(start);
+    } else {
+      executeFftwPlan<Type>(m_plan.get(), inView, outView);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Get the pending scale factor of the output buffer.
+   * @details
+   * This can be used to merge the factor into some custom processing,
+   * in which case it should then be reset with `discardScale()`.
+   */
+  Real pendingScale() const {
+    return *m_outScale;
+  }
+
+  /**
+   * @brief Reset the pending scale factor of the output buffer, without applying it.
+   */
+  DftPlan& discardScale() {
+    *m_outScale = 1;
+    return *this;
+  }
+
+  /**
+   * @brief Apply the pending scale factor of the output buffer, if any.
+   * @details
+   * This modifies the values of the buffer in place,
+   * and must not be called concurrently with reading the buffer.
+   */
+  DftPlan& flush() {
+    apply(m_out, *m_outScale);
     return *this;
   }
 
   /**
-   * @brief Divide by the output buffer by the normalization factor.
+   * @brief Divide the output buffer by the normalization factor.
    */
   DftPlan& normalize() {
-    const auto factor = normalizationFactor();
-    for (auto& c : m_out) {
-      c /= factor;
+    return scale(Real(1) / static_cast<Real>(normalizationFactor()));
+  }
+
+  /**
+   * @brief Multiply the output buffer by a factor.
+   * @details
+   * The pending scale factor, if any, is applied in the same pass.
+   */
+  DftPlan& scale(Real factor) {
+    *m_outScale *= factor;
+    return flush();
+  }
+
+  /**
+   * @brief Divide the output buffer by the normalization factor, lazily.
+   * @see scaleLazily()
+   */
+  DftPlan& normalizeLazily() {
+    return scaleLazily(Real(1) / static_cast<Real>(normalizationFactor()));
+  }
+
+  /**
+   * @brief Multiply the output buffer by a factor, lazily.
+   * @details
+   * The factor is merged into the pending scale factor of the output buffer,
+   * which is applied by the next fused kernel (e.g. `multiply()`) or by `flush()`,
+   * or forwarded by the transforms which read the buffer.
+   */
+  DftPlan& scaleLazily(Real factor) {
+    *m_outScale *= factor;
+    return *this;
+  }
+
+  /**
+   * @brief Multiply each plane of the output buffer by a filter.
+   * @param filter The filter, of shape `outShape()`, with real or complex values
+   * @details
+   * The pending scale factor is applied in the same pass.
+   */
+  template <typename TFilter>
+  DftPlan& multiply(const TFilter& filter) {
+    return multiplyScale(filter, 1);
+  }
+
+  /**
+   * @brief Multiply each plane of the output buffer by a filter and a factor, in a single pass.
+   * @details
+   * The pending scale factor is applied in the same pass.
+   * \code
+   * dft.transform().multiplyScale(filter, 1. / dft.normalizationFactor());
+   * inverse.transform(); // Already normalized
+   * \endcode
+   */
+  template <typename TFilter>
+  DftPlan& multiplyScale(const TFilter& filter, Real factor) {
+    Fourier::multiplyScale(m_out, filter, factor * *m_outScale);
+    *m_outScale = 1;
+    return *this;
+  }
+
+  /**
+   * @brief Apply a pointwise function to the output buffer and write the result into the input buffer of a plan.
+   * @param next The plan to be fed, whose input buffer has the logical shape of this plan's output buffer
+   * @param func The function, which maps an `OutValue` to a `TPlan::InValue`
+   * @details
+   * This is a fused pipeline stage, which saves the allocation and memory pass of an intermediate raster.
+   * The output buffer is left untouched, and its pending scale factor is applied to the values passed to `func`.
+   * The pending scale factor of the input buffer of `next` is discarded.
+   * \code
+   * ComplexDft pupilToPsf(shape);
+   * RealDft psfToMtf(shape);
+   * pupilToPsf.transform().pipe(psfToMtf, Norm2()); // Feed psfToMtf with the intensity
+   * psfToMtf.transform();
+   * \endcode
+   */
+  template <typename TPlanType, typename TFunc>
+  DftPlan& pipe(DftPlan<TPlanType>& next, TFunc&& func) {
+    *next.m_inScale = 1;
+    return pipe(next.m_in, std::forward<TFunc>(func));
+  }
+
+  /**
+   * @brief Apply a pointwise function to the output buffer and write the result into a raster.
+   * @param out The output raster or stack, whose rows may be padded,
+   *        of the unpadded output shape of this plan, with at least `count()` planes
+   * @param func The function
+   * @details
+   * The values are processed in cache-sized blocks, in parallel (`omp parallel for`) and vectorized (`omp simd`),
+   * or row-wise if either buffer is padded.
+   */
+  template <typename TRaster, typename TFunc>
+  DftPlan& pipe(TRaster&& out, TFunc&& func) {
+    constexpr long blockSize = 4096;
+    const auto shape = Type::outShape(m_shape);
+    const long width = shape[0];
+    const long height = shape[1];
+    const long inStride = m_outShape[0];
+    const long outStride = out.shape()[0];
+    if (outStride < width || out.shape()[1] != height || out.size() < outStride * height * m_count) {
+      throw std::invalid_argument(
+          "Pipe output shape " + std::to_string(outStride) + "x" + std::to_string(out.shape()[1]) +
+          " does not match plan output shape " + std::to_string(width) + "x" + std::to_string(height));
+    }
+    const bool contiguous = inStride == width && outStride == width;
+    const long size = width * height * m_count;
+    const long length = contiguous ? std::min(size, blockSize) : width;
+    const long rows = contiguous ? (size + length - 1) / length : height * m_count;
+    const long inStep = contiguous ? length : inStride;
+    const long outStep = contiguous ? length : outStride;
+    const Real factor = *m_outScale;
+    const OutValue* src = m_out.data();
+    auto* dst = out.data();
+#pragma omp parallel for if (rows > 1)
+    for (long r = 0; r < rows; ++r) {
+      const long n = contiguous ? std::min(length, size - r * length) : length;
+      const OutValue* i = src + r * inStep;
+      auto* o = dst + r * outStep;
+#pragma omp simd
+      for (long k = 0; k < n; ++k) {
+        o[k] = func(i[k] * factor);
+      }
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Copy a raster or stack into the top-left corner of the input buffer, and zero-fill the rest.
+   * @param in The input raster or stack, not larger than the unpadded input shape, with at most `count()` planes
+   * @details
+   * The pending scale factor of the input buffer is discarded.
+   * Planes are processed in parallel (`omp parallel for`).
+   * @see padded()
+   */
+  template <typename TRaster>
+  DftPlan& load(const TRaster& in) {
+    const auto shape = Type::inShape(m_shape);
+    const long width = in.shape()[0];
+    const long height = in.shape()[1];
+    checkCorner(width, height, shape, "Loaded");
+    const long count = planeCount(in, width * height);
+    if (count > m_count) {
+      throw std::invalid_argument("Loaded raster has more planes than the plan");
+    }
+    *m_inScale = 1;
+    const long stride = m_inShape[0];
+    const long planeSize = stride * m_inShape[1];
+    const auto* src = in.data();
+    InValue* dst = m_in.data();
+#pragma omp parallel for if (m_count > 1)
+    for (long k = 0; k < m_count; ++k) {
+      InValue* plane = dst + k * planeSize;
+      if (k >= count) {
+        std::fill_n(plane, planeSize, InValue(0));
+        continue;
+      }
+      for (long y = 0; y < height; ++y) {
+        std::copy_n(src + (k * height + y) * width, width, plane + y * stride);
+        std::fill_n(plane + y * stride + width, stride - width, InValue(0));
+      }
+      std::fill_n(plane + height * stride, (m_inShape[1] - height) * stride, InValue(0));
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Copy the top-left corner of the output buffer into a raster or stack.
+   * @param out The output raster or stack, not larger than the unpadded output shape, with at most `count()` planes
+   * @details
+   * The pending scale factor of the output buffer is applied to the copied values only.
+   * Planes are processed in parallel (`omp parallel for`).
+   * @see padded()
+   */
+  template <typename TRaster>
+  const DftPlan& crop(TRaster&& out) const {
+    const auto shape = Type::outShape(m_shape);
+    const long width = out.shape()[0];
+    const long height = out.shape()[1];
+    checkCorner(width, height, shape, "Cropped");
+    const long count = planeCount(out, width * height);
+    if (count > m_count) {
+      throw std::invalid_argument("Cropped raster has more planes than the plan");
+    }
+    const Real factor = *m_outScale;
+    const long stride = m_outShape[0];
+    const OutValue* src = m_out.data();
+    auto* dst = out.data();
+    const long rows = height * count;
+#pragma omp parallel for if (rows > 1)
+    for (long r = 0; r < rows; ++r) {
+      const OutValue* i = src + (r / height * m_outShape[1] + r % height) * stride;
+      auto* o = dst + r * width;
+#pragma omp simd
+      for (long x = 0; x < width; ++x) {
+        o[x] = i[x] * factor;
+      }
     }
     return *this;
   }
 
 private:
+  /**
+   * @brief Check that a corner fits in a buffer shape.
+   */
+  static void checkCorner(long width, long height, const Fits::Position<2>& shape, const std::string& name) {
+    if (width > shape[0] || height > shape[1]) {
+      throw std::invalid_argument(
+          name + " shape " + std::to_string(width) + "x" + std::to_string(height) + " exceeds plan shape " +
+          std::to_string(shape[0]) + "x" + std::to_string(shape[1]));
+    }
+  }
+
+  /**
+   * @brief Compute the input buffer shape of a plan.
+   * @details
+   * For in-place real transforms, real rows are padded to hold the complex rows.
+   */
+  static Fits::Position<2> inBufferShape(const Fits::Position<2>& shape, const PlanningPolicy& policy) {
+    auto bufferShape = Type::inShape(shape);
+    if (policy.isInPlace() && std::is_same<InValue, Real>::value && not std::is_same<OutValue, Real>::value) {
+      bufferShape[0] = 2 * Type::outShape(shape)[0];
+    }
+    return bufferShape;
+  }
+
+  /**
+   * @brief Compute the output buffer shape of a plan.
+   * @copydetails inBufferShape()
+   */
+  static Fits::Position<2> outBufferShape(const Fits::Position<2>& shape, const PlanningPolicy& policy) {
+    auto bufferShape = Type::outShape(shape);
+    if (policy.isInPlace() && std::is_same<OutValue, Real>::value && not std::is_same<InValue, Real>::value) {
+      bufferShape[0] = 2 * Type::inShape(shape)[0];
+    }
+    return bufferShape;
+  }
+
+  /**
+   * @brief Apply and reset a pending scale factor.
+   */
+  template <typename T>
+  static void apply(Fits::PtrRaster<T, 3>& buffer, Real& factor) {
+    if (factor == 1) {
+      return;
+    }
+    Fourier::scale(buffer, factor);
+    factor = 1;
+  }
+
+  /**
+   * @brief Get the counters of the plan key if `PlanStats` is enabled, or `nullptr`.
+   */
+  static std::shared_ptr<PlanCounters>
+  initStats(const Fits::Position<2>& shape, long count, const PlanningPolicy& policy) {
+    auto& stats = PlanStats::instance();
+    return stats.enabled() ? stats.counters(FftwWisdom::key<Type>(shape, count, policy)) : nullptr;
+  }
+
+  /**
+   * @brief Record a transform which started at given time.
+   * @details
+   * The bytes of in-place buffers are counted once.
+   */
+  void record(std::chrono::steady_clock::time_point start) const {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double inBytes = sizeof(InValue) * m_in.size();
+    const double outBytes = m_policy.isInPlace() ? 0 : sizeof(OutValue) * m_out.size();
+    m_stats->recordTransform(elapsed.count(), inBytes + outBytes);
+  }
+
+  /**
+   * @brief Get the SIMD alignment of some data, as seen by FFTW.
+   */
+  static int alignment(const void* data) {
+    return FftwTraits<Real>::alignmentOf(static_cast<Real*>(const_cast<void*>(data)));
+  }
+
+  /**
+   * @brief Allocate a buffer of given plane shape, from the pool if any.
+   */
+  template <typename T>
+  T* allocate(const Fits::Position<2>& shape) const {
+    const long size = shapeSize(shape) * m_count;
+    if (m_pool) {
+      return m_pool->allocate<T>(size);
+    }
+    return static_cast<T*>(FftwTraits<Real>::malloc(sizeof(T) * size));
+  }
+
+  /**
+   * @brief Free a buffer or return it to the pool.
+   */
+  template <typename T>
+  void release(const Fits::PtrRaster<T, 3>& buffer) {
+    if (m_pool) {
+      m_pool->release(buffer.data(), buffer.size());
+    } else {
+      FftwTraits<Real>::free(const_cast<T*>(buffer.data()));
+    }
+  }
+
+  /**
+   * @brief Release the owned buffers, if any.
+   */
+  void releaseBuffers() {
+    if (m_owning & OwnsIn) {
+      release(m_in);
+    }
+    if (m_owning & OwnsOut) {
+      release(m_out);
+    }
+    m_owning = DoesNotOwn;
+  }
+
+  /**
+   * @brief Compute the buffer owning flags of a plan.
+   * @details
+   * In place, the input buffer is the only allocated one.
+   */
+  static BufferOwning owning(const PlanningPolicy& policy, const InValue* inData, const OutValue* outData) {
+    if (policy.isInPlace()) {
+      return inData ? DoesNotOwn : OwnsIn;
+    }
+    return BufferOwning((inData ? DoesNotOwn : OwnsIn) | (outData ? DoesNotOwn : OwnsOut));
+  }
+
   /**
    * @brief The logical shape.
    */
@@ -342,11 +931,21 @@ private:
    */
   long m_count;
 
+  /**
+   * @brief The planning policy.
+   */
+  PlanningPolicy m_policy;
+
   /**
    * @brief The buffer sharing flags.
    */
   BufferOwning m_owning;
 
+  /**
+   * @brief The buffer pool, or `nullptr`.
+   */
+  std::shared_ptr<BufferPool> m_pool;
+
   /**
    * @brief The input stack.
    */
@@ -358,9 +957,24 @@ private:
   Fits::PtrRaster<OutValue, 3> m_out;
 
   /**
-   * @brief The transform plan.
+   * @brief The transform plan, which may be shared with other `DftPlan`s of identical geometry.
+   */
+  FftwPlanner::Plan<Real> m_plan;
+
+  /**
+   * @brief The pending scale factor of the input buffer, shared with the plans which share the buffer.
+   */
+  std::shared_ptr<Real> m_inScale;
+
+  /**
+   * @brief The pending scale factor of the output buffer, shared with the plans which share the buffer.
+   */
+  std::shared_ptr<Real> m_outScale;
+
+  /**
+   * @brief The statistics of the plan key, or `nullptr` if disabled (see `PlanStats`).
    */
-  fftw_plan m_plan;
+  std::shared_ptr<PlanCounters> m_stats;
 };
 
 /**
@@ -0,0 +1,330 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_DFTSTREAM_H
+#define _ELEFOURIER_DFTSTREAM_H
+
+#include "EleFits/MefFile.h"
+#include "EleFourier/DftPlan.h"
+
+#include <algorithm> // min
+#include <array>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Streaming pipeline which overlaps the reading, transforming and writing of image sequences.
+ * @tparam TPlan The `DftPlan` type
+ * @details
+ * Images are processed by batches, in two slots (i.e. two plans of `batch` planes),
+ * such that while batch `k` is computed in one slot, batch `k + 1` is read into the input buffer of the other slot,
+ * and batch `k - 1` is written from its output buffer.
+ * Reading and writing are performed by asynchronous tasks (one of each at a time, in order),
+ * while computation is performed by the calling thread.
+ * This moves the wall time from `read + compute + write` toward `max(read, compute, write)`,
+ * and only `2 * batch` images are held in memory, whatever the sequence length.
+ *
+ * The stages are user-defined functions:
+ * - `read(index, plane)` fills `plane` (a `Fits::PtrRaster<InValue>`) with the image of given index;
+ * - `process(plan, size)` computes the first `size` planes of `plan`, e.g. `plan.transform()`;
+ * - `write(index, plane)` consumes `plane` (a `Fits::PtrRaster<const OutValue>`), e.g. writes it to a file.
+ *
+ * As the input buffer of a slot is refilled while its output buffer is being written,
+ * the results must be in the output buffer, and the plans cannot be in place.
+ * Reading and writing are executed concurrently, in different threads:
+ * they must therefore target different files (CFITSIO must be built reentrant).
+ *
+ * \code
+ * Fits::MefFile input("in.fits", Fits::FileMode::Read);
+ * Fits::MefFile output("out.fits", Fits::FileMode::Create);
+ * DftStream<ComplexDft> stream(shape, 8);
+ * stream.run(
+ *     input.hduCount() - 1,
+ *     stream.mefReader(input, 1),
+ *     [](ComplexDft& plan, long) { plan.transform().normalize(); },
+ *     [&](long, const Fits::PtrRaster<const std::complex<double>>& plane) { ... });
+ * \endcode
+ */
+template <typename TPlan>
+class DftStream {
+
+public:
+  /**
+   * @brief The input value type.
+   */
+  using InValue = typename TPlan::InValue;
+
+  /**
+   * @brief The output value type.
+   */
+  using OutValue = typename TPlan::OutValue;
+
+  /**
+   * @brief Constructor.
+   * @param shape The logical plane shape
+   * @param batch The number of images per batch
+   * @param policy The planning policy, which cannot be in place
+   */
+  DftStream(const Fits::Position<2>& shape, long batch, const PlanningPolicy& policy = PlanningPolicy()) :
+      m_slots {{TPlan(shape, batch, outOfPlace(policy)), TPlan(shape, batch, policy)}}, m_readSeconds(0),
+      m_computeSeconds(0), m_writeSeconds(0), m_wallSeconds(0) {}
+
+  /**
+   * @brief Get the batch size.
+   */
+  long batch() const {
+    return m_slots[0].count();
+  }
+
+  /**
+   * @brief Access a slot.
+   */
+  TPlan& slot(long index) {
+    return m_slots[index];
+  }
+
+  /**
+   * @brief Process a sequence of images.
+   * @param count The number of images
+   * @param read The reading function
+   * @param process The computation function
+   * @param write The writing function
+   * @return The number of processed images
+   * @details
+   * Exceptions thrown by any stage are rethrown once the pending tasks have completed.
+   */
+  template <typename TRead, typename TProcess, typename TWrite>
+  long run(long count, TRead&& read, TProcess&& process, TWrite&& write) {
+    const auto begin = std::chrono::steady_clock::now();
+    const long batchCount = (count + batch() - 1) / batch();
+    std::future<void> reading;
+    std::array<std::shared_future<void>, 2> writing; // Of the last batch of each slot
+    if (batchCount > 0) {
+      reading = readAsync(0, count, read);
+    }
+    try {
+      for (long k = 0; k < batchCount; ++k) {
+        auto& plan = m_slots[k % 2];
+        reading.get(); // Batch k is in slot k % 2
+        if (k + 1 < batchCount) {
+          reading = readAsync(k + 1, count, read); // Input buffer of the other slot is free
+        }
+        if (writing[k % 2].valid()) {
+          writing[k % 2].get(); // Output buffer of this slot is being written from batch k - 2 otherwise
+        }
+        const auto computeBegin = std::chrono::steady_clock::now();
+        process(plan, size(k, count));
+        plan.flush();
+        m_computeSeconds += seconds(computeBegin);
+        writing[k % 2] = writeAsync(k, count, write, writing[(k + 1) % 2]); // Overlaps batch k + 1
+      }
+      for (auto& w : writing) {
+        if (w.valid()) {
+          w.get();
+        }
+      }
+    } catch (...) {
+      if (reading.valid()) {
+        reading.wait();
+      }
+      for (auto& w : writing) {
+        if (w.valid()) {
+          w.wait();
+        }
+      }
+      throw;
+    }
+    m_wallSeconds += seconds(begin);
+    return count;
+  }
+
+  /**
+   * @brief Process a sequence of images with the default computation, i.e. `transform()`.
+   */
+  template <typename TRead, typename TWrite>
+  long run(long count, TRead&& read, TWrite&& write) {
+    return run(
+        count,
+        std::forward<TRead>(read),
+        [](TPlan& plan, long) {
+          plan.transform();
+        },
+        std::forward<TWrite>(write));
+  }
+
+  /**
+   * @brief Make a reading function which reads consecutive image HDUs of a `MefFile`.
+   * @param file The input file
+   * @param first The index of the HDU of the first image, e.g. 1 to skip the Primary
+   */
+  static auto mefReader(const Fits::MefFile& file, long first = 1) {
+    return [&file, first](long index, Fits::PtrRaster<InValue>& plane) {
+      file.access<Fits::ImageRaster>(first + index).readTo(plane);
+    };
+  }
+
+  /**
+   * @brief Make a writing function which appends image extensions to a `MefFile`.
+   * @details
+   * This requires the output value type to be supported by FITS images, which excludes complex values.
+   */
+  static auto mefWriter(Fits::MefFile& file) {
+    return [&file](long, const Fits::PtrRaster<const OutValue>& plane) {
+      file.appendImage("", {}, plane);
+    };
+  }
+
+  /**
+   * @brief Get the total time spent reading, in seconds.
+   */
+  double readSeconds() const {
+    return m_readSeconds;
+  }
+
+  /**
+   * @brief Get the total time spent computing, in seconds.
+   */
+  double computeSeconds() const {
+    return m_computeSeconds;
+  }
+
+  /**
+   * @brief Get the total time spent writing, in seconds.
+   */
+  double writeSeconds() const {
+    return m_writeSeconds;
+  }
+
+  /**
+   * @brief Get the total wall time of the runs, in seconds.
+   * @details
+   * Without overlapping, this would be the sum of the reading, computing and writing times.
+   */
+  double wallSeconds() const {
+    return m_wallSeconds;
+  }
+
+private:
+  /**
+   * @brief Check that a policy is out of place.
+   */
+  static const PlanningPolicy& outOfPlace(const PlanningPolicy& policy) {
+    if (policy.isInPlace()) {
+      throw std::invalid_argument("DftStream does not support in-place plans");
+    }
+    return policy;
+  }
+
+  /**
+   * @brief Compute the number of images of a batch.
+   */
+  long size(long k, long count) const {
+    return std::min(batch(), count - k * batch());
+  }
+
+  /**
+   * @brief Get the time elapsed since some time point, in seconds.
+   */
+  static double seconds(const std::chrono::steady_clock::time_point& begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+  }
+
+  /**
+   * @brief Launch the reading of a batch into its slot.
+   * @details
+   * The buffers are accessed in the calling thread, such that the task does not touch the plan.
+   */
+  template <typename TRead>
+  std::future<void> readAsync(long k, long count, TRead& read) {
+    const long n = size(k, count);
+    std::vector<Fits::PtrRaster<InValue>> planes;
+    for (long i = 0; i < n; ++i) {
+      planes.push_back(m_slots[k % 2].inBuffer(i));
+    }
+    return std::async(std::launch::async, [this, &read, planes, k]() mutable {
+      const auto begin = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < planes.size(); ++i) {
+        read(k * batch() + i, planes[i]);
+      }
+      m_readSeconds += seconds(begin);
+    });
+  }
+
+  /**
+   * @brief Launch the writing of a batch from its slot, after the writing of the previous batch.
+   * @details
+   * The buffers are accessed in the calling thread, such that the task does not touch the plan.
+   * Writes are chained, such that they are performed one at a time, in order,
+   * and errors of the previous batch are propagated.
+   */
+  template <typename TWrite>
+  std::shared_future<void> writeAsync(long k, long count, TWrite& write, std::shared_future<void> previous) {
+    const long n = size(k, count);
+    std::vector<Fits::PtrRaster<const OutValue>> planes;
+    const auto& plan = m_slots[k % 2];
+    for (long i = 0; i < n; ++i) {
+      planes.push_back(plan.outBuffer(i));
+    }
+    return std::async(std::launch::async, [this, &write, planes, k, previous]() {
+      if (previous.valid()) {
+        previous.get();
+      }
+      const auto begin = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < planes.size(); ++i) {
+        write(k * batch() + i, planes[i]);
+      }
+      m_writeSeconds += seconds(begin);
+    }).share();
+  }
+
+  /**
+   * @brief The two slots.
+   */
+  std::array<TPlan, 2> m_slots;
+
+  /**
+   * @brief The reading time, in seconds.
+   */
+  double m_readSeconds;
+
+  /**
+   * @brief The computation time, in seconds.
+   */
+  double m_computeSeconds;
+
+  /**
+   * @brief The writing time, in seconds.
+   */
+  double m_writeSeconds;
+
+  /**
+   * @brief The wall time, in seconds.
+   */
+  double m_wallSeconds;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -21,9 +21,11 @@
 #define _ELEFOURIER_DFTTYPE_H
 
 #include "EleFitsData/Raster.h"
+#include "EleFourier/FftwTraits.h"
 
 #include <complex>
 #include <fftw3.h>
+#include <string>
 
 namespace Euclid {
 namespace Fourier {
@@ -33,6 +35,10 @@ struct Inverse;
 
 /**
  * @brief Base DFT type to be inherited.
+ * @details
+ * Child classes must provide a static `name()` function,
+ * and hide `inShape()` and `outShape()` if the buffer shapes differ from the logical shape,
+ * as well as `normalizationFactor()` if the transform is not two-dimensional over each plane.
  */
 template <typename TType, typename TIn, typename TOut>
 struct DftType {
@@ -57,6 +63,11 @@ struct DftType {
    */
   using OutValue = TOut;
 
+  /**
+   * @brief The real value type, which sets the precision.
+   */
+  using Real = typename FftwReal<TIn>::Type;
+
   /**
    * @brief The tag of the inverse transform.
    */
@@ -77,6 +88,16 @@ struct DftType {
   static Fits::Position<2> outShape(const Fits::Position<2>& shape) {
     return shape;
   }
+
+  /**
+   * @brief Normalization factor, i.e. the number of values which are summed per coefficient.
+   * @param shape The logical plane shape
+   * @param count The number of planes
+   */
+  static double normalizationFactor(const Fits::Position<2>& shape, long count) {
+    (void)count;
+    return shape[0] * shape[1];
+  }
 };
 
 template <typename TType, typename TIn, typename TOut>
@@ -86,14 +107,23 @@ struct DftType<Inverse<TType>, TIn, TOut> {
   using Type = Inverse<TType>;
   using InValue = TOut;
   using OutValue = TIn;
+  using Real = typename FftwReal<TIn>::Type;
   using InverseType = TType;
 
+  static std::string name() {
+    return "Inverse" + TType::name();
+  }
+
   static Fits::Position<2> inShape(const Fits::Position<2>& shape) {
-    return DftType<TType, TIn, TOut>::outShape(shape);
+    return TType::outShape(shape);
   }
 
   static Fits::Position<2> outShape(const Fits::Position<2>& shape) {
-    return DftType<TType, TIn, TOut>::inShape(shape);
+    return TType::inShape(shape);
+  }
+
+  static double normalizationFactor(const Fits::Position<2>& shape, long count) {
+    return TType::normalizationFactor(shape, count);
   }
 };
 
@@ -102,30 +132,246 @@ struct Inverse : DftType<Inverse<TType>, typename TType::InValue, typename TType
 
 /**
  * @brief Real DFT type.
+ * @tparam T The real value type, i.e. `float`, `double` or `long double`
+ */
+template <typename T>
+struct BasicRealDftType : DftType<BasicRealDftType<T>, T, std::complex<T>> {
+
+  static std::string name() {
+    return "RealDft" + FftwTraits<T>::name();
+  }
+
+  static Fits::Position<2> outShape(const Fits::Position<2>& shape) {
+    return {shape[0] / 2 + 1, shape[1]};
+  }
+};
+
+/**
+ * @brief Double precision real DFT type.
  */
-struct RealDftType;
-struct RealDftType : DftType<RealDftType, double, std::complex<double>> {};
-template <>
-Fits::Position<2> RealDftType::Parent::outShape(const Fits::Position<2>& shape);
+using RealDftType = BasicRealDftType<double>;
 
 /**
  * @brief Complex DFT type.
+ * @tparam T The real value type, i.e. `float`, `double` or `long double`
+ */
+template <typename T>
+struct BasicComplexDftType : DftType<BasicComplexDftType<T>, std::complex<T>, std::complex<T>> {
+
+  static std::string name() {
+    return "ComplexDft" + FftwTraits<T>::name();
+  }
+};
+
+/**
+ * @brief Double precision complex DFT type.
+ */
+using ComplexDftType = BasicComplexDftType<double>;
+
+/**
+ * @brief Complex DFT type with Hermitian symmetry.
+ * @tparam T The real value type, i.e. `float`, `double` or `long double`
+ * @details
+ * The input is a complex plane with Hermitian symmetry, i.e. such that `in(-x, -y) = conj(in(x, y))`,
+ * e.g. the output of a real DFT or the amplitude of a real pupil.
+ * As for `BasicRealDftType` outputs, only the half plane of shape `(width / 2 + 1, height)` is stored.
+ * The output of the transform is real, and of the logical shape.
+ *
+ * The transform is computed by FFTW as a complex-to-real DFT of the conjugated input,
+ * and the inverse transform as a real-to-complex DFT followed by a conjugation,
+ * such that both cost about half a complex DFT and use half the memory.
+ * As for inverse real transforms, the input buffer is overwritten by `transform()`.
+ *
+ * For example, applying the forward transform twice to a real plane yields the flipped plane
+ * (up to the normalization factor), with half-size intermediate buffers:
+ * \code
+ * RealDft dft(shape);
+ * auto twice = dft.compose<HermitianComplexDft>(shape); // Reads dft.outBuffer()
+ * dft.transform();
+ * twice.transform(); // twice.outBuffer()[{x, y}] == width * height * dft.inBuffer()[{-x, -y}], modulo the shape
+ * \endcode
+ */
+template <typename T>
+struct BasicHermitianComplexDftType : DftType<BasicHermitianComplexDftType<T>, std::complex<T>, T> {
+
+  static std::string name() {
+    return "HermitianComplexDft" + FftwTraits<T>::name();
+  }
+
+  static Fits::Position<2> inShape(const Fits::Position<2>& shape) {
+    return {shape[0] / 2 + 1, shape[1]};
+  }
+};
+
+/**
+ * @brief Double precision complex DFT type with Hermitian symmetry.
+ */
+using HermitianComplexDftType = BasicHermitianComplexDftType<double>;
+
+/**
+ * @brief Complex DFT type along one axis.
+ * @tparam T The real value type, i.e. `float`, `double` or `long double`
+ * @tparam Axis The transform axis, i.e. 0 for rows (along x) or 1 for columns (along y)
+ * @details
+ * Each row (resp. column) of each plane is transformed independently,
+ * which is cheaper than a two-dimensional transform when only one direction is needed.
+ */
+template <typename T, long Axis>
+struct BasicComplexAxisDftType : DftType<BasicComplexAxisDftType<T, Axis>, std::complex<T>, std::complex<T>> {
+
+  static_assert(Axis == 0 || Axis == 1, "Axis must be 0 or 1");
+
+  static std::string name() {
+    return "ComplexAxis" + std::to_string(Axis) + "Dft" + FftwTraits<T>::name();
+  }
+
+  static double normalizationFactor(const Fits::Position<2>& shape, long) {
+    return shape[Axis];
+  }
+};
+
+/**
+ * @brief Double precision complex DFT type along the rows.
+ */
+using ComplexRowDftType = BasicComplexAxisDftType<double, 0>;
+
+/**
+ * @brief Double precision complex DFT type along the columns.
+ */
+using ComplexColumnDftType = BasicComplexAxisDftType<double, 1>;
+
+/**
+ * @brief Real DFT type along one axis.
+ * @copydetails BasicComplexAxisDftType
+ *
+ * The output is halved along the transform axis.
+ * In-place transforms are only supported along the rows.
+ */
+template <typename T, long Axis>
+struct BasicRealAxisDftType : DftType<BasicRealAxisDftType<T, Axis>, T, std::complex<T>> {
+
+  static_assert(Axis == 0 || Axis == 1, "Axis must be 0 or 1");
+
+  static std::string name() {
+    return "RealAxis" + std::to_string(Axis) + "Dft" + FftwTraits<T>::name();
+  }
+
+  static Fits::Position<2> outShape(const Fits::Position<2>& shape) {
+    auto out = shape;
+    out[Axis] = shape[Axis] / 2 + 1;
+    return out;
+  }
+
+  static double normalizationFactor(const Fits::Position<2>& shape, long) {
+    return shape[Axis];
+  }
+};
+
+/**
+ * @brief Double precision real DFT type along the rows.
+ */
+using RealRowDftType = BasicRealAxisDftType<double, 0>;
+
+/**
+ * @brief Double precision real DFT type along the columns.
+ */
+using RealColumnDftType = BasicRealAxisDftType<double, 1>;
+
+/**
+ * @brief Three-dimensional complex DFT type over the whole stack, e.g. along (x, y, lambda).
+ * @tparam T The real value type, i.e. `float`, `double` or `long double`
+ */
+template <typename T>
+struct BasicComplexStackDftType : DftType<BasicComplexStackDftType<T>, std::complex<T>, std::complex<T>> {
+
+  static std::string name() {
+    return "ComplexStackDft" + FftwTraits<T>::name();
+  }
+
+  static double normalizationFactor(const Fits::Position<2>& shape, long count) {
+    return shape[0] * shape[1] * count;
+  }
+};
+
+/**
+ * @brief Double precision three-dimensional complex DFT type.
+ */
+using ComplexStackDftType = BasicComplexStackDftType<double>;
+
+/**
+ * @brief Three-dimensional real DFT type over the whole stack, e.g. along (x, y, lambda).
+ * @tparam T The real value type, i.e. `float`, `double` or `long double`
+ * @details
+ * As for `BasicRealDftType`, the output is halved along the rows.
+ */
+template <typename T>
+struct BasicRealStackDftType : DftType<BasicRealStackDftType<T>, T, std::complex<T>> {
+
+  static std::string name() {
+    return "RealStackDft" + FftwTraits<T>::name();
+  }
+
+  static Fits::Position<2> outShape(const Fits::Position<2>& shape) {
+    return {shape[0] / 2 + 1, shape[1]};
+  }
+
+  static double normalizationFactor(const Fits::Position<2>& shape, long count) {
+    return shape[0] * shape[1] * count;
+  }
+};
+
+/**
+ * @brief Double precision three-dimensional real DFT type.
+ */
+using RealStackDftType = BasicRealStackDftType<double>;
+
+/**
+ * @brief The FFTW plan type of a DFT type.
+ */
+template <typename TType>
+using FftwPlan = typename FftwTraits<typename TType::Real>::Plan;
+
+/**
+ * @brief Create a FFTW plan.
+ * @param shape The logical plane shape
+ * @param in The input buffer
+ * @param out The output buffer
+ * @param flags The FFTW planner flags (see `PlanningPolicy`)
+ * @details
+ * Depending on the precision of the type, the plan is created by `fftwf_`, `fftw_` or `fftwl_` functions.
+ * The buffers may be larger than needed for the logical shape, e.g. padded for in-place real transforms,
+ * in which case the buffer shape is used as the FFTW embedding.
+ * If `in` and `out` point to the same memory, the plan is in place.
  */
-struct ComplexDftType;
-struct ComplexDftType : DftType<ComplexDftType, std::complex<double>, std::complex<double>> {};
+template <typename TType>
+FftwPlan<TType> initFftwPlan(
+    const Fits::Position<2>& shape,
+    Fits::PtrRaster<typename TType::InValue, 3>& in,
+    typename Fits::PtrRaster<typename TType::OutValue, 3>& out,
+    unsigned flags = FFTW_MEASURE);
 
 /**
- * @brief Complex DFT type with Hermitian symmertry.
+ * @brief Create an out-of-place FFTW plan whose logical shape is deduced from the buffers.
  */
-struct HermitianComplexDftType;
-struct HermitianComplexDftType : DftType<HermitianComplexDftType, std::complex<double>, std::complex<double>> {};
-template <>
-Fits::Position<2> HermitianComplexDftType::Parent::inShape(const Fits::Position<2>& shape);
-template <>
-Fits::Position<2> HermitianComplexDftType::Parent::outShape(const Fits::Position<2>& shape);
+template <typename TType>
+FftwPlan<TType> initFftwPlan(
+    Fits::PtrRaster<typename TType::InValue, 3>& in,
+    typename Fits::PtrRaster<typename TType::OutValue, 3>& out,
+    unsigned flags = FFTW_MEASURE);
 
+/**
+ * @brief Execute a FFTW plan on given buffers.
+ * @param plan The plan
+ * @param in The input buffer
+ * @param out The output buffer
+ * @details
+ * The buffers may differ from those used for planning,
+ * provided that they have the same shape and alignment (e.g. both allocated with `fftw_malloc()`),
+ * and that they are either both distinct or both identical.
+ */
 template <typename TType>
-fftw_plan initFftwPlan(
+void executeFftwPlan(
+    FftwPlan<TType> plan,
     Fits::PtrRaster<typename TType::InValue, 3>& in,
     typename Fits::PtrRaster<typename TType::OutValue, 3>& out);
 
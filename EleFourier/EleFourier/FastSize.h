@@ -0,0 +1,114 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_FASTSIZE_H
+#define _ELEFOURIER_FASTSIZE_H
+
+#include "EleFitsData/Raster.h"
+
+#include <vector>
+
+/**
+ * @file
+ * @brief Selection of sizes for which FFTW is fast.
+ * @details
+ * FFTW has hard-coded codelets for small prime factors,
+ * while large prime factors fall back to much slower algorithms (e.g. Rader's or Bluestein's).
+ * Sizes of the form `2^a 3^b 5^c 7^d` (a.k.a. 7-smooth numbers) are therefore preferred,
+ * which is typically obtained by zero-padding the input (see `DftPlan::padded()`).
+ * \code
+ * fastSize(1001); // 1008 = 2^4 3^2 7
+ * fastShape({1000, 1537}); // 1000x1568
+ * \endcode
+ */
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Check whether a size is of the form `2^a 3^b 5^c 7^d`.
+ */
+bool isFastSize(long size);
+
+/**
+ * @brief Get the smallest size of the form `2^a 3^b 5^c 7^d` which is not lower than a given size.
+ */
+long fastSize(long min);
+
+/**
+ * @brief Get the sizes of the form `2^a 3^b 5^c 7^d` within a range, in increasing order.
+ */
+std::vector<long> fastSizes(long min, long max);
+
+/**
+ * @brief Get the fast size of minimal cost within a range.
+ * @param min The minimum size
+ * @param cost The cost function `cost(size)`, e.g. a lookup of benchmark timings
+ * @param max The maximum size, or 0 for the smallest power of two which is not lower than `min`
+ * @details
+ * Sizes are evaluated in increasing order, and the smallest one is returned in case of equal costs.
+ * Costs are typically measured over one plane of the target geometry, e.g. from `PlanStats` or `EleFourierBenchmark`:
+ * \code
+ * std::map<long, double> timings = ...; // Median execution times by size
+ * const auto size = fastSize(1001, [&](long s) {
+ *   const auto it = timings.find(s);
+ *   return it == timings.end() ? std::numeric_limits<double>::max() : it->second;
+ * });
+ * \endcode
+ */
+template <typename TCost>
+long fastSize(long min, TCost&& cost, long max = 0) {
+  if (max <= 0) {
+    max = 1;
+    while (max < min) {
+      max *= 2;
+    }
+  }
+  long best = fastSize(min);
+  auto bestCost = cost(best);
+  for (auto size : fastSizes(best + 1, max)) {
+    const auto c = cost(size);
+    if (c < bestCost) {
+      best = size;
+      bestCost = c;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Get the smallest shape of fast sizes which is not lower than a given shape, along each axis.
+ */
+inline Fits::Position<2> fastShape(const Fits::Position<2>& min) {
+  return {fastSize(min[0]), fastSize(min[1])};
+}
+
+/**
+ * @brief Get the shape of fast sizes of minimal cost along each axis.
+ * @see fastSize(long, TCost&&, long)
+ */
+template <typename TCost>
+Fits::Position<2> fastShape(const Fits::Position<2>& min, TCost&& cost) {
+  return {fastSize(min[0], cost), fastSize(min[1], cost)};
+}
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,264 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_FFTWPLANNER_H
+#define _ELEFOURIER_FFTWPLANNER_H
+
+#include "EleFourier/DftType.h"
+#include "EleFourier/FftwTraits.h"
+#include "EleFourier/FftwWisdom.h"
+#include "EleFourier/PlanStats.h"
+#include "EleFourier/PlanningPolicy.h"
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Singleton class to be instantiated by FFTW user classes (e.g. in constructor or destructor)
+ * to ensure proper cleanup at program ending.
+ * @details
+ * The destructor, which is executed once (at the end of the program), calls `fftw_cleanup()`,
+ * or `fftw_cleanup_threads()` if FFTW's multithreading was initialized,
+ * and does the same for the single and long double precision libraries.
+ */
+class FftwGlobalsCleaner {
+private:
+  /**
+   * @brief Private constructor.
+   */
+  FftwGlobalsCleaner() : m_threads {false, false, false} {}
+
+public:
+  /**
+   * @brief Destructor.
+   * @details
+   * Frees FFTW's globals.
+   */
+  ~FftwGlobalsCleaner() {
+    cleanup<float>();
+    cleanup<double>();
+    cleanup<long double>();
+  }
+
+  /**
+   * @brief Instantiate the singleton, to trigger cleanup at destruction.
+   */
+  static FftwGlobalsCleaner& instantiate() {
+    static FftwGlobalsCleaner instance;
+    return instance;
+  }
+
+  /**
+   * @brief Initialize FFTW's multithreading for a given precision, if not already done.
+   * @warning
+   * This is not thread-safe: the mutex of `FftwPlanner` must be held.
+   */
+  template <typename T = double>
+  void initThreads() {
+    auto& flag = m_threads[FftwTraits<T>::Index];
+    if (flag) {
+      return;
+    }
+    if (not FftwTraits<T>::initThreads()) {
+      throw std::runtime_error("Cannot initialize FFTW's multithreading");
+    }
+    flag = true;
+  }
+
+  /**
+   * @brief Check whether FFTW's multithreading was initialized for a given precision.
+   */
+  template <typename T = double>
+  bool threads() const {
+    return m_threads[FftwTraits<T>::Index];
+  }
+
+private:
+  /**
+   * @brief Free the globals of a given precision.
+   */
+  template <typename T>
+  void cleanup() {
+    if (threads<T>()) {
+      FftwTraits<T>::cleanupThreads();
+    } else {
+      FftwTraits<T>::cleanup();
+    }
+  }
+
+  /**
+   * @brief The multithreading initialization flags, indexed by `FftwTraits::Index`.
+   */
+  std::array<bool, 3> m_threads;
+};
+
+/**
+ * @brief Thread-safe and deduplicating factory of FFTW plans.
+ * @details
+ * FFTW's planner writes in global variables, and therefore cannot be called from several threads at once.
+ * The factory serializes planning, plan destruction and wisdom import and export behind a single mutex,
+ * such that `DftPlan`s can be created from within parallel regions, e.g. lazily by each thread.
+ *
+ * Plans are cached by key (type, logical shape, count and planning policy, as in `FftwWisdom`):
+ * requesting a plan which is already alive returns the same plan instead of planning again.
+ * This is possible because `DftPlan` executes plans with FFTW's new-array functions (see `executeFftwPlan()`)
+ * on its own buffers, which all share the alignment of `fftw_malloc()`.
+ * Plans are destroyed when the last `DftPlan` which uses them is destroyed.
+ *
+ * If the planning policy requests several threads (see `PlanningPolicy::parallelize()`),
+ * FFTW's multithreading is initialized on the fly, and the plan will be executed by FFTW's thread pool.
+ *
+ * The factory serves all precisions (see `FftwTraits`), whose keys are distinct by construction.
+ */
+class FftwPlanner {
+private:
+  /**
+   * @brief Private constructor.
+   */
+  FftwPlanner();
+
+public:
+  /**
+   * @brief The shared plan type.
+   * @tparam T The real value type
+   */
+  template <typename T = double>
+  using Plan = std::shared_ptr<std::remove_pointer_t<typename FftwTraits<T>::Plan>>;
+
+  /**
+   * @brief Get the singleton.
+   */
+  static FftwPlanner& instance();
+
+  /**
+   * @brief Get the planner mutex.
+   * @details
+   * Any call to FFTW functions which are not thread-safe (which is all of them except execution functions)
+   * should hold this mutex.
+   */
+  std::mutex& mutex();
+
+  /**
+   * @brief Get the number of alive plans.
+   */
+  long size();
+
+  /**
+   * @brief Get a plan, either from the cache or by planning it.
+   * @param shape The logical plane shape
+   * @param count The number of planes
+   * @param policy The planning policy
+   * @param in The input buffer, which is used for planning
+   * @param out The output buffer, which is used for planning
+   * @details
+   * If the plan has to be created, the input and output buffers may be overwritten,
+   * depending on the policy.
+   * If `PlanStats` is enabled, the planning time and the number of floating point operations are recorded.
+   */
+  template <typename TType>
+  Plan<typename TType::Real> plan(
+      const Fits::Position<2>& shape,
+      long count,
+      const PlanningPolicy& policy,
+      Fits::PtrRaster<typename TType::InValue, 3>& in,
+      Fits::PtrRaster<typename TType::OutValue, 3>& out) {
+    using T = typename TType::Real;
+    const auto key = FftwWisdom::key<TType>(shape, count, policy);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto cached = m_plans[key].lock();
+    if (cached) {
+      return std::static_pointer_cast<typename Plan<T>::element_type>(cached);
+    }
+    auto& wisdom = FftwWisdom::instance();
+    wisdom.load<T>(key);
+    prepare<T>(policy);
+    const auto start = std::chrono::steady_clock::now();
+    auto raw = initFftwPlan<TType>(shape, in, out, policy.flags());
+    if (not raw) {
+      throw std::runtime_error("FFTW cannot create plan: " + key);
+    }
+    if (auto stats = PlanStats::instance().counters(key)) {
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      stats->recordPlanning(elapsed.count(), FftwTraits<T>::flops(raw));
+    }
+    wisdom.record<T>(key);
+    Plan<T> plan(raw, destroy<T>);
+    m_plans[key] = plan;
+    purge();
+    return plan;
+  }
+
+private:
+  /**
+   * @brief Set FFTW's global planning parameters according to a policy.
+   * @warning
+   * The mutex must be held.
+   */
+  template <typename T>
+  void prepare(const PlanningPolicy& policy) {
+    FftwTraits<T>::setTimelimit(policy.timeLimit);
+    auto& globals = FftwGlobalsCleaner::instantiate();
+    if (policy.threads > 1) {
+      globals.initThreads<T>();
+    }
+    if (globals.threads<T>()) {
+      FftwTraits<T>::planWithNthreads(static_cast<int>(policy.threads));
+    }
+  }
+
+  /**
+   * @brief Destroy a plan.
+   */
+  template <typename T>
+  static void destroy(typename FftwTraits<T>::Plan plan) {
+    std::lock_guard<std::mutex> lock(instance().m_mutex);
+    FftwTraits<T>::destroyPlan(plan);
+  }
+
+  /**
+   * @brief Remove the expired plans from the cache.
+   * @warning
+   * The mutex must be held.
+   */
+  void purge();
+
+  /**
+   * @brief The planner mutex.
+   */
+  std::mutex m_mutex;
+
+  /**
+   * @brief The cached plans, type-erased to support all precisions.
+   */
+  std::map<std::string, std::weak_ptr<void>> m_plans;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
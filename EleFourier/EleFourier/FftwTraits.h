@@ -0,0 +1,154 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_FFTWTRAITS_H
+#define _ELEFOURIER_FFTWTRAITS_H
+
+#include <complex>
+#include <cstddef> // size_t
+#include <fftw3.h>
+#include <string>
+#include <utility> // forward
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief The real type of a real or complex value type.
+ */
+template <typename T>
+struct FftwReal {
+  using Type = T;
+};
+
+/**
+ * @copydoc FftwReal
+ */
+template <typename T>
+struct FftwReal<std::complex<T>> {
+  using Type = T;
+};
+
+/**
+ * @brief Precision-dependent FFTW API.
+ * @tparam T The real type, i.e. `float`, `double` or `long double`
+ * @details
+ * FFTW comes as one library per precision, with prefixes `fftwf_`, `fftw_` and `fftwl_`.
+ * This class gives a uniform access to the functions and types of each library, e.g.:
+ * \code
+ * FftwTraits<float>::Plan plan = FftwTraits<float>::planManyDft(...); // Calls fftwf_plan_many_dft()
+ * \endcode
+ */
+template <typename T>
+struct FftwTraits;
+
+#define DEF_FFTW_TRAITS(T, X, index, suffix) \
+  template <> \
+  struct FftwTraits<T> { \
+    using Real = T; \
+    using Complex = X##_complex; \
+    using Plan = X##_plan; \
+    using IoDim = X##_iodim; \
+    static constexpr std::size_t Index = index; \
+    static std::string name() { \
+      return suffix; \
+    } \
+    static void* malloc(std::size_t size) { \
+      return X##_malloc(size); \
+    } \
+    static void free(void* data) { \
+      X##_free(data); \
+    } \
+    static int alignmentOf(Real* data) { \
+      return X##_alignment_of(data); \
+    } \
+    static void cleanup() { \
+      X##_cleanup(); \
+    } \
+    static int initThreads() { \
+      return X##_init_threads(); \
+    } \
+    static void cleanupThreads() { \
+      X##_cleanup_threads(); \
+    } \
+    static void planWithNthreads(int count) { \
+      X##_plan_with_nthreads(count); \
+    } \
+    static void setTimelimit(double seconds) { \
+      X##_set_timelimit(seconds); \
+    } \
+    static int importWisdomFromFilename(const char* filename) { \
+      return X##_import_wisdom_from_filename(filename); \
+    } \
+    static int exportWisdomToFilename(const char* filename) { \
+      return X##_export_wisdom_to_filename(filename); \
+    } \
+    template <typename... Ts> \
+    static Plan planManyDft(Ts&&... args) { \
+      return X##_plan_many_dft(std::forward<Ts>(args)...); \
+    } \
+    template <typename... Ts> \
+    static Plan planManyDftR2c(Ts&&... args) { \
+      return X##_plan_many_dft_r2c(std::forward<Ts>(args)...); \
+    } \
+    template <typename... Ts> \
+    static Plan planManyDftC2r(Ts&&... args) { \
+      return X##_plan_many_dft_c2r(std::forward<Ts>(args)...); \
+    } \
+    template <typename... Ts> \
+    static Plan planGuruDft(Ts&&... args) { \
+      return X##_plan_guru_dft(std::forward<Ts>(args)...); \
+    } \
+    template <typename... Ts> \
+    static Plan planGuruDftR2c(Ts&&... args) { \
+      return X##_plan_guru_dft_r2c(std::forward<Ts>(args)...); \
+    } \
+    template <typename... Ts> \
+    static Plan planGuruDftC2r(Ts&&... args) { \
+      return X##_plan_guru_dft_c2r(std::forward<Ts>(args)...); \
+    } \
+    static void executeDft(const Plan plan, Complex* in, Complex* out) { \
+      X##_execute_dft(plan, in, out); \
+    } \
+    static void executeDftR2c(const Plan plan, Real* in, Complex* out) { \
+      X##_execute_dft_r2c(plan, in, out); \
+    } \
+    static void executeDftC2r(const Plan plan, Complex* in, Real* out) { \
+      X##_execute_dft_c2r(plan, in, out); \
+    } \
+    static double flops(const Plan plan) { \
+      double add = 0, mul = 0, fma = 0; \
+      X##_flops(plan, &add, &mul, &fma); \
+      return add + mul + 2 * fma; \
+    } \
+    static void destroyPlan(Plan plan) { \
+      X##_destroy_plan(plan); \
+    } \
+  };
+
+DEF_FFTW_TRAITS(float, fftwf, 0, "F")
+DEF_FFTW_TRAITS(double, fftw, 1, "")
+DEF_FFTW_TRAITS(long double, fftwl, 2, "L")
+
+#undef DEF_FFTW_TRAITS
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_FFTWWISDOM_H
+#define _ELEFOURIER_FFTWWISDOM_H
+
+#include "EleFitsData/Raster.h"
+#include "EleFourier/FftwTraits.h"
+#include "EleFourier/PlanningPolicy.h"
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Process-wide registry of FFTW wisdom files.
+ * @details
+ * At planning time, FFTW accumulates some knowledge (the so-called wisdom) in global variables,
+ * which can be exported to and imported from files in order to skip measurements in later runs.
+ * Wisdom files are keyed by transform type, logical shape, count and planning policy,
+ * and stored in a host-specific subdirectory, because measurements depend on the hardware.
+ *
+ * When the registry is enabled, `DftPlan` checks it before planning:
+ * - If the wisdom file of the plan key exists, it is imported once for all, such that planning is almost free;
+ * - Otherwise, the key is marked as new, and the wisdom is exported to the corresponding file
+ *   at `save()` or at program ending (if autosave is on).
+ *
+ * The registry is disabled by default:
+ * \code
+ * FftwWisdom::instance().enable("/path/to/wisdom");
+ * RealDft dft(shape); // Imports /path/to/wisdom/<host>/RealDft_<width>x<height>x1_Measure.wisdom if it exists
+ * \endcode
+ *
+ * As FFTW keeps separate wisdom for each precision, import and export are parametrized by the real type,
+ * and the keys of single and long double precision plans are suffixed accordingly (see `FftwTraits::name()`).
+ */
+class FftwWisdom {
+private:
+  /**
+   * @brief Private constructor.
+   */
+  FftwWisdom();
+
+public:
+  /**
+   * @brief Destructor.
+   * @details
+   * Exports the new wisdom if autosave is on.
+   */
+  ~FftwWisdom();
+
+  /**
+   * @brief Get the singleton.
+   */
+  static FftwWisdom& instance();
+
+  /**
+   * @brief Get the name of the host, as used to name the wisdom subdirectory.
+   */
+  static std::string hostname();
+
+  /**
+   * @brief Enable the registry.
+   * @param directory The root directory of the wisdom files, which is created if needed
+   * @param autosave Save the new wisdom at destruction
+   */
+  void enable(const std::string& directory, bool autosave = true);
+
+  /**
+   * @brief Disable the registry.
+   * @details
+   * The new wisdom is not saved.
+   */
+  void disable();
+
+  /**
+   * @brief Check whether the registry is enabled.
+   */
+  bool enabled() const;
+
+  /**
+   * @brief Get the root directory of the wisdom files.
+   */
+  std::string directory() const;
+
+  /**
+   * @brief Compute the key of a plan.
+   * @param type The transform type name
+   * @param shape The logical plane shape
+   * @param count The number of planes
+   * @param policy The planning policy
+   */
+  static std::string
+  key(const std::string& type, const Fits::Position<2>& shape, long count, const PlanningPolicy& policy = {});
+
+  /**
+   * @brief Compute the key of a plan from its type.
+   */
+  template <typename TType>
+  static std::string key(const Fits::Position<2>& shape, long count, const PlanningPolicy& policy = {}) {
+    return key(TType::name(), shape, count, policy);
+  }
+
+  /**
+   * @brief Get the wisdom file name associated to a key.
+   */
+  std::string filename(const std::string& key) const;
+
+  /**
+   * @brief Import the wisdom associated to a key, if not already done.
+   * @tparam T The real value type of the plan
+   * @return True if the wisdom of the key is available, i.e. was imported now or before.
+   * @details
+   * Does nothing and returns false if the registry is disabled.
+   * @warning
+   * As FFTW's wisdom import is not thread-safe, the mutex of `FftwPlanner` must be held,
+   * which is the case when the function is called by the planner itself.
+   */
+  template <typename T = double>
+  bool load(const std::string& key) {
+    return load(key, &FftwTraits<T>::importWisdomFromFilename);
+  }
+
+  /**
+   * @brief Declare that a plan has been created for a key.
+   * @tparam T The real value type of the plan
+   * @details
+   * If the wisdom of the key was not available, it will be exported at next `save()`.
+   * Does nothing if the registry is disabled.
+   */
+  template <typename T = double>
+  void record(const std::string& key) {
+    record(key, &FftwTraits<T>::exportWisdomToFilename);
+  }
+
+  /**
+   * @brief Export the new wisdom.
+   * @return The number of written files.
+   * @details
+   * The whole wisdom accumulated by FFTW in the precision of each new key is written to the file of the key.
+   */
+  long save();
+
+private:
+  /**
+   * @brief FFTW's wisdom import or export function.
+   */
+  using WisdomIo = int (*)(const char*);
+
+  /**
+   * @brief Import the wisdom associated to a key with a given function.
+   */
+  bool load(const std::string& key, WisdomIo importer);
+
+  /**
+   * @brief Record a key with its export function.
+   */
+  void record(const std::string& key, WisdomIo exporter);
+
+  /**
+   * @brief The registry mutex.
+   */
+  mutable std::mutex m_mutex;
+
+  /**
+   * @brief The root directory, or an empty string if disabled.
+   */
+  std::string m_directory;
+
+  /**
+   * @brief The autosave flag.
+   */
+  bool m_autosave;
+
+  /**
+   * @brief The keys of the imported wisdom.
+   */
+  std::set<std::string> m_loaded;
+
+  /**
+   * @brief The keys of the new wisdom, with their export functions.
+   */
+  std::map<std::string, WisdomIo> m_new;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
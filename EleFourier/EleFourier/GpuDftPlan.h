@@ -0,0 +1,614 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_GPUDFTPLAN_H
+#define _ELEFOURIER_GPUDFTPLAN_H
+
+#include "EleFourier/DftType.h"
+#include "EleFourier/GpuKernels.h"
+#include "EleFourier/Kernels.h"
+
+#include <complex>
+#include <cuda_runtime.h>
+#include <cufft.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility> // exchange
+
+/**
+ * @file
+ * @brief cuFFT backend, available when the project is configured with `-DELEFOURIER_CUFFT=ON`.
+ */
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Throw a `std::runtime_error` if a CUDA runtime call failed.
+ */
+inline void checkCuda(cudaError_t status, const std::string& call) {
+  if (status != cudaSuccess) {
+    throw std::runtime_error(call + " failed: " + cudaGetErrorString(status));
+  }
+}
+
+/**
+ * @brief Throw a `std::runtime_error` if a cuFFT call failed.
+ */
+inline void checkCufft(cufftResult status, const std::string& call) {
+  if (status != CUFFT_SUCCESS) {
+    throw std::runtime_error(call + " failed with cuFFT error " + std::to_string(status));
+  }
+}
+
+/**
+ * @brief Owning buffer in device memory, with explicit host transfers.
+ */
+template <typename T>
+class DeviceBuffer {
+
+public:
+  /**
+   * @brief Allocate a buffer of given number of values, uninitialized.
+   */
+  explicit DeviceBuffer(long size) : m_data(nullptr), m_size(size) {
+    void* data = nullptr;
+    checkCuda(cudaMalloc(&data, sizeof(T) * size), "cudaMalloc");
+    m_data = static_cast<T*>(data);
+  }
+
+  /**
+   * @brief Non-copyable.
+   */
+  DeviceBuffer(const DeviceBuffer&) = delete;
+
+  /**
+   * @brief Move constructor.
+   */
+  DeviceBuffer(DeviceBuffer&& other) : m_data(std::exchange(other.m_data, nullptr)), m_size(other.m_size) {}
+
+  /**
+   * @brief Non-copyable.
+   */
+  DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+
+  /**
+   * @brief Move assignment.
+   */
+  DeviceBuffer& operator=(DeviceBuffer&& other) {
+    if (this != &other) {
+      cudaFree(m_data);
+      m_data = std::exchange(other.m_data, nullptr);
+      m_size = other.m_size;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Destructor.
+   */
+  ~DeviceBuffer() {
+    cudaFree(m_data);
+  }
+
+  /**
+   * @brief Get the number of values.
+   */
+  long size() const {
+    return m_size;
+  }
+
+  /**
+   * @brief Get the device pointer.
+   */
+  const T* data() const {
+    return m_data;
+  }
+
+  /**
+   * @copydoc data()
+   */
+  T* data() {
+    return m_data;
+  }
+
+  /**
+   * @brief Set all the bytes to 0.
+   */
+  void zero() {
+    checkCuda(cudaMemset(m_data, 0, sizeof(T) * m_size), "cudaMemset");
+  }
+
+  /**
+   * @brief Copy host values to the buffer.
+   * @param host The host values
+   * @param size The number of values
+   * @param offset The index of the first written value in the buffer
+   */
+  void upload(const T* host, long size, long offset = 0) {
+    checkRange(size, offset);
+    checkCuda(cudaMemcpy(m_data + offset, host, sizeof(T) * size, cudaMemcpyHostToDevice), "cudaMemcpy");
+  }
+
+  /**
+   * @brief Copy buffer values to the host, synchronously.
+   * @param host The host values
+   * @param size The number of values
+   * @param offset The index of the first read value in the buffer
+   */
+  void download(T* host, long size, long offset = 0) const {
+    checkRange(size, offset);
+    checkCuda(cudaMemcpy(host, m_data + offset, sizeof(T) * size, cudaMemcpyDeviceToHost), "cudaMemcpy");
+  }
+
+private:
+  /**
+   * @brief Check that a range of values lies in the buffer.
+   */
+  void checkRange(long size, long offset) const {
+    if (size < 0 || offset < 0 || offset + size > m_size) {
+      throw std::invalid_argument(
+          "Range [" + std::to_string(offset) + ", " + std::to_string(offset + size) + ") exceeds device buffer size " +
+          std::to_string(m_size));
+    }
+  }
+
+  /**
+   * @brief The device pointer.
+   */
+  T* m_data;
+
+  /**
+   * @brief The number of values.
+   */
+  long m_size;
+};
+
+namespace Gpu {
+
+/**
+ * @brief The cuFFT direction of a DFT type, only defined for the supported types.
+ */
+template <typename TType>
+struct CufftDirection;
+
+template <typename T>
+struct CufftDirection<BasicRealDftType<T>> {
+  static constexpr int value = CUFFT_FORWARD;
+};
+
+template <typename T>
+struct CufftDirection<BasicComplexDftType<T>> {
+  static constexpr int value = CUFFT_FORWARD;
+};
+
+template <typename T>
+struct CufftDirection<Inverse<BasicRealDftType<T>>> {
+  static constexpr int value = CUFFT_INVERSE;
+};
+
+template <typename T>
+struct CufftDirection<Inverse<BasicComplexDftType<T>>> {
+  static constexpr int value = CUFFT_INVERSE;
+};
+
+inline cufftType cufftTypeOf(const float*, const std::complex<float>*) {
+  return CUFFT_R2C;
+}
+
+inline cufftType cufftTypeOf(const double*, const std::complex<double>*) {
+  return CUFFT_D2Z;
+}
+
+inline cufftType cufftTypeOf(const std::complex<float>*, const float*) {
+  return CUFFT_C2R;
+}
+
+inline cufftType cufftTypeOf(const std::complex<double>*, const double*) {
+  return CUFFT_Z2D;
+}
+
+inline cufftType cufftTypeOf(const std::complex<float>*, const std::complex<float>*) {
+  return CUFFT_C2C;
+}
+
+inline cufftType cufftTypeOf(const std::complex<double>*, const std::complex<double>*) {
+  return CUFFT_Z2Z;
+}
+
+inline cufftResult cufftExec(cufftHandle plan, float* in, std::complex<float>* out, int) {
+  return cufftExecR2C(plan, in, reinterpret_cast<cufftComplex*>(out));
+}
+
+inline cufftResult cufftExec(cufftHandle plan, double* in, std::complex<double>* out, int) {
+  return cufftExecD2Z(plan, in, reinterpret_cast<cufftDoubleComplex*>(out));
+}
+
+inline cufftResult cufftExec(cufftHandle plan, std::complex<float>* in, float* out, int) {
+  return cufftExecC2R(plan, reinterpret_cast<cufftComplex*>(in), out);
+}
+
+inline cufftResult cufftExec(cufftHandle plan, std::complex<double>* in, double* out, int) {
+  return cufftExecZ2D(plan, reinterpret_cast<cufftDoubleComplex*>(in), out);
+}
+
+inline cufftResult cufftExec(cufftHandle plan, std::complex<float>* in, std::complex<float>* out, int direction) {
+  return cufftExecC2C(plan, reinterpret_cast<cufftComplex*>(in), reinterpret_cast<cufftComplex*>(out), direction);
+}
+
+inline cufftResult cufftExec(cufftHandle plan, std::complex<double>* in, std::complex<double>* out, int direction) {
+  return cufftExecZ2Z(
+      plan,
+      reinterpret_cast<cufftDoubleComplex*>(in),
+      reinterpret_cast<cufftDoubleComplex*>(out),
+      direction);
+}
+
+} // namespace Gpu
+
+/**
+ * @brief DFT plan executed by cuFFT, with buffers in device memory.
+ * @tparam TType The DFT type, i.e. a `BasicRealDftType`, a `BasicComplexDftType`, or their inverses,
+ *         in single or double precision
+ * @details
+ * This is the device counterpart of `DftPlan`, on the same DFT types, shapes and scaling conventions,
+ * and with the same life cycle: the plan owns an input and an output buffer,
+ * `inverse()` creates the inverse plan over the same buffers, and `transform()` executes the transform.
+ * Unlike `DftPlan`, the buffers are `DeviceBuffer`s, which are not directly accessible from the host:
+ * data are copied explicitly with `upload()` and `download()`,
+ * and otherwise stay on the device from one stage to the next.
+ * Transforms are out of place, and scaling is eager.
+ *
+ * Device kernels, launched on the default stream like the transforms, provide the stages of the PSF pipelines,
+ * such that a whole broadband loop runs on the device, with a single download per parameter:
+ * \code
+ * GpuComplexDft pupilToPsf({side, side});
+ * GpuRealDft psfToMtf({side, side});
+ * auto mtfToBroadband = psfToMtf.inverse();
+ * GpuPupilPhase gpuPhase(phase); // Uploads the support and the OPD of a PupilPhase
+ * DeviceBuffer<std::complex<double>> mtfSum(psfToMtf.outDevice().size());
+ * mtfSum.zero();
+ * for (auto lambda : lambdas) {
+ *   gpuPhase.evalAmplitude(lambda, pupilToPsf);
+ *   pupilToPsf.transform().pipe(psfToMtf, Norm2());
+ *   psfToMtf.transform().addTo(mtfSum);
+ * }
+ * mtfToBroadband.loadDevice(mtfSum).transform().normalize().download(broadband);
+ * \endcode
+ *
+ * As FFTW's Hermitian conventions are not those of cuFFT, Hermitian, axis and stack types are not supported.
+ */
+template <typename TType>
+class GpuDftPlan {
+
+  template <typename>
+  friend class GpuDftPlan;
+
+public:
+  /**
+   * @brief The plan type.
+   */
+  using Type = TType;
+
+  /**
+   * @brief The inverse plan.
+   */
+  using Inverse = GpuDftPlan<typename Type::InverseType>;
+
+  /**
+   * @brief The signal value type.
+   */
+  using InValue = typename Type::InValue;
+
+  /**
+   * @brief The Fourier coefficient type.
+   */
+  using OutValue = typename Type::OutValue;
+
+  /**
+   * @brief The real value type, which sets the precision.
+   */
+  using Real = typename Type::Real;
+
+  /**
+   * @brief Constructor.
+   * @param shape The logical plane shape
+   * @param count The number of planes
+   */
+  explicit GpuDftPlan(const Fits::Position<2>& shape, long count = 1) :
+      GpuDftPlan(
+          shape,
+          count,
+          std::make_shared<DeviceBuffer<InValue>>(shapeSize(Type::inShape(shape)) * count),
+          std::make_shared<DeviceBuffer<OutValue>>(shapeSize(Type::outShape(shape)) * count)) {}
+
+  /**
+   * @brief Non-copyable.
+   */
+  GpuDftPlan(const GpuDftPlan&) = delete;
+
+  /**
+   * @brief Movable.
+   */
+  GpuDftPlan(GpuDftPlan&&) = default;
+
+  /**
+   * @brief Non-copyable.
+   */
+  GpuDftPlan& operator=(const GpuDftPlan&) = delete;
+
+  /**
+   * @brief Movable.
+   */
+  GpuDftPlan& operator=(GpuDftPlan&&) = default;
+
+  /**
+   * @brief Create the inverse plan with shared buffers.
+   * @details
+   * The buffers are shared, such that they live as long as any of the plans.
+   */
+  Inverse inverse() {
+    return Inverse(m_shape, m_count, m_out, m_in);
+  }
+
+  /**
+   * @brief Get the number of planes.
+   */
+  long count() const {
+    return m_count;
+  }
+
+  /**
+   * @brief Get the logical plane shape.
+   */
+  const Fits::Position<2>& logicalShape() const {
+    return m_shape;
+  }
+
+  /**
+   * @brief Get the input plane shape.
+   */
+  Fits::Position<2> inShape() const {
+    return Type::inShape(m_shape);
+  }
+
+  /**
+   * @brief Get the output plane shape.
+   */
+  Fits::Position<2> outShape() const {
+    return Type::outShape(m_shape);
+  }
+
+  /**
+   * @brief Access the input buffer.
+   */
+  DeviceBuffer<InValue>& inDevice() {
+    return *m_in;
+  }
+
+  /**
+   * @brief Access the output buffer.
+   */
+  DeviceBuffer<OutValue>& outDevice() {
+    return *m_out;
+  }
+
+  /**
+   * @brief Get the normalization factor.
+   */
+  double normalizationFactor() const {
+    return Type::normalizationFactor(m_shape, m_count);
+  }
+
+  /**
+   * @brief Copy a host raster or stack to the first planes of the input buffer.
+   * @param in The contiguous raster or stack, of the input plane shape, with at most `count()` planes
+   */
+  template <typename TRaster>
+  GpuDftPlan& upload(const TRaster& in) {
+    m_in->upload(in.data(), checkPlanes(in, inShape()).size());
+    return *this;
+  }
+
+  /**
+   * @brief Copy a device buffer to the input buffer.
+   * @param in The device buffer, of at most the size of the input buffer
+   */
+  GpuDftPlan& loadDevice(const DeviceBuffer<InValue>& in) {
+    if (in.size() > m_in->size()) {
+      throw std::invalid_argument("Device buffer is larger than the input buffer");
+    }
+    checkCuda(
+        cudaMemcpy(m_in->data(), in.data(), sizeof(InValue) * in.size(), cudaMemcpyDeviceToDevice),
+        "cudaMemcpy");
+    return *this;
+  }
+
+  /**
+   * @brief Execute the transform.
+   * @details
+   * As for `DftPlan`, the input buffer may be overwritten (e.g. by inverse real transforms).
+   * The execution is asynchronous with respect to the host; `download()` synchronizes.
+   */
+  GpuDftPlan& transform() {
+    checkCufft(
+        Gpu::cufftExec(*m_plan, m_in->data(), m_out->data(), Gpu::CufftDirection<Type>::value),
+        "cufftExec");
+    return *this;
+  }
+
+  /**
+   * @brief Multiply the output buffer by a factor.
+   */
+  GpuDftPlan& scale(Real factor) {
+    Gpu::scale(reinterpret_cast<Real*>(m_out->data()), m_out->size() * sizeof(OutValue) / sizeof(Real), factor);
+    return *this;
+  }
+
+  /**
+   * @brief Divide the output buffer by the normalization factor.
+   */
+  GpuDftPlan& normalize() {
+    return scale(Real(1) / static_cast<Real>(normalizationFactor()));
+  }
+
+  /**
+   * @brief Write the squared modulus of the output buffer into the input buffer of another plan.
+   * @param next The plan to be fed, whose input buffer has the size of this plan's output buffer
+   * @details
+   * As opposed to `DftPlan::pipe()`, the function cannot be arbitrary, and only `Norm2` is supported.
+   */
+  template <typename TPlanType>
+  GpuDftPlan& pipe(GpuDftPlan<TPlanType>& next, Norm2) {
+    if (next.m_in->size() != m_out->size()) {
+      throw std::invalid_argument("Piped plan input size does not match output size");
+    }
+    Gpu::norm2(m_out->data(), next.m_in->data(), m_out->size(), Real(1));
+    return *this;
+  }
+
+  /**
+   * @brief Add the output buffer to a device accumulator of the same size.
+   */
+  GpuDftPlan& addTo(DeviceBuffer<OutValue>& acc) {
+    if (acc.size() != m_out->size()) {
+      throw std::invalid_argument("Accumulator size does not match output size");
+    }
+    Gpu::accumulate(
+        reinterpret_cast<const Real*>(m_out->data()),
+        reinterpret_cast<Real*>(acc.data()),
+        m_out->size() * sizeof(OutValue) / sizeof(Real));
+    return *this;
+  }
+
+  /**
+   * @brief Copy the first planes of the output buffer to a host raster or stack, synchronously.
+   * @param out The contiguous raster or stack, of the output plane shape, with at most `count()` planes
+   */
+  template <typename TRaster>
+  const GpuDftPlan& download(TRaster&& out) const {
+    m_out->download(out.data(), checkPlanes(out, outShape()).size());
+    return *this;
+  }
+
+private:
+  /**
+   * @brief Constructor over existing buffers.
+   */
+  GpuDftPlan(
+      const Fits::Position<2>& shape,
+      long count,
+      std::shared_ptr<DeviceBuffer<InValue>> in,
+      std::shared_ptr<DeviceBuffer<OutValue>> out) :
+      m_shape(shape),
+      m_count(count), m_in(std::move(in)), m_out(std::move(out)), m_plan(createPlan(shape, count)) {}
+
+  /**
+   * @brief Create a cuFFT plan.
+   */
+  static std::shared_ptr<cufftHandle> createPlan(const Fits::Position<2>& shape, long count) {
+    int n[] = {static_cast<int>(shape[1]), static_cast<int>(shape[0])}; // Slowest axis first
+    const auto type = Gpu::cufftTypeOf(static_cast<InValue*>(nullptr), static_cast<OutValue*>(nullptr));
+    std::shared_ptr<cufftHandle> plan(new cufftHandle(0), [](cufftHandle* p) {
+      cufftDestroy(*p);
+      delete p;
+    });
+    checkCufft(
+        cufftPlanMany(plan.get(), 2, n, nullptr, 1, 0, nullptr, 1, 0, type, static_cast<int>(count)),
+        "cufftPlanMany");
+    return plan;
+  }
+
+  /**
+   * @brief Check that a host raster or stack has the plane shape and at most `count()` planes.
+   */
+  template <typename TRaster>
+  const TRaster& checkPlanes(const TRaster& raster, const Fits::Position<2>& shape) const {
+    if (raster.shape()[0] != shape[0] || raster.shape()[1] != shape[1] ||
+        planeCount(raster, shapeSize(shape)) > m_count) {
+      throw std::invalid_argument(
+          "Host raster shape " + std::to_string(raster.shape()[0]) + "x" + std::to_string(raster.shape()[1]) +
+          " does not match plane shape " + std::to_string(shape[0]) + "x" + std::to_string(shape[1]));
+    }
+    return raster;
+  }
+
+  /**
+   * @brief The logical plane shape.
+   */
+  Fits::Position<2> m_shape;
+
+  /**
+   * @brief The number of planes.
+   */
+  long m_count;
+
+  /**
+   * @brief The input buffer.
+   */
+  std::shared_ptr<DeviceBuffer<InValue>> m_in;
+
+  /**
+   * @brief The output buffer.
+   */
+  std::shared_ptr<DeviceBuffer<OutValue>> m_out;
+
+  /**
+   * @brief The cuFFT plan.
+   */
+  std::shared_ptr<cufftHandle> m_plan;
+};
+
+/**
+ * @brief Real DFT executed by cuFFT.
+ */
+template <typename T>
+using BasicGpuRealDft = GpuDftPlan<BasicRealDftType<T>>;
+
+/**
+ * @brief Complex DFT executed by cuFFT.
+ */
+template <typename T>
+using BasicGpuComplexDft = GpuDftPlan<BasicComplexDftType<T>>;
+
+/**
+ * @brief Double precision real DFT executed by cuFFT.
+ */
+using GpuRealDft = BasicGpuRealDft<double>;
+
+/**
+ * @brief Double precision complex DFT executed by cuFFT.
+ */
+using GpuComplexDft = BasicGpuComplexDft<double>;
+
+/**
+ * @brief Single precision real DFT executed by cuFFT.
+ */
+using GpuRealDftF = BasicGpuRealDft<float>;
+
+/**
+ * @brief Single precision complex DFT executed by cuFFT.
+ */
+using GpuComplexDftF = BasicGpuComplexDft<float>;
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
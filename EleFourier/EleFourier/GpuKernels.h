@@ -0,0 +1,100 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_GPUKERNELS_H
+#define _ELEFOURIER_GPUKERNELS_H
+
+#include <complex>
+
+/**
+ * @file
+ * @brief Pointwise kernels over device memory, for the cuFFT backend (see `GpuDftPlan`).
+ * @details
+ * The kernels are compiled by `nvcc` in `src/gpu/GpuKernels.cu`, and this header only declares the host launchers,
+ * such that it can be included by regular C++ code.
+ * All the pointers are device pointers, and the kernels are launched asynchronously on the default stream,
+ * which orders them with respect to the cuFFT executions and the memory copies of the backend.
+ * Launch failures (e.g. invalid configurations) throw a `std::runtime_error`;
+ * execution errors are reported by the next synchronizing call.
+ * Complex values are laid out like `cufftComplex` and `cufftDoubleComplex`.
+ */
+
+namespace Euclid {
+namespace Fourier {
+namespace Gpu {
+
+/**
+ * @brief Multiply `size` values by a factor.
+ */
+void scale(float* data, long size, float factor);
+
+/**
+ * @copydoc scale()
+ */
+void scale(double* data, long size, double factor);
+
+/**
+ * @brief Add `size` values to an accumulator: `acc[i] += data[i]`.
+ */
+void accumulate(const float* data, float* acc, long size);
+
+/**
+ * @copydoc accumulate()
+ */
+void accumulate(const double* data, double* acc, long size);
+
+/**
+ * @brief Compute the scaled squared modulus of `size` values: `out[i] = norm(in[i] * factor)`.
+ */
+void norm2(const std::complex<float>* in, float* out, long size, float factor);
+
+/**
+ * @copydoc norm2()
+ */
+void norm2(const std::complex<double>* in, double* out, long size, double factor);
+
+/**
+ * @brief Compute a pupil amplitude over its support: `plane[indices[i]] = mask[i] * exp(i * factor * opd[i])`.
+ * @details
+ * The plane is not zeroed outside the support.
+ */
+void pupilAmplitude(
+    const long* indices,
+    const double* mask,
+    const double* opd,
+    long support,
+    double factor,
+    std::complex<float>* plane);
+
+/**
+ * @copydoc pupilAmplitude()
+ */
+void pupilAmplitude(
+    const long* indices,
+    const double* mask,
+    const double* opd,
+    long support,
+    double factor,
+    std::complex<double>* plane);
+
+} // namespace Gpu
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_GPUPUPILPHASE_H
+#define _ELEFOURIER_GPUPUPILPHASE_H
+
+#include "EleFourier/GpuDftPlan.h"
+#include "EleFourier/PupilPhase.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Device counterpart of `PupilPhase`, which computes pupil amplitudes into the input buffer of a `GpuDftPlan`.
+ * @details
+ * The support indices and the mask values are uploaded once at construction,
+ * and the OPD each time it changes (see `uploadOpd()`), e.g. once per set of Zernike coefficients,
+ * while the amplitudes are computed on the device for each wavelength.
+ */
+class GpuPupilPhase {
+
+public:
+  /**
+   * @brief Constructor.
+   * @param phase The host engine, whose OPD is uploaded
+   */
+  explicit GpuPupilPhase(const PupilPhase& phase) :
+      m_shape(phase.pupil().shape()), m_indices(phase.pupil().size()), m_mask(phase.pupil().size()),
+      m_opd(phase.pupil().size()) {
+    const auto& pupil = phase.pupil();
+    std::vector<long> indices(pupil.size());
+    for (const auto& span : pupil.spans()) {
+      for (long i = 0; i < span.size; ++i) {
+        indices[span.offset + i] = span.x + i + span.y * m_shape[0];
+      }
+    }
+    m_indices.upload(indices.data(), indices.size());
+    m_mask.upload(pupil.values().data(), pupil.size());
+    uploadOpd(phase);
+  }
+
+  /**
+   * @brief Upload the last OPD computed by the host engine (see `PupilPhase::evalOpd()`).
+   */
+  void uploadOpd(const PupilPhase& phase) {
+    m_opd.upload(phase.opd().data(), m_opd.size());
+  }
+
+  /**
+   * @brief Compute the amplitude at a given wavelength into a plane of the input buffer of a complex plan.
+   * @param lambda The wavelength, in the unit of the OPD
+   * @param plan The plan, of the pupil shape
+   * @param index The plane index
+   */
+  template <typename T>
+  void evalAmplitude(double lambda, BasicGpuComplexDft<T>& plan, long index = 0) const {
+    const auto& shape = plan.logicalShape();
+    if (shape[0] != m_shape[0] || shape[1] != m_shape[1] || index < 0 || index >= plan.count()) {
+      throw std::invalid_argument(
+          "Plan shape " + std::to_string(shape[0]) + "x" + std::to_string(shape[1]) + " does not match pupil shape " +
+          std::to_string(m_shape[0]) + "x" + std::to_string(m_shape[1]));
+    }
+    const long size = m_shape[0] * m_shape[1];
+    auto* plane = plan.inDevice().data() + index * size;
+    checkCuda(cudaMemset(plane, 0, sizeof(*plane) * size), "cudaMemset");
+    const double factor = -2 * 3.14159265358979323846 / lambda;
+    Gpu::pupilAmplitude(m_indices.data(), m_mask.data(), m_opd.data(), m_opd.size(), factor, plane);
+  }
+
+private:
+  /**
+   * @brief The pupil shape.
+   */
+  Fits::Position<2> m_shape;
+
+  /**
+   * @brief The plane indices of the support.
+   */
+  DeviceBuffer<long> m_indices;
+
+  /**
+   * @brief The mask values over the support.
+   */
+  DeviceBuffer<double> m_mask;
+
+  /**
+   * @brief The OPD over the support.
+   */
+  DeviceBuffer<double> m_opd;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
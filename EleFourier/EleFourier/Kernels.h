@@ -0,0 +1,386 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_KERNELS_H
+#define _ELEFOURIER_KERNELS_H
+
+#include "EleFourier/FftwTraits.h"
+
+#include <complex>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @file
+ * @brief Element-wise kernels on DFT buffers.
+ * @details
+ * The kernels come in two flavors:
+ * - `...Data()` functions work on contiguous arrays and are vectorized (`omp simd`),
+ *   complex values being processed as interleaved real and imaginary parts;
+ * - Raster functions apply the former to each plane (`shape()[0] * shape()[1]` values) of a raster or stack,
+ *   in parallel across planes (`omp parallel for`).
+ *
+ * Scaling always multiplies by a factor, such that division (e.g. for normalization)
+ * should be performed once by the caller as a reciprocal.
+ * Fused kernels, e.g. `multiplyScale()`, save a full memory pass compared to successive calls.
+ *
+ * \code
+ * RealDft dft(shape, count);
+ * auto inverse = dft.inverse();
+ * dft.transform();
+ * auto coefficients = dft.outStack();
+ * multiplyScale(coefficients, filter, 1. / dft.normalizationFactor()); // Convolve and normalize in one pass
+ * inverse.transform(); // No need to normalize
+ * \endcode
+ *
+ * `DftPlan` provides member counterparts (e.g. `DftPlan::multiply()`) which also apply its pending scale factor.
+ */
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Multiply real values by a factor.
+ */
+template <typename T>
+void scaleData(T* data, long size, typename FftwReal<T>::Type factor) {
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    data[i] *= factor;
+  }
+}
+
+/**
+ * @brief Multiply complex values by a real factor.
+ */
+template <typename T>
+void scaleData(std::complex<T>* data, long size, typename FftwReal<T>::Type factor) {
+  scaleData(reinterpret_cast<T*>(data), 2 * size, factor);
+}
+
+/**
+ * @brief Multiply complex values by real filter values and a real factor.
+ */
+template <typename T>
+void multiplyScaleData(std::complex<T>* data, const T* filter, long size, typename FftwReal<T>::Type factor) {
+  T* d = reinterpret_cast<T*>(data);
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    const T f = filter[i] * factor;
+    d[2 * i] *= f;
+    d[2 * i + 1] *= f;
+  }
+}
+
+/**
+ * @brief Multiply complex values by complex filter values and a real factor.
+ */
+template <typename T>
+void multiplyScaleData(
+    std::complex<T>* data,
+    const std::complex<T>* filter,
+    long size,
+    typename FftwReal<T>::Type factor) {
+  T* d = reinterpret_cast<T*>(data);
+  const T* f = reinterpret_cast<const T*>(filter);
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    const T re = d[2 * i] * f[2 * i] - d[2 * i + 1] * f[2 * i + 1];
+    const T im = d[2 * i] * f[2 * i + 1] + d[2 * i + 1] * f[2 * i];
+    d[2 * i] = re * factor;
+    d[2 * i + 1] = im * factor;
+  }
+}
+
+/**
+ * @brief Multiply real values by real filter values and a real factor.
+ */
+template <typename T>
+void multiplyScaleData(T* data, const T* filter, long size, typename FftwReal<T>::Type factor) {
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    data[i] *= filter[i] * factor;
+  }
+}
+
+/**
+ * @brief Multiply real values by real filter values.
+ */
+template <typename T>
+void multiplyData(T* data, const T* filter, long size) {
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    data[i] *= filter[i];
+  }
+}
+
+/**
+ * @brief Multiply complex values by real filter values.
+ */
+template <typename T>
+void multiplyData(std::complex<T>* data, const T* filter, long size) {
+  T* d = reinterpret_cast<T*>(data);
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    d[2 * i] *= filter[i];
+    d[2 * i + 1] *= filter[i];
+  }
+}
+
+/**
+ * @brief Multiply complex values by complex filter values.
+ */
+template <typename T>
+void multiplyData(std::complex<T>* data, const std::complex<T>* filter, long size) {
+  T* d = reinterpret_cast<T*>(data);
+  const T* f = reinterpret_cast<const T*>(filter);
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    const T re = d[2 * i] * f[2 * i] - d[2 * i + 1] * f[2 * i + 1];
+    const T im = d[2 * i] * f[2 * i + 1] + d[2 * i + 1] * f[2 * i];
+    d[2 * i] = re;
+    d[2 * i + 1] = im;
+  }
+}
+
+/**
+ * @brief Conjugate complex values in place.
+ */
+template <typename T>
+void conjugateData(std::complex<T>* data, long size) {
+  T* d = reinterpret_cast<T*>(data);
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    d[2 * i + 1] = -d[2 * i + 1];
+  }
+}
+
+/**
+ * @brief Compute the squared modulus of complex values, i.e. `out = |in|^2`.
+ * @details
+ * This is typically the intensity of an amplitude.
+ */
+template <typename T>
+void norm2Data(const std::complex<T>* in, T* out, long size) {
+  const T* d = reinterpret_cast<const T*>(in);
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    out[i] = d[2 * i] * d[2 * i] + d[2 * i + 1] * d[2 * i + 1];
+  }
+}
+
+/**
+ * @brief Squared modulus function object, e.g. for `DftPlan::pipe()`.
+ * @details
+ * Unlike `std::norm()`, it does not check for infinite values, and can therefore be vectorized.
+ */
+struct Norm2 {
+
+  /** @brief Compute the squared modulus. */
+  template <typename T>
+  T operator()(const std::complex<T>& value) const {
+    return value.real() * value.real() + value.imag() * value.imag();
+  }
+};
+
+/**
+ * @brief Compute the squared modulus of a Hermitian half plane into the full real plane.
+ * @param in The half plane, of shape `(width / 2 + 1, height)`, e.g. the output of a real DFT
+ * @param out The full plane, of shape `(width, height)`
+ * @details
+ * As `|in(-x, -y)|^2 = |in(x, y)|^2`, the squared modulus is only computed over the half plane,
+ * and mirrored into the other half.
+ * This is typically the intensity of the amplitude of a real pupil, which is real and even.
+ */
+template <typename T>
+void norm2HermitianData(const std::complex<T>* in, T* out, long width, long height) {
+  const long half = width / 2 + 1;
+  for (long y = 0; y < height; ++y) {
+    norm2Data(in + y * half, out + y * width, half);
+  }
+  for (long y = 0; y < height; ++y) {
+    T* row = out + y * width;
+    const T* mirror = out + ((height - y) % height) * width;
+    for (long x = half; x < width; ++x) {
+      row[x] = mirror[width - x];
+    }
+  }
+}
+
+/**
+ * @brief Complex multiply-accumulate, i.e. `acc += in * filter`.
+ */
+template <typename T>
+void multiplyAccumulateData(std::complex<T>* acc, const std::complex<T>* in, const std::complex<T>* filter, long size) {
+  T* a = reinterpret_cast<T*>(acc);
+  const T* d = reinterpret_cast<const T*>(in);
+  const T* f = reinterpret_cast<const T*>(filter);
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    a[2 * i] += d[2 * i] * f[2 * i] - d[2 * i + 1] * f[2 * i + 1];
+    a[2 * i + 1] += d[2 * i] * f[2 * i + 1] + d[2 * i + 1] * f[2 * i];
+  }
+}
+
+/**
+ * @brief Real-filter multiply-accumulate, i.e. `acc += in * filter`.
+ */
+template <typename T>
+void multiplyAccumulateData(std::complex<T>* acc, const std::complex<T>* in, const T* filter, long size) {
+  T* a = reinterpret_cast<T*>(acc);
+  const T* d = reinterpret_cast<const T*>(in);
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    a[2 * i] += d[2 * i] * filter[i];
+    a[2 * i + 1] += d[2 * i + 1] * filter[i];
+  }
+}
+
+/**
+ * @brief Complex scalar multiply-accumulate, i.e. `acc += factor * in`.
+ * @details
+ * This is the inner loop of matrix products, e.g. in `BasicMatrixDft`.
+ */
+template <typename T>
+void multiplyAccumulateData(std::complex<T>* acc, const std::complex<T>* in, std::complex<T> factor, long size) {
+  T* a = reinterpret_cast<T*>(acc);
+  const T* d = reinterpret_cast<const T*>(in);
+  const T re = factor.real();
+  const T im = factor.imag();
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    a[2 * i] += d[2 * i] * re - d[2 * i + 1] * im;
+    a[2 * i + 1] += d[2 * i] * im + d[2 * i + 1] * re;
+  }
+}
+
+/**
+ * @brief Get the number of values per plane of a raster.
+ */
+template <typename TRaster>
+long planeSize(const TRaster& raster) {
+  return raster.shape()[0] * raster.shape()[1];
+}
+
+/**
+ * @brief Get the number of planes of a raster with given plane size.
+ * @details
+ * Throws if the raster size is not a multiple of the plane size.
+ */
+template <typename TRaster>
+long planeCount(const TRaster& raster, long size) {
+  if (size <= 0 || raster.size() % size != 0) {
+    throw std::invalid_argument(
+        "Raster size " + std::to_string(raster.size()) + " is not a multiple of plane size " + std::to_string(size));
+  }
+  return raster.size() / size;
+}
+
+/**
+ * @brief Multiply a raster or stack by a real factor.
+ */
+template <typename TRaster, typename T>
+void scale(TRaster& raster, T factor) {
+  const long size = planeSize(raster);
+  const long count = planeCount(raster, size);
+  auto* data = raster.data();
+#pragma omp parallel for if (count > 1)
+  for (long i = 0; i < count; ++i) {
+    scaleData(data + i * size, size, factor);
+  }
+}
+
+/**
+ * @brief Multiply each plane of a raster or stack by a filter plane.
+ * @param raster The raster or stack
+ * @param filter The filter, of the plane shape of `raster`
+ */
+template <typename TRaster, typename TFilter>
+void multiply(TRaster& raster, const TFilter& filter) {
+  const long size = filter.size();
+  const long count = planeCount(raster, size);
+  auto* data = raster.data();
+  const auto* f = filter.data();
+#pragma omp parallel for if (count > 1)
+  for (long i = 0; i < count; ++i) {
+    multiplyData(data + i * size, f, size);
+  }
+}
+
+/**
+ * @brief Multiply each plane of a raster or stack by a filter plane and a real factor, in a single pass.
+ * @copydetails multiply()
+ */
+template <typename TRaster, typename TFilter, typename T>
+void multiplyScale(TRaster& raster, const TFilter& filter, T factor) {
+  const long size = filter.size();
+  const long count = planeCount(raster, size);
+  auto* data = raster.data();
+  const auto* f = filter.data();
+#pragma omp parallel for if (count > 1)
+  for (long i = 0; i < count; ++i) {
+    multiplyScaleData(data + i * size, f, size, factor);
+  }
+}
+
+/**
+ * @brief Compute the squared modulus of a complex raster or stack into a real raster or stack of the same shape.
+ */
+template <typename TIn, typename TOut>
+void norm2(const TIn& in, TOut& out) {
+  const long size = planeSize(in);
+  const long count = planeCount(in, size);
+  if (out.size() != in.size()) {
+    throw std::invalid_argument("Input and output sizes differ");
+  }
+  const auto* i = in.data();
+  auto* o = out.data();
+#pragma omp parallel for if (count > 1)
+  for (long p = 0; p < count; ++p) {
+    norm2Data(i + p * size, o + p * size, size);
+  }
+}
+
+/**
+ * @brief Multiply each plane of a raster or stack by a filter plane and accumulate into a raster or stack,
+ * i.e. `acc += in * filter`.
+ * @param acc The accumulator, of the shape of `in`
+ * @param in The raster or stack
+ * @param filter The filter, of the plane shape of `in`
+ */
+template <typename TAcc, typename TIn, typename TFilter>
+void multiplyAccumulate(TAcc& acc, const TIn& in, const TFilter& filter) {
+  const long size = filter.size();
+  const long count = planeCount(in, size);
+  if (acc.size() != in.size()) {
+    throw std::invalid_argument("Accumulator and input sizes differ");
+  }
+  auto* a = acc.data();
+  const auto* i = in.data();
+  const auto* f = filter.data();
+#pragma omp parallel for if (count > 1)
+  for (long p = 0; p < count; ++p) {
+    multiplyAccumulateData(a + p * size, i + p * size, f, size);
+  }
+}
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
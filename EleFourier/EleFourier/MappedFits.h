@@ -0,0 +1,504 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_MAPPEDFITS_H
+#define _ELEFOURIER_MAPPEDFITS_H
+
+#include "EleFitsData/Raster.h"
+
+#include <cassert>
+#include <cstddef> // size_t
+#include <cstdint>
+#include <cstdlib> // abs
+#include <cstring> // memcpy
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Memory-mapped access to the uncompressed images of a FITS file.
+ * @details
+ * This is a fast path for reading and writing big stacks of images,
+ * which bypasses CFITSIO's buffering and the subsequent copy:
+ * the data units are mapped in memory, and decoded (byte-swapped and converted) in a single vectorized pass,
+ * straight into the destination, e.g. a section of a `DftPlan` input buffer.
+ * Symmetrically, output buffers are encoded in a single pass straight into the mapped file.
+ *
+ * Only uncompressed image HDUs (Primary and `IMAGE` extensions) can be read or written;
+ * other HDUs are skipped but counted, such that indices are those of `Fits::MefFile`.
+ * `BSCALE` and `BZERO` are applied when reading; when writing, only the unsigned integer convention is applied.
+ *
+ * Decoding handles row padding: if the destination rows are wider than the image rows
+ * (e.g. the input buffer of an in-place real `DftPlan`), each image row is decoded at the beginning of a row.
+ * Conversely, encoding crops wider rows.
+ *
+ * As FITS data is big-endian, the mapped pages cannot be transformed in place on little-endian hosts,
+ * and are therefore always decoded.
+ *
+ * \code
+ * MappedFits input("stack.fits");
+ * RealDft dft(shape, input.hduCount() - 1, PlanningPolicy().inPlace());
+ * for (long i = 0; i < dft.count(); ++i) {
+ *   auto plane = dft.inBuffer(i);
+ *   input.readTo(i + 1, plane); // Rows are padded
+ * }
+ * dft.transform();
+ * \endcode
+ *
+ * \code
+ * auto output = MappedFits::create<float>("psfs.fits", shape, count); // Primary + count image extensions
+ * for (long i = 0; i < count; ++i) {
+ *   output.write(i + 1, psfs[i]);
+ * }
+ * \endcode
+ */
+class MappedFits {
+
+public:
+  /**
+   * @brief The FITS block size, in bytes.
+   */
+  static constexpr long blockSize = 2880;
+
+  /**
+   * @brief Open and map a file in read-only mode.
+   */
+  explicit MappedFits(const std::string& filename);
+
+  /**
+   * @brief Create and map a file with an empty Primary and image extensions of identical shapes.
+   * @tparam T The value type, which sets `BITPIX`
+   * @param filename The file name, which is overwritten if it exists
+   * @param shape The image shape
+   * @param count The number of image extensions
+   * @details
+   * Following the FITS convention, unsigned integers wider than 8 bits are stored as signed integers
+   * with `BZERO = 2^(N-1)`, which is applied exactly when writing and reading.
+   */
+  template <typename T>
+  static MappedFits create(const std::string& filename, const Fits::Position<2>& shape, long count) {
+    return MappedFits(filename, bitpix<T>(), bzero<T>(), {shape[0], shape[1]}, count);
+  }
+
+  /**
+   * @brief Destructor.
+   * @details
+   * In write mode, the data is flushed to disk.
+   */
+  ~MappedFits();
+
+  MappedFits(const MappedFits&) = delete;
+  MappedFits& operator=(const MappedFits&) = delete;
+
+  /**
+   * @brief Move constructor.
+   */
+  MappedFits(MappedFits&& other);
+
+  /**
+   * @brief Move assignment.
+   */
+  MappedFits& operator=(MappedFits&& other);
+
+  /**
+   * @brief Get the number of HDUs.
+   */
+  long hduCount() const;
+
+  /**
+   * @brief Check whether an HDU is an uncompressed image, i.e. can be read and written.
+   */
+  bool isImage(long index) const;
+
+  /**
+   * @brief Get the `BITPIX` of an image HDU.
+   */
+  long bitpix(long index) const;
+
+  /**
+   * @brief Get the shape of an image HDU, i.e. its `NAXISn` values.
+   */
+  const std::vector<long>& shape(long index) const;
+
+  /**
+   * @brief Get the number of values of an image HDU.
+   */
+  long size(long index) const;
+
+  /**
+   * @brief Decode an image HDU into contiguous data of `size(index)` values.
+   */
+  template <typename T>
+  void readDataTo(long index, T* data) const {
+    const auto& hdu = image(index);
+    decode(hdu, 0, hdu.size, data);
+  }
+
+  /**
+   * @brief Decode an image HDU into a raster.
+   * @details
+   * The raster rows can be wider than the image rows, in which case the trailing values are left untouched.
+   * The number of rows must match.
+   */
+  template <typename TRaster>
+  void readTo(long index, TRaster& raster) const {
+    const auto& hdu = image(index);
+    const long width = hdu.shape.empty() ? 0 : hdu.shape[0];
+    const long stride = checkRows(hdu, raster.shape()[0], raster.size());
+    auto* data = raster.data();
+    const long rows = width ? hdu.size / width : 0;
+#pragma omp parallel for if (hdu.size > parallelThreshold)
+    for (long j = 0; j < rows; ++j) {
+      decode(hdu, j * width, width, data + j * stride);
+    }
+  }
+
+  /**
+   * @brief Encode contiguous data of `size(index)` values into an image HDU.
+   */
+  template <typename T>
+  void writeData(long index, const T* data) {
+    const auto& hdu = writableImage(index);
+    encode(hdu, 0, hdu.size, data);
+  }
+
+  /**
+   * @brief Encode a raster into an image HDU.
+   * @details
+   * The raster rows can be wider than the image rows, in which case the trailing values are ignored.
+   * The number of rows must match.
+   */
+  template <typename TRaster>
+  void write(long index, const TRaster& raster) {
+    const auto& hdu = writableImage(index);
+    const long width = hdu.shape.empty() ? 0 : hdu.shape[0];
+    const long stride = checkRows(hdu, raster.shape()[0], raster.size());
+    const auto* data = raster.data();
+    const long rows = width ? hdu.size / width : 0;
+#pragma omp parallel for if (hdu.size > parallelThreshold)
+    for (long j = 0; j < rows; ++j) {
+      encode(hdu, j * width, width, data + j * stride);
+    }
+  }
+
+  /**
+   * @brief Flush the written data to disk.
+   */
+  void sync();
+
+private:
+  /**
+   * @brief The number of values above which decoding and encoding are parallelized.
+   */
+  static constexpr long parallelThreshold = 1 << 16;
+
+  /**
+   * @brief The HDU metadata.
+   */
+  struct Hdu {
+    /** @brief Whether the HDU is an uncompressed image. */
+    bool image;
+    /** @brief The offset of the data unit, in bytes. */
+    long offset;
+    /** @brief The `BITPIX` value. */
+    long bitpix;
+    /** @brief The `NAXISn` values. */
+    std::vector<long> shape;
+    /** @brief The number of values. */
+    long size;
+    /** @brief The `BSCALE` value. */
+    double bscale;
+    /** @brief The `BZERO` value. */
+    double bzero;
+  };
+
+  /**
+   * @brief Create, write the headers and map a file.
+   */
+  MappedFits(
+      const std::string& filename,
+      long bitpix,
+      std::uint64_t bzero,
+      const std::vector<long>& shape,
+      long count);
+
+  /**
+   * @brief Map the file and parse the headers.
+   */
+  void map(long size, bool writable);
+
+  /**
+   * @brief Flush, unmap and close the file, if open.
+   */
+  void unmap();
+
+  /**
+   * @brief Parse the headers.
+   */
+  void parse();
+
+  /**
+   * @brief Get an image HDU, or throw.
+   */
+  const Hdu& image(long index) const;
+
+  /**
+   * @brief Get an image HDU in write mode, or throw.
+   */
+  const Hdu& writableImage(long index) const;
+
+  /**
+   * @brief Check whether the rows of a raster match those of an image, and get the raster row stride.
+   */
+  static long checkRows(const Hdu& hdu, long stride, long size);
+
+  /**
+   * @brief Get the `BITPIX` of a value type.
+   */
+  template <typename T>
+  static constexpr long bitpix() {
+    static_assert(std::is_arithmetic<T>::value, "FITS images only support arithmetic types");
+    return std::is_floating_point<T>::value ? -8 * long(sizeof(T) > 4 ? 8 : 4) : 8 * long(sizeof(T));
+  }
+
+  /**
+   * @brief Get the `BZERO` of a value type, i.e. `2^(N-1)` for unsigned integers wider than 8 bits, or 0.
+   */
+  template <typename T>
+  static constexpr std::uint64_t bzero() {
+    return std::is_unsigned<T>::value && std::is_integral<T>::value && sizeof(T) > 1 ?
+        std::uint64_t(1) << (8 * sizeof(T) - 1) :
+        0;
+  }
+
+  /**
+   * @brief Check whether the scaling of an HDU of given raw type is the FITS convention for unsigned integers.
+   */
+  template <typename TRaw>
+  static bool isUnsigned(double bscale, double bzero) {
+    return std::is_integral<TRaw>::value && sizeof(TRaw) > 1 && bscale == 1 &&
+        bzero == double(std::uint64_t(1) << (8 * sizeof(TRaw) - 1));
+  }
+
+  /**
+   * @brief The unsigned integer type of given size, in bytes.
+   */
+  template <std::size_t N>
+  using Bits = typename std::conditional<
+      N == 1,
+      std::uint8_t,
+      typename std::conditional<N == 2, std::uint16_t, typename std::conditional<N == 4, std::uint32_t, std::uint64_t>::type>::
+          type>::type;
+
+  /**
+   * @brief Load a big-endian value.
+   */
+  template <typename TRaw>
+  static TRaw load(const unsigned char* src) {
+    Bits<sizeof(TRaw)> bits;
+    std::memcpy(&bits, src, sizeof(TRaw));
+    bits = swap(bits);
+    TRaw raw;
+    std::memcpy(&raw, &bits, sizeof(TRaw));
+    return raw;
+  }
+
+  /**
+   * @brief Store a value as big-endian.
+   */
+  template <typename TRaw>
+  static void store(TRaw raw, unsigned char* dst) {
+    Bits<sizeof(TRaw)> bits;
+    std::memcpy(&bits, &raw, sizeof(TRaw));
+    bits = swap(bits);
+    std::memcpy(dst, &bits, sizeof(TRaw));
+  }
+
+  /**
+   * @brief Swap bytes on little-endian hosts.
+   */
+  static std::uint8_t swap(std::uint8_t bits) {
+    return bits;
+  }
+
+  /** @copydoc swap */
+  static std::uint16_t swap(std::uint16_t bits) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return __builtin_bswap16(bits);
+#else
+    return bits;
+#endif
+  }
+
+  /** @copydoc swap */
+  static std::uint32_t swap(std::uint32_t bits) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return __builtin_bswap32(bits);
+#else
+    return bits;
+#endif
+  }
+
+  /** @copydoc swap */
+  static std::uint64_t swap(std::uint64_t bits) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return __builtin_bswap64(bits);
+#else
+    return bits;
+#endif
+  }
+
+  /**
+   * @brief Decode a range of values of given raw type.
+   */
+  template <typename TRaw, typename T>
+  static void decodeAs(const unsigned char* src, long size, T* dst, double bscale, double bzero) {
+    if (bscale == 1 && bzero == 0) {
+#pragma omp simd
+      for (long i = 0; i < size; ++i) {
+        dst[i] = static_cast<T>(load<TRaw>(src + i * sizeof(TRaw)));
+      }
+    } else if (isUnsigned<TRaw>(bscale, bzero)) { // Exact: adding 2^(N-1) flips the sign bit
+      using TBits = Bits<sizeof(TRaw)>;
+      constexpr TBits sign = TBits(1) << (8 * sizeof(TRaw) - 1);
+#pragma omp simd
+      for (long i = 0; i < size; ++i) {
+        dst[i] = static_cast<T>(TBits(load<TBits>(src + i * sizeof(TRaw)) ^ sign));
+      }
+    } else {
+#pragma omp simd
+      for (long i = 0; i < size; ++i) {
+        dst[i] = static_cast<T>(bzero + bscale * load<TRaw>(src + i * sizeof(TRaw)));
+      }
+    }
+  }
+
+  /**
+   * @brief Encode a range of values as given raw type.
+   * @details
+   * Scaling is only supported for the unsigned integer convention, as written by `create()`.
+   */
+  template <typename TRaw, typename T>
+  static void encodeAs(const T* src, long size, unsigned char* dst, double bscale, double bzero) {
+    if (isUnsigned<TRaw>(bscale, bzero)) { // Exact: subtracting 2^(N-1) flips the sign bit
+      using TBits = Bits<sizeof(TRaw)>;
+      constexpr TBits sign = TBits(1) << (8 * sizeof(TRaw) - 1);
+#pragma omp simd
+      for (long i = 0; i < size; ++i) {
+        store(TBits(static_cast<TBits>(src[i]) ^ sign), dst + i * sizeof(TRaw));
+      }
+    } else {
+#pragma omp simd
+      for (long i = 0; i < size; ++i) {
+        store(static_cast<TRaw>(src[i]), dst + i * sizeof(TRaw));
+      }
+    }
+  }
+
+  /**
+   * @brief Decode a range of values of an image HDU.
+   * @details
+   * This does not throw, such that it can be called in parallel regions: `BITPIX` is validated beforehand.
+   */
+  template <typename T>
+  void decode(const Hdu& hdu, long first, long size, T* dst) const noexcept {
+    const unsigned char* src = m_data + hdu.offset + first * (std::abs(hdu.bitpix) / 8);
+    switch (hdu.bitpix) {
+      case 8:
+        return decodeAs<std::uint8_t>(src, size, dst, hdu.bscale, hdu.bzero);
+      case 16:
+        return decodeAs<std::int16_t>(src, size, dst, hdu.bscale, hdu.bzero);
+      case 32:
+        return decodeAs<std::int32_t>(src, size, dst, hdu.bscale, hdu.bzero);
+      case 64:
+        return decodeAs<std::int64_t>(src, size, dst, hdu.bscale, hdu.bzero);
+      case -32:
+        return decodeAs<float>(src, size, dst, hdu.bscale, hdu.bzero);
+      case -64:
+        return decodeAs<double>(src, size, dst, hdu.bscale, hdu.bzero);
+      default:
+        assert(false); // BITPIX is validated by parse() and the constructor
+    }
+  }
+
+  /**
+   * @brief Encode a range of values into an image HDU.
+   * @details
+   * This does not throw, such that it can be called in parallel regions: `BITPIX` is validated beforehand.
+   */
+  template <typename T>
+  void encode(const Hdu& hdu, long first, long size, const T* src) noexcept {
+    unsigned char* dst = m_data + hdu.offset + first * (std::abs(hdu.bitpix) / 8);
+    switch (hdu.bitpix) {
+      case 8:
+        return encodeAs<std::uint8_t>(src, size, dst, hdu.bscale, hdu.bzero);
+      case 16:
+        return encodeAs<std::int16_t>(src, size, dst, hdu.bscale, hdu.bzero);
+      case 32:
+        return encodeAs<std::int32_t>(src, size, dst, hdu.bscale, hdu.bzero);
+      case 64:
+        return encodeAs<std::int64_t>(src, size, dst, hdu.bscale, hdu.bzero);
+      case -32:
+        return encodeAs<float>(src, size, dst, hdu.bscale, hdu.bzero);
+      case -64:
+        return encodeAs<double>(src, size, dst, hdu.bscale, hdu.bzero);
+      default:
+        assert(false); // BITPIX is validated by parse() and the constructor
+    }
+  }
+
+  /**
+   * @brief The file name.
+   */
+  std::string m_filename;
+
+  /**
+   * @brief The file descriptor.
+   */
+  int m_fd;
+
+  /**
+   * @brief The mapped data.
+   */
+  unsigned char* m_data;
+
+  /**
+   * @brief The mapped size, in bytes.
+   */
+  long m_size;
+
+  /**
+   * @brief The write mode flag.
+   */
+  bool m_writable;
+
+  /**
+   * @brief The HDUs.
+   */
+  std::vector<Hdu> m_hdus;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,281 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_MATRIXDFT_H
+#define _ELEFOURIER_MATRIXDFT_H
+
+#include "EleFitsData/Raster.h"
+#include "EleFourier/Kernels.h"
+
+#include <algorithm> // fill_n
+#include <array>
+#include <cmath> // round
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <type_traits> // conditional_t, is_same
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Matrix Fourier transform, i.e. 2D Fourier transform at arbitrary output sampling and field of view.
+ * @tparam T The real value type
+ * @details
+ * Unlike `DftPlan`, whose output sampling is fixed by the input grid,
+ * the matrix DFT evaluates the Fourier transform of an input plane of shape `inShape`
+ * on a centered output grid of shape `outShape` and of frequency step `step` (in cycles per input pixel):
+ * \f[
+ * out(u, v) = \sum_{x, y} in(x, y) e^{-2 i \pi ((x - x_0)(u - u_0) s_x + (y - y_0)(v - v_0) s_y)}
+ * \f]
+ * where \f$(x_0, y_0) = inShape / 2\f$ and \f$(u_0, v_0) = outShape / 2\f$ are the centers (integer division)
+ * and \f$(s_x, s_y)\f$ is the step.
+ * For example, for a pupil of diameter `d` pixels, a PSF sampled at `lambda / (q d)`
+ * is obtained with `step = 1 / (q d)`, whatever the pupil mask size and PSF shape, i.e. without any padding.
+ * With `step = 1 / inShape`, the output is that of a DFT, shifted to the center.
+ * A negative step yields the inverse transform.
+ *
+ * The transform is separable and computed as two matrix products, `Ay * in * Ax^T`,
+ * where the matrices of complex exponentials are computed once, at construction;
+ * the rows are processed in parallel (`omp parallel for`) and null input values are skipped.
+ * The cost per plane is `inHeight * inWidth * outWidth + inHeight * outWidth * outHeight` complex multiply-adds,
+ * which is lower than that of a padded FFT as long as the output is small compared to the padded shape.
+ *
+ * As for `DftPlan`, the transform is not normalized, and the input buffer is preserved.
+ * \code
+ * MatrixDft mft(pupilShape, psfShape, {1. / (2 * diameter), 1. / (2 * diameter)}); // Nyquist-sampled PSF
+ * mft.inBuffer() = ... ; // Fill the pupil amplitude
+ * const auto& amplitude = mft.transform().outBuffer();
+ * \endcode
+ */
+template <typename T>
+class BasicMatrixDft {
+
+public:
+  /**
+   * @brief The real value type.
+   */
+  using Real = T;
+
+  /**
+   * @brief The input and output value type.
+   */
+  using Value = std::complex<T>;
+
+  /**
+   * @brief Constructor.
+   * @param inShape The input plane shape
+   * @param outShape The output plane shape
+   * @param step The frequency step along each axis, in cycles per input pixel
+   * @param count The number of planes
+   */
+  BasicMatrixDft(
+      const Fits::Position<2>& inShape,
+      const Fits::Position<2>& outShape,
+      const std::array<double, 2>& step,
+      long count = 1) :
+      m_step(step),
+      m_in({check(inShape)[0], inShape[1], count}), m_out({check(outShape)[0], outShape[1], count}),
+      m_tmp({outShape[0], inShape[1]}), m_x(exponentials(inShape[0], outShape[0], step[0], true)),
+      m_y(exponentials(inShape[1], outShape[1], step[1], false)) {}
+
+  /**
+   * @brief Get the number of planes.
+   */
+  long count() const {
+    return m_in.shape()[2];
+  }
+
+  /**
+   * @brief Get the input plane shape.
+   */
+  Fits::Position<2> inShape() const {
+    return {m_in.shape()[0], m_in.shape()[1]};
+  }
+
+  /**
+   * @brief Get the output plane shape.
+   */
+  Fits::Position<2> outShape() const {
+    return {m_out.shape()[0], m_out.shape()[1]};
+  }
+
+  /**
+   * @brief Get the frequency step.
+   */
+  const std::array<double, 2>& step() const {
+    return m_step;
+  }
+
+  /**
+   * @brief Access the input buffer.
+   */
+  Fits::PtrRaster<Value> inBuffer(long index = 0) {
+    return m_in.section(index);
+  }
+
+  /**
+   * @brief Access the whole input stack.
+   */
+  Fits::PtrRaster<Value, 3> inStack() {
+    return {m_in.shape(), m_in.data()};
+  }
+
+  /**
+   * @brief Access the output buffer.
+   */
+  Fits::PtrRaster<const Value> outBuffer(long index = 0) const {
+    return m_out.section(index);
+  }
+
+  /**
+   * @copydoc outBuffer()
+   */
+  Fits::PtrRaster<Value> outBuffer(long index = 0) {
+    return m_out.section(index);
+  }
+
+  /**
+   * @brief Access the whole output stack.
+   */
+  Fits::PtrRaster<Value, 3> outStack() {
+    return {m_out.shape(), m_out.data()};
+  }
+
+  /**
+   * @brief Compute the transform.
+   */
+  BasicMatrixDft& transform() {
+    const long inWidth = m_in.shape()[0];
+    const long inHeight = m_in.shape()[1];
+    const long outWidth = m_out.shape()[0];
+    const long outHeight = m_out.shape()[1];
+    for (long k = 0; k < count(); ++k) {
+      const Value* in = &m_in[{0, 0, k}];
+      Value* out = &m_out[{0, 0, k}];
+      Value* tmp = m_tmp.data();
+
+      // tmp = in * Ax^T, row by row
+#pragma omp parallel for
+      for (long y = 0; y < inHeight; ++y) {
+        Value* row = tmp + y * outWidth;
+        std::fill_n(row, outWidth, Value(0));
+        for (long x = 0; x < inWidth; ++x) {
+          const Value value = in[x + y * inWidth];
+          if (value != Value(0)) {
+            multiplyAccumulateData(row, m_x.data() + x * outWidth, value, outWidth);
+          }
+        }
+      }
+
+      // out = Ay * tmp, row by row
+#pragma omp parallel for
+      for (long v = 0; v < outHeight; ++v) {
+        Value* row = out + v * outWidth;
+        std::fill_n(row, outWidth, Value(0));
+        for (long y = 0; y < inHeight; ++y) {
+          multiplyAccumulateData(row, tmp + y * outWidth, m_y[y + v * inHeight], outWidth);
+        }
+      }
+    }
+    return *this;
+  }
+
+private:
+  /**
+   * @brief Check that a shape is not empty.
+   */
+  static const Fits::Position<2>& check(const Fits::Position<2>& shape) {
+    if (shape[0] < 1 || shape[1] < 1) {
+      throw std::invalid_argument(
+          "Invalid matrix DFT shape: " + std::to_string(shape[0]) + "x" + std::to_string(shape[1]));
+    }
+    return shape;
+  }
+
+  /**
+   * @brief Compute the matrix of complex exponentials along one axis.
+   * @param transposed If true, the matrix is stored input-major, i.e. as `A^T`
+   * @details
+   * The phase is reduced to a fraction of turn before multiplying by `2 pi`, to preserve the precision.
+   * The reduction is computed in double precision (or long double), and only the reduced phase is narrowed to `T`,
+   * such that single precision matrices do not lose the fractional part of large products.
+   */
+  static std::vector<Value> exponentials(long inSize, long outSize, double step, bool transposed) {
+    using Wide = std::conditional_t<std::is_same<T, long double>::value, long double, double>;
+    std::vector<Value> matrix(inSize * outSize);
+    const long inCenter = inSize / 2;
+    const long outCenter = outSize / 2;
+    const Wide twoPi = 2 * std::acos(Wide(-1));
+    for (long o = 0; o < outSize; ++o) {
+      for (long i = 0; i < inSize; ++i) {
+        const Wide turns = Wide(step) * Wide((i - inCenter) * (o - outCenter));
+        const T phase = static_cast<T>(-twoPi * (turns - std::round(turns)));
+        matrix[transposed ? o + i * outSize : i + o * inSize] = std::polar(T(1), phase);
+      }
+    }
+    return matrix;
+  }
+
+  /**
+   * @brief The frequency step.
+   */
+  std::array<double, 2> m_step;
+
+  /**
+   * @brief The input buffer.
+   */
+  Fits::VecRaster<Value, 3> m_in;
+
+  /**
+   * @brief The output buffer.
+   */
+  Fits::VecRaster<Value, 3> m_out;
+
+  /**
+   * @brief The intermediate product, of shape `(outWidth, inHeight)`.
+   */
+  Fits::VecRaster<Value> m_tmp;
+
+  /**
+   * @brief The transposed matrix along x, of shape `(outWidth, inWidth)`.
+   */
+  std::vector<Value> m_x;
+
+  /**
+   * @brief The matrix along y, of shape `(inHeight, outHeight)`.
+   */
+  std::vector<Value> m_y;
+};
+
+/**
+ * @brief Double precision matrix DFT.
+ */
+using MatrixDft = BasicMatrixDft<double>;
+
+/**
+ * @brief Single precision matrix DFT.
+ */
+using MatrixDftF = BasicMatrixDft<float>;
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,229 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_MPIBROADBANDPSF_H
+#define _ELEFOURIER_MPIBROADBANDPSF_H
+
+#include "EleFourier/BroadbandPsf.h"
+#include "EleFourier/MpiDftPlan.h"
+
+#include <complex>
+#include <exception>
+#include <mpi.h>
+#include <stdexcept>
+#include <utility> // pair
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Polychromatic PSF engine distributed across the processes of an MPI communicator.
+ * @tparam T The real value type
+ * @details
+ * The (parameter, wavelength) grid of `BasicBroadbandPsf::run()` is enumerated parameter-major,
+ * and split into contiguous ranges of work items of balanced sizes, one per process (see `itemRange()`),
+ * such that each process mostly handles whole parameters.
+ * Within a process, the items of its range are distributed dynamically to the threads of a `BasicBroadbandPsf`.
+ * The MTF sums of the processes are then sent to the root process, which adds them and computes the broadband PSFs.
+ *
+ * Each process only allocates and sends the MTF sums of the parameters of its range,
+ * i.e. about `params / processes() + 1` sums, and a parameter is communicated only by the processes which touch it.
+ * The root process holds the sums of all the parameters, as the single-process engine does.
+ *
+ * The code of a single-process run barely changes:
+ * \code
+ * MPI_Init(&argc, &argv);
+ * MpiBroadbandPsf engine({1024, 1024}, {512, 512}); // Same shapes on all the processes
+ * const auto psfs = engine.run(params, lambdas, [&](long p, long l, Fits::PtrRaster<std::complex<double>>& pupil) {
+ *   phases[p].evalAmplitude(wavelengths[l], pupil); // Only called for the items of the process
+ * });
+ * if (engine.rank() == 0) {
+ *   const auto broadband = psfs.section(0); // Other processes get an empty stack
+ * }
+ * \endcode
+ *
+ * The communicator is not duplicated, and must outlive the engine.
+ */
+template <typename T>
+class BasicMpiBroadbandPsf {
+
+public:
+  /**
+   * @brief The pupil amplitude value type.
+   */
+  using Complex = std::complex<T>;
+
+  /**
+   * @brief Constructor.
+   * @param pupilShape The pupil shape, a multiple of the broadband shape
+   * @param broadbandShape The broadband PSF shape
+   * @param comm The communicator
+   * @param threads The number of threads per process, or 0 for `omp_get_max_threads()`
+   * @param policy The planning policy
+   */
+  BasicMpiBroadbandPsf(
+      const Fits::Position<2>& pupilShape,
+      const Fits::Position<2>& broadbandShape,
+      MPI_Comm comm = MPI_COMM_WORLD,
+      long threads = 0,
+      const PlanningPolicy& policy = PlanningPolicy()) :
+      m_engine(pupilShape, broadbandShape, threads, policy),
+      m_comm(comm), m_rank(0), m_size(1) {
+    checkMpi(MPI_Comm_rank(m_comm, &m_rank), "MPI_Comm_rank");
+    checkMpi(MPI_Comm_size(m_comm, &m_size), "MPI_Comm_size");
+  }
+
+  /**
+   * @brief Get the rank of the process.
+   */
+  int rank() const {
+    return m_rank;
+  }
+
+  /**
+   * @brief Get the number of processes.
+   */
+  int processes() const {
+    return m_size;
+  }
+
+  /**
+   * @brief Access the local engine.
+   */
+  BasicBroadbandPsf<T>& engine() {
+    return m_engine;
+  }
+
+  /**
+   * @brief Compute the range of work items of a process.
+   * @param count The number of items
+   * @param rank The rank of the process
+   * @param size The number of processes
+   * @return The first item and the item past the last one,
+   *         such that the ranges of consecutive ranks are contiguous and their sizes differ by at most 1
+   */
+  static std::pair<long, long> itemRange(long count, int rank, int size) {
+    return {count * rank / size, count * (rank + 1) / size};
+  }
+
+  /**
+   * @brief Compute the broadband PSFs, collectively.
+   * @param params The number of parameters
+   * @param lambdas The number of wavelengths
+   * @param pupil The pupil function, as for `BasicBroadbandPsf::run()`, only called for the items of the process
+   * @param root The rank of the process which gets the PSFs
+   * @return The stack of broadband PSFs on the root process, one plane per parameter, or an empty stack
+   * @details
+   * If the pupil function throws on some process, all the processes throw:
+   * the process rethrows its exception, and the others throw a `std::runtime_error`.
+   */
+  template <typename TPupil>
+  Fits::VecRaster<T, 3> run(long params, long lambdas, TPupil&& pupil, int root = 0) {
+    const auto range = itemRange(params * lambdas, m_rank, m_size);
+    std::vector<std::vector<Complex>> sums;
+    std::exception_ptr error;
+    try {
+      sums = m_engine.accumulate(params, lambdas, range.first, range.second, std::forward<TPupil>(pupil));
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    // Fail together, instead of deadlocking in the reduction
+    int failed = bool(error);
+    checkMpi(MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_LOR, m_comm), "MPI_Allreduce");
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    if (failed) {
+      throw std::runtime_error("Broadband PSF computation failed on another process");
+    }
+
+    // Send the partial sums of the parameters of each process to the root process
+    const auto type = FftwMpiTraits<T>::mpiType();
+    const long mtfSize = m_engine.mtfSize();
+    const int size = Mpi::toInt(2 * mtfSize, "MTF sum size");
+    if (m_rank != root) {
+      for (auto& sum : sums) {
+        checkMpi(MPI_Send(sum.data(), size, type, root, 0, m_comm), "MPI_Send");
+      }
+      const auto& shape = m_engine.broadbandShape();
+      return Fits::VecRaster<T, 3>({shape[0], shape[1], 0});
+    }
+
+    // Add them on the root process
+    std::vector<std::vector<Complex>> all(params);
+    const auto own = BasicBroadbandPsf<T>::paramRange(lambdas, range.first, range.second);
+    for (long p = own.first; p < own.second; ++p) {
+      all[p] = std::move(sums[p - own.first]);
+    }
+    std::vector<Complex> buffer(mtfSize);
+    for (int r = 0; r < m_size; ++r) {
+      if (r == root) {
+        continue;
+      }
+      const auto items = itemRange(params * lambdas, r, m_size);
+      const auto touched = BasicBroadbandPsf<T>::paramRange(lambdas, items.first, items.second);
+      for (long p = touched.first; p < touched.second; ++p) {
+        if (all[p].empty()) {
+          all[p].resize(mtfSize);
+          checkMpi(MPI_Recv(all[p].data(), size, type, r, 0, m_comm, MPI_STATUS_IGNORE), "MPI_Recv");
+        } else {
+          checkMpi(MPI_Recv(buffer.data(), size, type, r, 0, m_comm, MPI_STATUS_IGNORE), "MPI_Recv");
+          multiplyAccumulateData(all[p].data(), buffer.data(), Complex(1), mtfSize);
+        }
+      }
+    }
+    for (auto& sum : all) {
+      sum.resize(mtfSize, Complex(0)); // Without wavelengths, no parameter is touched
+    }
+    return m_engine.integrate(all);
+  }
+
+private:
+  /**
+   * @brief The local engine.
+   */
+  BasicBroadbandPsf<T> m_engine;
+
+  /**
+   * @brief The communicator.
+   */
+  MPI_Comm m_comm;
+
+  /**
+   * @brief The rank of the process.
+   */
+  int m_rank;
+
+  /**
+   * @brief The number of processes.
+   */
+  int m_size;
+};
+
+/**
+ * @brief Double precision broadband PSF engine distributed with MPI.
+ */
+using MpiBroadbandPsf = BasicMpiBroadbandPsf<double>;
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,744 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_MPIDFTPLAN_H
+#define _ELEFOURIER_MPIDFTPLAN_H
+
+#include "EleFourier/DftType.h"
+#include "EleFourier/FftwPlanner.h"
+#include "EleFourier/PlanningPolicy.h"
+
+#include <algorithm> // copy_n, min
+#include <complex>
+#include <cstddef> // ptrdiff_t
+#include <fftw3-mpi.h>
+#include <limits>
+#include <memory>
+#include <mpi.h>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility> // forward
+#include <vector>
+
+/**
+ * @file
+ * @brief FFTW-MPI backend, available when the project is configured with `-DELEFOURIER_MPI=ON`.
+ */
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Throw a `std::runtime_error` if an MPI call failed.
+ */
+inline void checkMpi(int status, const std::string& call) {
+  if (status != MPI_SUCCESS) {
+    throw std::runtime_error(call + " failed with MPI error " + std::to_string(status));
+  }
+}
+
+/**
+ * @brief Precision-dependent FFTW-MPI API.
+ * @tparam T The real type, i.e. `float`, `double` or `long double`
+ * @details
+ * This is the MPI counterpart of `FftwTraits`, for the two-dimensional interface of `fftw_mpi_`, `fftwf_mpi_` and
+ * `fftwl_mpi_`, together with the matching MPI datatype.
+ */
+template <typename T>
+struct FftwMpiTraits;
+
+#define DEF_FFTW_MPI_TRAITS(T, X, datatype) \
+  template <> \
+  struct FftwMpiTraits<T> { \
+    using Real = T; \
+    using Complex = X##_complex; \
+    using Plan = X##_plan; \
+    static MPI_Datatype mpiType() { \
+      return datatype; \
+    } \
+    static void init() { \
+      X##_mpi_init(); \
+    } \
+    template <typename... Ts> \
+    static std::ptrdiff_t localSize2d(Ts&&... args) { \
+      return X##_mpi_local_size_2d(std::forward<Ts>(args)...); \
+    } \
+    template <typename... Ts> \
+    static Plan planDft2d(Ts&&... args) { \
+      return X##_mpi_plan_dft_2d(std::forward<Ts>(args)...); \
+    } \
+    template <typename... Ts> \
+    static Plan planDftR2c2d(Ts&&... args) { \
+      return X##_mpi_plan_dft_r2c_2d(std::forward<Ts>(args)...); \
+    } \
+    template <typename... Ts> \
+    static Plan planDftC2r2d(Ts&&... args) { \
+      return X##_mpi_plan_dft_c2r_2d(std::forward<Ts>(args)...); \
+    } \
+    static void executeDft(const Plan plan, Complex* in, Complex* out) { \
+      X##_mpi_execute_dft(plan, in, out); \
+    } \
+    static void executeDftR2c(const Plan plan, Real* in, Complex* out) { \
+      X##_mpi_execute_dft_r2c(plan, in, out); \
+    } \
+    static void executeDftC2r(const Plan plan, Complex* in, Real* out) { \
+      X##_mpi_execute_dft_c2r(plan, in, out); \
+    } \
+  };
+
+DEF_FFTW_MPI_TRAITS(float, fftwf, MPI_FLOAT)
+DEF_FFTW_MPI_TRAITS(double, fftw, MPI_DOUBLE)
+DEF_FFTW_MPI_TRAITS(long double, fftwl, MPI_LONG_DOUBLE)
+
+#undef DEF_FFTW_MPI_TRAITS
+
+namespace Mpi {
+
+/**
+ * @brief The FFTW sign of a DFT type, only defined for the supported types.
+ */
+template <typename TType>
+struct FftwSign;
+
+template <typename T>
+struct FftwSign<BasicRealDftType<T>> {
+  static constexpr int value = FFTW_FORWARD;
+};
+
+template <typename T>
+struct FftwSign<BasicComplexDftType<T>> {
+  static constexpr int value = FFTW_FORWARD;
+};
+
+template <typename T>
+struct FftwSign<Inverse<BasicRealDftType<T>>> {
+  static constexpr int value = FFTW_BACKWARD;
+};
+
+template <typename T>
+struct FftwSign<Inverse<BasicComplexDftType<T>>> {
+  static constexpr int value = FFTW_BACKWARD;
+};
+
+/**
+ * @brief Initialize FFTW-MPI for a given precision, once.
+ * @details
+ * FFTW's multithreading is initialized before, as required by FFTW for hybrid MPI and OpenMP execution.
+ */
+template <typename T>
+void init() {
+  static const bool done = [] {
+    std::lock_guard<std::mutex> lock(FftwPlanner::instance().mutex());
+    FftwGlobalsCleaner::instantiate().initThreads<T>();
+    FftwMpiTraits<T>::init();
+    return true;
+  }();
+  (void)done;
+}
+
+/**
+ * @brief Create a two-dimensional FFTW-MPI plan, dispatched on the value types of the buffers.
+ */
+template <typename T>
+typename FftwMpiTraits<T>::Plan
+plan(std::ptrdiff_t n0, std::ptrdiff_t n1, T* in, std::complex<T>* out, MPI_Comm comm, int, unsigned flags) {
+  using Complex = typename FftwMpiTraits<T>::Complex;
+  return FftwMpiTraits<T>::planDftR2c2d(n0, n1, in, reinterpret_cast<Complex*>(out), comm, flags);
+}
+
+template <typename T>
+typename FftwMpiTraits<T>::Plan
+plan(std::ptrdiff_t n0, std::ptrdiff_t n1, std::complex<T>* in, T* out, MPI_Comm comm, int, unsigned flags) {
+  using Complex = typename FftwMpiTraits<T>::Complex;
+  return FftwMpiTraits<T>::planDftC2r2d(n0, n1, reinterpret_cast<Complex*>(in), out, comm, flags);
+}
+
+template <typename T>
+typename FftwMpiTraits<T>::Plan plan(
+    std::ptrdiff_t n0,
+    std::ptrdiff_t n1,
+    std::complex<T>* in,
+    std::complex<T>* out,
+    MPI_Comm comm,
+    int sign,
+    unsigned flags) {
+  using Complex = typename FftwMpiTraits<T>::Complex;
+  return FftwMpiTraits<T>::planDft2d(
+      n0,
+      n1,
+      reinterpret_cast<Complex*>(in),
+      reinterpret_cast<Complex*>(out),
+      comm,
+      sign,
+      flags);
+}
+
+/**
+ * @brief Execute an FFTW-MPI plan, dispatched on the value types of the buffers.
+ */
+template <typename T>
+void execute(typename FftwMpiTraits<T>::Plan plan, T* in, std::complex<T>* out) {
+  FftwMpiTraits<T>::executeDftR2c(plan, in, reinterpret_cast<typename FftwMpiTraits<T>::Complex*>(out));
+}
+
+template <typename T>
+void execute(typename FftwMpiTraits<T>::Plan plan, std::complex<T>* in, T* out) {
+  FftwMpiTraits<T>::executeDftC2r(plan, reinterpret_cast<typename FftwMpiTraits<T>::Complex*>(in), out);
+}
+
+template <typename T>
+void execute(typename FftwMpiTraits<T>::Plan plan, std::complex<T>* in, std::complex<T>* out) {
+  using Complex = typename FftwMpiTraits<T>::Complex;
+  FftwMpiTraits<T>::executeDft(plan, reinterpret_cast<Complex*>(in), reinterpret_cast<Complex*>(out));
+}
+
+/**
+ * @brief Convert a count to an `int`, as required by the MPI API, or throw.
+ */
+inline int toInt(long count, const std::string& what) {
+  if (count < 0 || count > std::numeric_limits<int>::max()) {
+    throw std::runtime_error(what + " does not fit the MPI count type: " + std::to_string(count));
+  }
+  return static_cast<int>(count);
+}
+
+/**
+ * @brief Contiguous MPI datatype of given number of bytes, e.g. of a padded buffer row, freed at destruction.
+ * @details
+ * Counting in rows instead of bytes keeps the counts and displacements of slabs below the `int` limit of MPI
+ * for planes of several gigabytes.
+ */
+class ContiguousType {
+
+public:
+  /**
+   * @brief Create and commit the datatype.
+   */
+  explicit ContiguousType(long bytes) : m_type(MPI_DATATYPE_NULL) {
+    checkMpi(MPI_Type_contiguous(toInt(bytes, "Row size"), MPI_BYTE, &m_type), "MPI_Type_contiguous");
+    checkMpi(MPI_Type_commit(&m_type), "MPI_Type_commit");
+  }
+
+  /**
+   * @brief Free the datatype.
+   */
+  ~ContiguousType() {
+    MPI_Type_free(&m_type);
+  }
+
+  ContiguousType(const ContiguousType&) = delete;
+  ContiguousType& operator=(const ContiguousType&) = delete;
+
+  /**
+   * @brief Get the datatype.
+   */
+  MPI_Datatype get() const {
+    return m_type;
+  }
+
+private:
+  /**
+   * @brief The datatype.
+   */
+  MPI_Datatype m_type;
+};
+
+} // namespace Mpi
+
+/**
+ * @brief DFT plan distributed across the processes of an MPI communicator, executed by FFTW-MPI.
+ * @tparam TType The DFT type, i.e. a `BasicRealDftType`, a `BasicComplexDftType`, or their inverses
+ * @details
+ * This is the distributed counterpart of `DftPlan`, for planes which do not fit in one node,
+ * on the same DFT types, shapes and scaling conventions, and with the same life cycle:
+ * the plan owns an input and an output buffer, `inverse()` creates the inverse plan over the same buffers,
+ * and `transform()` executes the transform, collectively.
+ *
+ * Planes are decomposed into slabs of consecutive rows (FFTW's default distribution for the first dimension),
+ * and each process only stores its own slab of the input and output buffers,
+ * which it accesses with `inSlab()` and `outSlab()`, the first row of which is `firstRow()`.
+ * Input and output slabs have the same rows.
+ * As required by FFTW-MPI, the rows of the real buffers are padded to `2 * (width / 2 + 1)` values,
+ * even for out-of-place transforms, and the slabs of real buffers include the padding columns.
+ * Alternatively, `scatter()` and `gather()` copy whole unpadded planes from and to a root process.
+ *
+ * \code
+ * MPI_Init(&argc, &argv);
+ * MpiComplexDft pupilToPsf({8192, 8192}); // Slabs of about 8192 / processes rows
+ * auto pupil = pupilToPsf.inSlab();
+ * for (const auto& p : pupil.domain()) {
+ *   pupil[p] = amplitude(p[0], p[1] + pupilToPsf.firstRow()); // Each process fills its own rows
+ * }
+ * pupilToPsf.transform(); // Collective
+ * pupilToPsf.gather(psf); // psf is only written on process 0
+ * \endcode
+ *
+ * Hermitian, axis and stack types are not supported, and a plan holds a single plane.
+ * FFTW-MPI's wisdom is not shared across processes: planning rigors other than `Estimate` measure on each process.
+ * The communicator, e.g. `MPI_COMM_WORLD`, is not duplicated, and must outlive the plan,
+ * and all the plans must be destroyed before `MPI_Finalize()`.
+ */
+template <typename TType>
+class MpiDftPlan {
+
+  template <typename>
+  friend class MpiDftPlan;
+
+public:
+  /**
+   * @brief The plan type.
+   */
+  using Type = TType;
+
+  /**
+   * @brief The inverse plan.
+   */
+  using Inverse = MpiDftPlan<typename Type::InverseType>;
+
+  /**
+   * @brief The signal value type.
+   */
+  using InValue = typename Type::InValue;
+
+  /**
+   * @brief The Fourier coefficient type.
+   */
+  using OutValue = typename Type::OutValue;
+
+  /**
+   * @brief The real value type, which sets the precision.
+   */
+  using Real = typename Type::Real;
+
+  /**
+   * @brief Constructor.
+   * @param shape The logical plane shape
+   * @param policy The planning policy, whose placement is ignored (transforms are out of place)
+   * @param comm The communicator
+   * @details
+   * This is a collective operation.
+   */
+  explicit MpiDftPlan(
+      const Fits::Position<2>& shape,
+      const PlanningPolicy& policy = PlanningPolicy(),
+      MPI_Comm comm = MPI_COMM_WORLD) :
+      MpiDftPlan(shape, policy, comm, nullptr, nullptr) {}
+
+  /**
+   * @brief Non-copyable.
+   */
+  MpiDftPlan(const MpiDftPlan&) = delete;
+
+  /**
+   * @brief Movable.
+   */
+  MpiDftPlan(MpiDftPlan&&) = default;
+
+  /**
+   * @brief Non-copyable.
+   */
+  MpiDftPlan& operator=(const MpiDftPlan&) = delete;
+
+  /**
+   * @brief Movable.
+   */
+  MpiDftPlan& operator=(MpiDftPlan&&) = default;
+
+  /**
+   * @brief Create the inverse plan with shared buffers.
+   * @details
+   * This is a collective operation.
+   */
+  Inverse inverse() {
+    return Inverse(m_shape, m_policy, m_comm, m_out, m_in);
+  }
+
+  /**
+   * @brief Get the communicator.
+   */
+  MPI_Comm communicator() const {
+    return m_comm;
+  }
+
+  /**
+   * @brief Get the planning policy.
+   */
+  const PlanningPolicy& policy() const {
+    return m_policy;
+  }
+
+  /**
+   * @brief Get the logical plane shape.
+   */
+  const Fits::Position<2>& logicalShape() const {
+    return m_shape;
+  }
+
+  /**
+   * @brief Get the input plane shape, without padding.
+   */
+  Fits::Position<2> inShape() const {
+    return Type::inShape(m_shape);
+  }
+
+  /**
+   * @brief Get the output plane shape, without padding.
+   */
+  Fits::Position<2> outShape() const {
+    return Type::outShape(m_shape);
+  }
+
+  /**
+   * @brief Get the index of the first row of the local slabs.
+   */
+  long firstRow() const {
+    return m_firstRow;
+  }
+
+  /**
+   * @brief Get the number of rows of the local slabs, which may be 0.
+   */
+  long localRows() const {
+    return m_rows[rank()];
+  }
+
+  /**
+   * @brief Access the local input slab, including the padding columns, if any.
+   */
+  Fits::PtrRaster<InValue> inSlab() {
+    return {{rowStride<InValue>(), localRows()}, static_cast<InValue*>(m_in.get())};
+  }
+
+  /**
+   * @brief Access the local output slab, including the padding columns, if any.
+   */
+  Fits::PtrRaster<OutValue> outSlab() {
+    return {{rowStride<OutValue>(), localRows()}, static_cast<OutValue*>(m_out.get())};
+  }
+
+  /**
+   * @brief Get the normalization factor.
+   */
+  double normalizationFactor() const {
+    return Type::normalizationFactor(m_shape, 1);
+  }
+
+  /**
+   * @brief Copy a plane of the root process to the input slabs.
+   * @param in The input plane, of the input shape, only read on the root process
+   * @param root The rank of the root process
+   * @details
+   * This is a collective operation.
+   */
+  template <typename TRaster>
+  MpiDftPlan& scatter(const TRaster& in, int root = 0) {
+    const long stride = rowStride<InValue>();
+    const auto shape = inShape();
+    checkShape(in, shape, root);
+    std::vector<InValue> padded;
+    const InValue* data = nullptr;
+    if (rank() == root) {
+      data = in.data();
+      if (stride != shape[0]) {
+        padded.resize(stride * shape[1]);
+        for (long y = 0; y < shape[1]; ++y) {
+          std::copy_n(in.data() + y * shape[0], shape[0], padded.data() + y * stride);
+        }
+        data = padded.data();
+      }
+    }
+    std::vector<int> counts;
+    std::vector<int> displacements;
+    distribution(counts, displacements);
+    const Mpi::ContiguousType row(stride * sizeof(InValue));
+    checkMpi(
+        MPI_Scatterv(
+            data,
+            counts.data(),
+            displacements.data(),
+            row.get(),
+            m_in.get(),
+            counts[rank()],
+            row.get(),
+            root,
+            m_comm),
+        "MPI_Scatterv");
+    return *this;
+  }
+
+  /**
+   * @brief Execute the transform, collectively.
+   * @details
+   * As for `DftPlan`, the input buffer may be overwritten (e.g. by inverse real transforms).
+   */
+  MpiDftPlan& transform() {
+    Mpi::execute<Real>(m_plan.get(), static_cast<InValue*>(m_in.get()), static_cast<OutValue*>(m_out.get()));
+    return *this;
+  }
+
+  /**
+   * @brief Multiply the local output slab by a factor.
+   */
+  MpiDftPlan& scale(Real factor) {
+    Real* data = static_cast<Real*>(m_out.get());
+    const long size = localRows() * rowStride<OutValue>() * sizeof(OutValue) / sizeof(Real);
+#pragma omp simd
+    for (long i = 0; i < size; ++i) {
+      data[i] *= factor;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Divide the local output slab by the normalization factor.
+   */
+  MpiDftPlan& normalize() {
+    return scale(Real(1) / static_cast<Real>(normalizationFactor()));
+  }
+
+  /**
+   * @brief Copy the output slabs to a plane of the root process.
+   * @param out The output plane, of the output shape, only written on the root process
+   * @param root The rank of the root process
+   * @details
+   * This is a collective operation.
+   */
+  template <typename TRaster>
+  const MpiDftPlan& gather(TRaster&& out, int root = 0) const {
+    const long stride = rowStride<OutValue>();
+    const auto shape = outShape();
+    checkShape(out, shape, root);
+    const bool isRoot = rank() == root;
+    const bool packed = stride == shape[0];
+    std::vector<OutValue> padded(isRoot && not packed ? stride * shape[1] : 0);
+    std::vector<int> counts;
+    std::vector<int> displacements;
+    distribution(counts, displacements);
+    const Mpi::ContiguousType row(stride * sizeof(OutValue));
+    checkMpi(
+        MPI_Gatherv(
+            m_out.get(),
+            counts[rank()],
+            row.get(),
+            packed ? static_cast<void*>(out.data()) : padded.data(),
+            counts.data(),
+            displacements.data(),
+            row.get(),
+            root,
+            m_comm),
+        "MPI_Gatherv");
+    if (isRoot && not packed) {
+      for (long y = 0; y < shape[1]; ++y) {
+        std::copy_n(padded.data() + y * stride, shape[0], out.data() + y * shape[0]);
+      }
+    }
+    return *this;
+  }
+
+private:
+  /**
+   * @brief Constructor over existing buffers, or allocating them if null.
+   */
+  MpiDftPlan(
+      const Fits::Position<2>& shape,
+      const PlanningPolicy& policy,
+      MPI_Comm comm,
+      std::shared_ptr<void> in,
+      std::shared_ptr<void> out) :
+      m_shape(shape),
+      m_policy(policy), m_comm(comm), m_width(std::min(inShape()[0], outShape()[0])), m_firstRow(0), m_rows(),
+      m_in(std::move(in)), m_out(std::move(out)), m_plan() {
+    Mpi::init<Real>();
+    int size = 0;
+    checkMpi(MPI_Comm_size(m_comm, &size), "MPI_Comm_size");
+    std::ptrdiff_t localRows = 0;
+    std::ptrdiff_t firstRow = 0;
+    const std::ptrdiff_t alloc = FftwMpiTraits<Real>::localSize2d(m_shape[1], m_width, m_comm, &localRows, &firstRow);
+    m_firstRow = firstRow;
+    m_rows.resize(size);
+    long local = localRows;
+    checkMpi(MPI_Allgather(&local, 1, MPI_LONG, m_rows.data(), 1, MPI_LONG, m_comm), "MPI_Allgather");
+    if (not m_in) {
+      m_in = allocate(alloc);
+      m_out = allocate(alloc);
+    }
+    std::lock_guard<std::mutex> lock(FftwPlanner::instance().mutex());
+    FftwTraits<Real>::planWithNthreads(m_policy.threads);
+    auto plan = Mpi::plan<Real>(
+        m_shape[1],
+        m_shape[0],
+        static_cast<InValue*>(m_in.get()),
+        static_cast<OutValue*>(m_out.get()),
+        m_comm,
+        Mpi::FftwSign<Type>::value,
+        m_policy.flags());
+    if (not plan) {
+      throw std::runtime_error("Cannot create FFTW-MPI plan");
+    }
+    m_plan = {plan, [](typename FftwMpiTraits<Real>::Plan p) {
+                std::lock_guard<std::mutex> lock(FftwPlanner::instance().mutex());
+                FftwTraits<Real>::destroyPlan(p);
+              }};
+  }
+
+  /**
+   * @brief Allocate a buffer of a given number of complex values.
+   */
+  static std::shared_ptr<void> allocate(std::ptrdiff_t alloc) {
+    const std::size_t bytes = sizeof(std::complex<Real>) * std::max<std::ptrdiff_t>(alloc, 1);
+    std::shared_ptr<void> buffer(FftwTraits<Real>::malloc(bytes), FftwTraits<Real>::free);
+    if (not buffer) {
+      throw std::runtime_error("Cannot allocate FFTW-MPI buffer");
+    }
+    return buffer;
+  }
+
+  /**
+   * @brief Get the rank of the process.
+   */
+  int rank() const {
+    int r = 0;
+    checkMpi(MPI_Comm_rank(m_comm, &r), "MPI_Comm_rank");
+    return r;
+  }
+
+  /**
+   * @brief Get the number of values per row of a buffer, i.e. the padded width for real buffers.
+   */
+  template <typename TValue>
+  long rowStride() const {
+    return std::is_same<TValue, Real>::value ? 2 * m_width : m_width;
+  }
+
+  /**
+   * @brief Compute the counts and displacements of the slabs, in rows, for `scatter()` and `gather()`.
+   * @details
+   * Throws if they do not fit in an `int`.
+   */
+  void distribution(std::vector<int>& counts, std::vector<int>& displacements) const {
+    counts.resize(m_rows.size());
+    displacements.resize(m_rows.size());
+    long offset = 0;
+    for (std::size_t r = 0; r < m_rows.size(); ++r) {
+      counts[r] = Mpi::toInt(m_rows[r], "Slab row count");
+      displacements[r] = Mpi::toInt(offset, "Slab row offset");
+      offset += m_rows[r];
+    }
+  }
+
+  /**
+   * @brief Check the shape of the plane of the root process, and throw on all the processes if it is invalid.
+   */
+  template <typename TRaster>
+  void checkShape(const TRaster& raster, const Fits::Position<2>& shape, int root) const {
+    int valid = 1;
+    if (rank() == root) {
+      valid = raster.shape()[0] == shape[0] && raster.shape()[1] == shape[1];
+    }
+    checkMpi(MPI_Bcast(&valid, 1, MPI_INT, root, m_comm), "MPI_Bcast");
+    if (not valid) {
+      throw std::invalid_argument(
+          "Root plane shape does not match plane shape " + std::to_string(shape[0]) + "x" + std::to_string(shape[1]));
+    }
+  }
+
+  /**
+   * @brief The logical plane shape.
+   */
+  Fits::Position<2> m_shape;
+
+  /**
+   * @brief The planning policy.
+   */
+  PlanningPolicy m_policy;
+
+  /**
+   * @brief The communicator.
+   */
+  MPI_Comm m_comm;
+
+  /**
+   * @brief The number of complex values per row.
+   */
+  long m_width;
+
+  /**
+   * @brief The first row of the local slabs.
+   */
+  long m_firstRow;
+
+  /**
+   * @brief The number of rows of the slabs of each process.
+   */
+  std::vector<long> m_rows;
+
+  /**
+   * @brief The local input slab.
+   */
+  std::shared_ptr<void> m_in;
+
+  /**
+   * @brief The local output slab.
+   */
+  std::shared_ptr<void> m_out;
+
+  /**
+   * @brief The FFTW-MPI plan.
+   */
+  std::shared_ptr<std::remove_pointer_t<typename FftwMpiTraits<Real>::Plan>> m_plan;
+};
+
+/**
+ * @brief Real DFT distributed with MPI.
+ */
+template <typename T>
+using BasicMpiRealDft = MpiDftPlan<BasicRealDftType<T>>;
+
+/**
+ * @brief Complex DFT distributed with MPI.
+ */
+template <typename T>
+using BasicMpiComplexDft = MpiDftPlan<BasicComplexDftType<T>>;
+
+/**
+ * @brief Double precision real DFT distributed with MPI.
+ */
+using MpiRealDft = BasicMpiRealDft<double>;
+
+/**
+ * @brief Double precision complex DFT distributed with MPI.
+ */
+using MpiComplexDft = BasicMpiComplexDft<double>;
+
+/**
+ * @brief Single precision real DFT distributed with MPI.
+ */
+using MpiRealDftF = BasicMpiRealDft<float>;
+
+/**
+ * @brief Single precision complex DFT distributed with MPI.
+ */
+using MpiComplexDftF = BasicMpiComplexDft<float>;
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,263 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_PLANSTATS_H
+#define _ELEFOURIER_PLANSTATS_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Thread-safe counters of the plans of a given key.
+ * @details
+ * Execution times are summed, and the most recent ones are kept (up to `sampleCapacity`) to estimate percentiles.
+ */
+class PlanCounters {
+
+public:
+  /**
+   * @brief The maximum number of execution times kept for percentiles.
+   */
+  static constexpr long sampleCapacity = 4096;
+
+  /**
+   * @brief A snapshot of the counters.
+   */
+  struct Summary {
+
+    /** @brief The number of plannings, i.e. of plans which were not shared from the planner cache. */
+    long plannings;
+
+    /** @brief The cumulative planning time, in seconds. */
+    double planningTime;
+
+    /** @brief The number of transforms. */
+    long transforms;
+
+    /** @brief The cumulative execution time, in seconds. */
+    double executeTime;
+
+    /** @brief The median execution time, in seconds. */
+    double p50;
+
+    /** @brief The 90th percentile of the execution time, in seconds. */
+    double p90;
+
+    /** @brief The 99th percentile of the execution time, in seconds. */
+    double p99;
+
+    /** @brief The cumulative number of bytes of the buffers read or written by the transforms. */
+    double bytes;
+
+    /** @brief The number of floating point operations per transform, as estimated by FFTW. */
+    double flops;
+
+    /** @brief Get the mean execution time, in seconds. */
+    double mean() const {
+      return transforms ? executeTime / transforms : 0;
+    }
+
+    /** @brief Get the throughput, in GFLOP/s. */
+    double gflops() const {
+      return executeTime > 0 ? flops * transforms / executeTime * 1.e-9 : 0;
+    }
+
+    /** @brief Get the bandwidth, in GB/s. */
+    double bandwidth() const {
+      return executeTime > 0 ? bytes / executeTime * 1.e-9 : 0;
+    }
+  };
+
+  /**
+   * @brief Constructor.
+   */
+  PlanCounters();
+
+  /**
+   * @brief Record a planning.
+   * @param seconds The planning time
+   * @param flops The number of floating point operations per transform
+   */
+  void recordPlanning(double seconds, double flops);
+
+  /**
+   * @brief Record a transform.
+   * @param seconds The execution time
+   * @param bytes The number of bytes of the input and output buffers
+   */
+  void recordTransform(double seconds, double bytes);
+
+  /**
+   * @brief Get a snapshot of the counters.
+   */
+  Summary summary() const;
+
+private:
+  /**
+   * @brief The mutex.
+   */
+  mutable std::mutex m_mutex;
+
+  /**
+   * @brief The counters.
+   */
+  Summary m_summary;
+
+  /**
+   * @brief The most recent execution times, as a circular buffer.
+   */
+  std::vector<double> m_samples;
+};
+
+/**
+ * @brief Process-wide registry of plan statistics.
+ * @details
+ * When the registry is enabled, each `DftPlan` and the planner report to the `PlanCounters` of their key
+ * (see `FftwWisdom::key()`):
+ * the planning time and the number of floating point operations (`fftw_flops()`) at planning,
+ * and the execution time and the number of bytes of the buffers at each transform.
+ * The statistics can be logged with `report()` or exported as JSON with `json()` or `save()`.
+ *
+ * The registry is disabled by default, in which case plans hold no counters,
+ * such that the overhead is a null pointer test per transform.
+ * It can be enabled programmatically, or without recompiling,
+ * by setting the environment variable `ELEFOURIER_PLAN_STATS` to the path of a JSON file,
+ * which is written at program ending:
+ * \code
+ * PlanStats::instance().enable(); // Or: export ELEFOURIER_PLAN_STATS=/path/to/stats.json
+ * RealDft dft(shape);
+ * dft.transform();
+ * logger.info() << PlanStats::instance().report();
+ * \endcode
+ *
+ * Only the plans created after enabling are instrumented.
+ */
+class PlanStats {
+private:
+  /**
+   * @brief Private constructor.
+   * @details
+   * Enables the registry if `ELEFOURIER_PLAN_STATS` is set.
+   */
+  PlanStats();
+
+public:
+  /**
+   * @brief Destructor.
+   * @details
+   * Writes the statistics to the autosave file, if any.
+   */
+  ~PlanStats();
+
+  /**
+   * @brief Get the singleton.
+   */
+  static PlanStats& instance();
+
+  /**
+   * @brief Enable the registry.
+   * @param filename The JSON file to be written at destruction, or an empty string
+   */
+  void enable(const std::string& filename = "");
+
+  /**
+   * @brief Disable the registry.
+   * @details
+   * The counters of the existing plans are kept and still updated, but new plans are not instrumented.
+   */
+  void disable();
+
+  /**
+   * @brief Check whether the registry is enabled.
+   * @details
+   * This is a relaxed atomic read.
+   */
+  bool enabled() const {
+    return m_enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the counters of a key, or `nullptr` if the registry is disabled.
+   * @details
+   * The counters are created if needed.
+   */
+  std::shared_ptr<PlanCounters> counters(const std::string& key);
+
+  /**
+   * @brief Get a snapshot of the counters of all keys.
+   */
+  std::map<std::string, PlanCounters::Summary> summaries() const;
+
+  /**
+   * @brief Get the statistics as a JSON object, keyed by plan key.
+   * @details
+   * Times are given in milliseconds.
+   */
+  std::string json() const;
+
+  /**
+   * @brief Get the statistics as a human-readable text, one line per plan key.
+   */
+  std::string report() const;
+
+  /**
+   * @brief Write the statistics to a JSON file.
+   */
+  void save(const std::string& filename) const;
+
+  /**
+   * @brief Forget all the counters.
+   * @details
+   * Existing plans keep updating their counters, which are not registered anymore.
+   */
+  void reset();
+
+private:
+  /**
+   * @brief The registry mutex.
+   */
+  mutable std::mutex m_mutex;
+
+  /**
+   * @brief The enabled flag.
+   */
+  std::atomic<bool> m_enabled;
+
+  /**
+   * @brief The autosave file name, or an empty string.
+   */
+  std::string m_filename;
+
+  /**
+   * @brief The counters, by key.
+   */
+  std::map<std::string, std::shared_ptr<PlanCounters>> m_counters;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
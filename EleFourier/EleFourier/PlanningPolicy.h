@@ -0,0 +1,228 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_PLANNINGPOLICY_H
+#define _ELEFOURIER_PLANNINGPOLICY_H
+
+#include <fftw3.h>
+#include <string>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Planning options of a `DftPlan`.
+ * @details
+ * The rigor selects the set of algorithms which are benchmarked by FFTW at planning time:
+ * the more transforms a plan is expected to execute, the more patient it should be planned.
+ * Short-lived jobs would rather go for `estimate()`, while long-running services can afford `exhaustive()`.
+ * The planning time can be bounded with `limit()`.
+ *
+ * By default, FFTW is free to overwrite the input buffer of out-of-place complex-to-real transforms.
+ * This can be prevented with `preserveInput()`, at the cost of performance
+ * (FFTW does not support it for multidimensional complex-to-real transforms, which then throw at planning).
+ *
+ * To halve the memory footprint, transforms can be computed in place with `inPlace()`:
+ * the input and output buffers of the `DftPlan` then share the same memory (see `DftPlan` for the buffer layout).
+ *
+ * Huge transforms (e.g. large shapes or deep stacks) can be executed by several threads
+ * using FFTW's internal multithreading, which is opt-in with `parallelize()`.
+ * This is not to be mixed with the execution of one plan per thread, e.g. in an OpenMP loop.
+ *
+ * \code
+ * RealDft dft(shape, count, PlanningPolicy::patient().limit(60));
+ * ComplexDft huge({4096, 4096}, 1, PlanningPolicy().parallelize()); // As many threads as OpenMP's default
+ * ComplexDft stack({1024, 1024}, 40, PlanningPolicy().inPlace()); // Single buffer
+ * \endcode
+ */
+struct PlanningPolicy {
+
+  /**
+   * @brief The planning rigor.
+   */
+  enum class Rigor
+  {
+    Estimate, ///< Heuristic plan, no measurement
+    Measure, ///< Measure a few algorithms
+    Patient, ///< Measure a wide range of algorithms
+    Exhaustive ///< Measure all the algorithms
+  };
+
+  /**
+   * @brief The input buffer policy.
+   */
+  enum class Input
+  {
+    Default, ///< Let FFTW decide
+    Preserve, ///< Never overwrite the input buffer
+    Destroy ///< Allow overwriting the input buffer
+  };
+
+  /**
+   * @brief The buffer placement.
+   */
+  enum class Placement
+  {
+    OutOfPlace, ///< Distinct input and output buffers
+    InPlace ///< Shared input and output buffers
+  };
+
+  /**
+   * @brief Constructor.
+   */
+  PlanningPolicy(Rigor r = Rigor::Measure, double seconds = FFTW_NO_TIMELIMIT, Input i = Input::Default) :
+      rigor(r), timeLimit(seconds), input(i), placement(Placement::OutOfPlace), threads(1) {}
+
+  /**
+   * @brief Create a policy with estimate rigor.
+   */
+  static PlanningPolicy estimate() {
+    return PlanningPolicy(Rigor::Estimate);
+  }
+
+  /**
+   * @brief Create a policy with measure rigor (the default).
+   */
+  static PlanningPolicy measure() {
+    return PlanningPolicy(Rigor::Measure);
+  }
+
+  /**
+   * @brief Create a policy with patient rigor.
+   */
+  static PlanningPolicy patient() {
+    return PlanningPolicy(Rigor::Patient);
+  }
+
+  /**
+   * @brief Create a policy with exhaustive rigor.
+   */
+  static PlanningPolicy exhaustive() {
+    return PlanningPolicy(Rigor::Exhaustive);
+  }
+
+  /**
+   * @brief Parse a rigor name, as returned by `name()`, case-sensitive.
+   */
+  static Rigor parseRigor(const std::string& name);
+
+  /**
+   * @brief Set the approximate planning time limit, in seconds.
+   */
+  PlanningPolicy& limit(double seconds) {
+    timeLimit = seconds;
+    return *this;
+  }
+
+  /**
+   * @brief Forbid overwriting the input buffer.
+   */
+  PlanningPolicy& preserveInput() {
+    input = Input::Preserve;
+    return *this;
+  }
+
+  /**
+   * @brief Allow overwriting the input buffer.
+   */
+  PlanningPolicy& destroyInput() {
+    input = Input::Destroy;
+    return *this;
+  }
+
+  /**
+   * @brief Compute the transform in place.
+   */
+  PlanningPolicy& inPlace() {
+    placement = Placement::InPlace;
+    return *this;
+  }
+
+  /**
+   * @brief Check whether the transform is computed in place.
+   */
+  bool isInPlace() const {
+    return placement == Placement::InPlace;
+  }
+
+  /**
+   * @brief Execute the transform with FFTW's internal multithreading.
+   * @param count The number of threads, or 0 to use OpenMP's maximum number of threads
+   * @details
+   * OpenMP's maximum number of threads is set by the `OMP_NUM_THREADS` environment variable
+   * or `omp_set_num_threads()`.
+   */
+  PlanningPolicy& parallelize(long count = 0);
+
+  /**
+   * @brief Get the FFTW planner flags.
+   */
+  unsigned flags() const;
+
+  /**
+   * @brief Get the policy name, e.g. to identify plans.
+   * @details
+   * The time limit does not appear in the name, and the number of threads only appears if greater than one.
+   */
+  std::string name() const;
+
+  /**
+   * @brief Check equality, time limit excluded.
+   */
+  bool operator==(const PlanningPolicy& rhs) const {
+    return rigor == rhs.rigor && input == rhs.input && placement == rhs.placement && threads == rhs.threads;
+  }
+
+  /**
+   * @brief Check inequality, time limit excluded.
+   */
+  bool operator!=(const PlanningPolicy& rhs) const {
+    return not(*this == rhs);
+  }
+
+  /**
+   * @brief The planning rigor.
+   */
+  Rigor rigor;
+
+  /**
+   * @brief The approximate planning time limit, in seconds, or `FFTW_NO_TIMELIMIT`.
+   */
+  double timeLimit;
+
+  /**
+   * @brief The input buffer policy.
+   */
+  Input input;
+
+  /**
+   * @brief The buffer placement.
+   */
+  Placement placement;
+
+  /**
+   * @brief The number of execution threads.
+   */
+  long threads;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,419 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_PRUNEDDFT_H
+#define _ELEFOURIER_PRUNEDDFT_H
+
+#include "EleFourier/DftPlan.h"
+
+#include <algorithm> // copy_n, fill_n, min
+#include <cmath> // log2
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Forward 2D DFT of zero-padded inputs, evaluated on a subsampled output grid.
+ * @tparam TType The full DFT type, i.e. `BasicComplexDftType<T>` or `BasicRealDftType<T>`
+ * @details
+ * The transform is that of a logical plane of shape `shape`,
+ * of which only a window of shape `windowShape` at position `windowFront` is nonzero,
+ * and of which only the coefficients `(stride * u, stride * v)` are computed.
+ * The user fills the window, of shape `windowShape`, instead of the whole plane.
+ *
+ * Both prunings are exact:
+ * - Output subsampling by `stride` is obtained by folding (aliasing) the plane modulo `shape / stride`,
+ *   followed by a DFT of shape `shape / stride`, which divides the transform cost by about `stride^2`;
+ * - Input pruning is obtained by staging the transform into row then column 1D DFTs
+ *   (see `BasicComplexAxisDftType`), the row DFTs being only computed for the nonzero rows.
+ *
+ * The output buffer is hence of shape `shape / stride`, or `(shape[0] / stride / 2 + 1, shape[1] / stride)`
+ * for real transforms, and coefficient `(u, v)` of the output buffer is coefficient `(stride * u, stride * v)`
+ * of the full transform.
+ * For example, for a 512-pixel wide pupil in a 1024-pixel wide mask, sampled each other frequency:
+ * \code
+ * PrunedComplexDft dft({1024, 1024}, {256, 256}, {512, 512}, 2);
+ * dft.window() = ... ; // Fill the 512x512 nonzero pixels
+ * const auto& amplitude = dft.transform().outBuffer(); // 512x512 coefficients
+ * \endcode
+ *
+ * The `stride` must divide both the width and height of the plane.
+ * Unlike for `DftPlan`, the window is preserved by `transform()`.
+ * Like for `DftPlan`, scaling is eager, or lazy on request.
+ */
+template <typename TType>
+class PrunedDft {
+
+public:
+  /**
+   * @brief The real value type, which sets the precision.
+   */
+  using Real = typename TType::Real;
+
+  /**
+   * @brief The input value type.
+   */
+  using InValue = typename TType::InValue;
+
+  /**
+   * @brief The output value type.
+   */
+  using OutValue = typename TType::OutValue;
+
+  static_assert(
+      std::is_same<TType, BasicComplexDftType<Real>>::value || std::is_same<TType, BasicRealDftType<Real>>::value,
+      "Only forward complex and real DFTs can be pruned");
+
+  /**
+   * @brief The row DFT plan type.
+   */
+  using RowDft = DftPlan<typename std::conditional<
+      std::is_same<InValue, Real>::value,
+      BasicRealAxisDftType<Real, 0>,
+      BasicComplexAxisDftType<Real, 0>>::type>;
+
+  /**
+   * @brief The column DFT plan type.
+   */
+  using ColumnDft = DftPlan<BasicComplexAxisDftType<Real, 1>>;
+
+  /**
+   * @brief Constructor.
+   * @param shape The logical plane shape
+   * @param windowFront The front position of the nonzero window
+   * @param windowShape The shape of the nonzero window
+   * @param stride The output subsampling factor
+   * @param count The number of planes
+   * @param policy The planning policy
+   */
+  PrunedDft(
+      const Fits::Position<2>& shape,
+      const Fits::Position<2>& windowFront,
+      const Fits::Position<2>& windowShape,
+      long stride = 1,
+      long count = 1,
+      const PlanningPolicy& policy = PlanningPolicy()) :
+      m_shape(shape), m_front(windowFront), m_stride(check(shape, windowFront, windowShape, stride)),
+      m_reduced {shape[0] / stride, shape[1] / stride}, m_window({windowShape[0], windowShape[1], count}),
+      m_rows({m_reduced[0], std::min(windowShape[1], m_reduced[1])}, count, policy),
+      m_columns({m_rows.outShape()[0], m_reduced[1]}, count, policy) {}
+
+  /**
+   * @brief Get the number of planes.
+   */
+  long count() const {
+    return m_window.shape()[2];
+  }
+
+  /**
+   * @brief Get the logical plane shape.
+   */
+  const Fits::Position<2>& logicalShape() const {
+    return m_shape;
+  }
+
+  /**
+   * @brief Get the front position of the nonzero window.
+   */
+  const Fits::Position<2>& windowFront() const {
+    return m_front;
+  }
+
+  /**
+   * @brief Get the shape of the nonzero window.
+   */
+  Fits::Position<2> windowShape() const {
+    return {m_window.shape()[0], m_window.shape()[1]};
+  }
+
+  /**
+   * @brief Get the output subsampling factor.
+   */
+  long stride() const {
+    return m_stride;
+  }
+
+  /**
+   * @brief Access the nonzero window of the input.
+   */
+  Fits::PtrRaster<InValue> window(long index = 0) {
+    return m_window.section(index);
+  }
+
+  /**
+   * @brief Access the whole input window stack.
+   */
+  Fits::PtrRaster<InValue, 3> windowStack() {
+    return {m_window.shape(), m_window.data()};
+  }
+
+  /**
+   * @brief Get the output buffer shape.
+   */
+  const Fits::Position<2>& outShape() const {
+    return m_columns.outShape();
+  }
+
+  /**
+   * @brief Access the output buffer.
+   * @details
+   * The values do not include the pending scale factor, if any (see `pendingScale()` and `flush()`).
+   */
+  const Fits::PtrRaster<const OutValue> outBuffer(long index = 0) const {
+    return m_columns.outBuffer(index);
+  }
+
+  /**
+   * @copydoc outBuffer()
+   */
+  Fits::PtrRaster<OutValue> outBuffer(long index = 0) {
+    return m_columns.outBuffer(index);
+  }
+
+  /**
+   * @brief Access the whole output stack.
+   * @copydetails outBuffer()
+   */
+  Fits::PtrRaster<OutValue, 3> outStack() {
+    return m_columns.outStack();
+  }
+
+  /**
+   * @brief Get the normalization factor of the full transform.
+   */
+  double normalizationFactor() const {
+    return TType::normalizationFactor(m_shape, count());
+  }
+
+  /**
+   * @brief Estimate the ratio of the pruned transform cost to the full transform cost.
+   * @details
+   * Costs are estimated as `n log2(n)` per 1D DFT of length `n`.
+   */
+  double costRatio() const {
+    const auto& rows = m_rows.logicalShape();
+    const double pruned = stagedCost(rows[0], rows[1], m_reduced[1], m_columns.logicalShape()[0]);
+    const double full = stagedCost(m_shape[0], m_shape[1], m_shape[1], TType::outShape(m_shape)[0]);
+    return pruned / full;
+  }
+
+  /**
+   * @brief Compute the transform.
+   * @details
+   * The window is folded into the row DFT input, the row DFTs are computed,
+   * and their output is scattered into the column DFT input, whose rows outside the window are zeroed.
+   */
+  PrunedDft& transform() {
+    fold();
+    m_rows.transform();
+    scatter();
+    m_columns.transform();
+    return *this;
+  }
+
+  /**
+   * @brief Normalize the output buffer by the factor of the full transform.
+   */
+  PrunedDft& normalize() {
+    return scale(Real(1) / normalizationFactor());
+  }
+
+  /**
+   * @brief Scale the output buffer.
+   * @details
+   * The pending scale factor, if any, is applied in the same pass.
+   */
+  PrunedDft& scale(Real factor) {
+    m_columns.scale(factor);
+    return *this;
+  }
+
+  /**
+   * @brief Normalize the output buffer, lazily, by the factor of the full transform.
+   */
+  PrunedDft& normalizeLazily() {
+    return scaleLazily(Real(1) / normalizationFactor());
+  }
+
+  /**
+   * @brief Scale the output buffer, lazily (see `DftPlan::scaleLazily()`).
+   */
+  PrunedDft& scaleLazily(Real factor) {
+    m_columns.scaleLazily(factor);
+    return *this;
+  }
+
+  /**
+   * @brief Get the pending scale factor of the output buffer.
+   */
+  Real pendingScale() const {
+    return m_columns.pendingScale();
+  }
+
+  /**
+   * @brief Apply the pending scale factor of the output buffer, if any (see `DftPlan::flush()`).
+   */
+  PrunedDft& flush() {
+    m_columns.flush();
+    return *this;
+  }
+
+private:
+  /**
+   * @brief Check the constructor parameters.
+   * @return The stride
+   */
+  static long check(
+      const Fits::Position<2>& shape,
+      const Fits::Position<2>& front,
+      const Fits::Position<2>& window,
+      long stride) {
+    if (stride < 1 || shape[0] % stride != 0 || shape[1] % stride != 0) {
+      throw std::invalid_argument(
+          "Stride " + std::to_string(stride) + " does not divide the plane shape " + std::to_string(shape[0]) + "x" +
+          std::to_string(shape[1]));
+    }
+    for (long i = 0; i < 2; ++i) {
+      if (front[i] < 0 || window[i] < 1 || front[i] + window[i] > shape[i]) {
+        throw std::invalid_argument("Window is empty or does not fit in the plane");
+      }
+    }
+    return stride;
+  }
+
+  /**
+   * @brief Estimate the cost of a row-column DFT.
+   */
+  double stagedCost(long width, long rows, long height, long columns) const {
+    const double rowFactor = std::is_same<InValue, Real>::value ? .5 : 1.; // Real row DFTs are half as costly
+    return rowFactor * rows * width * std::log2(width) + columns * height * std::log2(height);
+  }
+
+  /**
+   * @brief Fold the window into the row DFT input, modulo the reduced shape.
+   */
+  void fold() {
+    auto in = m_rows.inStack();
+    const long stride = in.shape()[0];
+    const long rowCount = in.shape()[1];
+    const long width = m_window.shape()[0];
+    const long height = m_window.shape()[1];
+    const long x0 = m_front[0] % m_reduced[0];
+    std::fill_n(in.data(), in.size(), InValue(0));
+    const auto* w = m_window.data();
+    for (long k = 0; k < count(); ++k) {
+      auto* plane = &in[{0, 0, k}];
+      for (long y = 0; y < height; ++y) {
+        auto* row = plane + (y % rowCount) * stride;
+        long x = x0;
+        for (long i = 0; i < width; ++i, ++w) {
+          row[x] += *w;
+          if (++x == m_reduced[0]) {
+            x = 0;
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Scatter the row DFT output into the column DFT input.
+   */
+  void scatter() {
+    const auto out = m_rows.outStack();
+    auto in = m_columns.inStack();
+    const long width = in.shape()[0];
+    const long height = in.shape()[1];
+    const long rowCount = m_rows.logicalShape()[1];
+    const long y0 = m_front[1] % height;
+    for (long k = 0; k < count(); ++k) {
+      for (long r = 0; r < rowCount; ++r) {
+        std::copy_n(&out[{0, r, k}], width, &in[{0, (y0 + r) % height, k}]);
+      }
+      for (long r = rowCount; r < height; ++r) {
+        std::fill_n(&in[{0, (y0 + r) % height, k}], width, OutValue(0));
+      }
+    }
+  }
+
+  /**
+   * @brief The logical plane shape.
+   */
+  Fits::Position<2> m_shape;
+
+  /**
+   * @brief The front position of the window.
+   */
+  Fits::Position<2> m_front;
+
+  /**
+   * @brief The output subsampling factor.
+   */
+  long m_stride;
+
+  /**
+   * @brief The folded plane shape.
+   */
+  Fits::Position<2> m_reduced;
+
+  /**
+   * @brief The nonzero window.
+   */
+  Fits::VecRaster<InValue, 3> m_window;
+
+  /**
+   * @brief The row DFTs, of the nonzero folded rows.
+   */
+  RowDft m_rows;
+
+  /**
+   * @brief The column DFTs.
+   */
+  ColumnDft m_columns;
+};
+
+/**
+ * @brief Pruned complex DFT.
+ */
+template <typename T>
+using BasicPrunedComplexDft = PrunedDft<BasicComplexDftType<T>>;
+
+/**
+ * @brief Pruned real DFT.
+ */
+template <typename T>
+using BasicPrunedRealDft = PrunedDft<BasicRealDftType<T>>;
+
+/**
+ * @brief Double precision pruned complex DFT.
+ */
+using PrunedComplexDft = BasicPrunedComplexDft<double>;
+
+/**
+ * @brief Double precision pruned real DFT.
+ */
+using PrunedRealDft = BasicPrunedRealDft<double>;
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,195 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_PUPILPHASE_H
+#define _ELEFOURIER_PUPILPHASE_H
+
+#include "EleFourier/SparsePupil.h"
+
+#include <algorithm> // fill_n
+#include <cmath> // cos, sin
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Pupil amplitude engine, which separates the wavelength-independent optical path difference (OPD)
+ * from the wavelength-dependent complex exponential.
+ * @details
+ * The OPD is computed once per set of Zernike coefficients, over the support of a `SparsePupil`,
+ * as a matrix-vector product of the compacted Zernike polynomials by the coefficients:
+ * \f[
+ * opd_i = \sum_j z_{i, j} \alpha_j
+ * \f]
+ * The amplitude of each wavelength is then `mask * exp(-2 i pi opd / lambda)`,
+ * computed with a branch-free `omp simd` loop of cosines and sines over the support spans,
+ * and written directly into the output plane (e.g. the input buffer of a `DftPlan`), which is zeroed elsewhere.
+ * For a set of wavelengths, the planes of a stack are filled in parallel (`omp parallel for`).
+ *
+ * \code
+ * SparsePupil sparse(mask, Zernike::ansiCube(side, alphaCount));
+ * PupilPhase phase(sparse);
+ * phase.evalOpd(alphas); // Once
+ * ComplexDft dft({side, side}, lambdas.size());
+ * phase.evalAmplitudes(lambdas, dft.inStack()); // One plane per wavelength
+ * dft.transform();
+ * \endcode
+ *
+ * The engine keeps a reference to the pupil, which must therefore outlive it.
+ */
+class PupilPhase {
+
+public:
+  /**
+   * @brief Constructor.
+   * @param pupil The pupil, with Zernike polynomials
+   */
+  explicit PupilPhase(const SparsePupil& pupil) : m_pupil(pupil), m_opd(pupil.size(), 0.) {
+    if (pupil.zernikeCount() == 0) {
+      throw std::invalid_argument("Pupil has no Zernike polynomials");
+    }
+  }
+
+  /**
+   * @brief Get the pupil.
+   */
+  const SparsePupil& pupil() const {
+    return m_pupil;
+  }
+
+  /**
+   * @brief Compute the OPD over the support for given Zernike coefficients.
+   * @param alphas The `pupil().zernikeCount()` Zernike coefficients
+   */
+  const std::vector<double>& evalOpd(const std::vector<double>& alphas) {
+    const long count = m_pupil.zernikeCount();
+    if (static_cast<long>(alphas.size()) != count) {
+      throw std::invalid_argument(
+          "Got " + std::to_string(alphas.size()) + " coefficients for " + std::to_string(count) + " polynomials");
+    }
+    const long size = m_pupil.size();
+    const double* z = m_pupil.zernike().data();
+    const double* a = alphas.data();
+    double* opd = m_opd.data();
+#pragma omp parallel for
+    for (long i = 0; i < size; ++i) {
+      const double* zi = z + i * count;
+      double sum = 0;
+#pragma omp simd reduction(+ : sum)
+      for (long j = 0; j < count; ++j) {
+        sum += zi[j] * a[j];
+      }
+      opd[i] = sum;
+    }
+    return m_opd;
+  }
+
+  /**
+   * @brief Get the last computed OPD over the support.
+   */
+  const std::vector<double>& opd() const {
+    return m_opd;
+  }
+
+  /**
+   * @brief Compute the amplitude at a given wavelength into a plane.
+   * @param lambda The wavelength, in the unit of the OPD
+   * @param plane The output plane, of complex values, whose rows may be padded
+   */
+  template <typename TRaster>
+  void evalAmplitude(double lambda, TRaster&& plane) const {
+    const long stride = plane.shape()[0];
+    checkPlane(stride, plane.shape()[1]);
+    evalPlane(lambda, plane.data(), stride);
+  }
+
+  /**
+   * @brief Compute the amplitudes at given wavelengths into the planes of a stack.
+   * @param lambdas The wavelengths, in the unit of the OPD
+   * @param stack The output stack, of complex values, with at least one plane per wavelength
+   */
+  template <typename TRaster>
+  void evalAmplitudes(const std::vector<double>& lambdas, TRaster&& stack) const {
+    const long stride = stack.shape()[0];
+    const long height = stack.shape()[1];
+    checkPlane(stride, height);
+    const long count = lambdas.size();
+    if (stack.size() < count * stride * height) {
+      throw std::invalid_argument("Stack has less planes than wavelengths");
+    }
+    auto* data = stack.data();
+#pragma omp parallel for
+    for (long k = 0; k < count; ++k) {
+      evalPlane(lambdas[k], data + k * stride * height, stride);
+    }
+  }
+
+private:
+  /**
+   * @brief Check the shape of an output plane.
+   */
+  void checkPlane(long stride, long height) const {
+    const auto& shape = m_pupil.shape();
+    if (stride < shape[0] || height != shape[1]) {
+      throw std::invalid_argument(
+          "Plane shape " + std::to_string(stride) + "x" + std::to_string(height) + " does not match pupil shape " +
+          std::to_string(shape[0]) + "x" + std::to_string(shape[1]));
+    }
+  }
+
+  /**
+   * @brief Compute the amplitude into a plane, given its row stride.
+   */
+  template <typename T>
+  void evalPlane(double lambda, std::complex<T>* plane, long stride) const {
+    const double factor = -2 * 3.14159265358979323846 / lambda;
+    std::fill_n(plane, stride * m_pupil.shape()[1], std::complex<T>(0));
+    const double* mask = m_pupil.values().data();
+    const double* opd = m_opd.data();
+    for (const auto& span : m_pupil.spans()) {
+      T* out = reinterpret_cast<T*>(plane + span.x + span.y * stride);
+      const long offset = span.offset;
+#pragma omp simd
+      for (long i = 0; i < span.size; ++i) {
+        const double phase = factor * opd[offset + i];
+        out[2 * i] = mask[offset + i] * std::cos(phase);
+        out[2 * i + 1] = mask[offset + i] * std::sin(phase);
+      }
+    }
+  }
+
+  /**
+   * @brief The pupil.
+   */
+  const SparsePupil& m_pupil;
+
+  /**
+   * @brief The OPD over the support.
+   */
+  std::vector<double> m_opd;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,153 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_SHIFT_H
+#define _ELEFOURIER_SHIFT_H
+
+#include "EleFourier/FftwTraits.h"
+#include "EleFourier/Kernels.h"
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+/**
+ * @file
+ * @brief Centering of DFT buffers, i.e. moving the origin (e.g. the zero frequency) to the center of the plane.
+ * @details
+ * Centering comes without an extra memory pass, in either of two ways:
+ * - `centerCrop()` is fused into the read of the output buffer,
+ *   e.g. when copying it to an image to be saved, and can crop and apply a pointwise function in the same pass;
+ * - `checkerboard()` multiplies the input by `(-1)^(x + y)`, which shifts the output by half the shape,
+ *   and can be applied once to a constant factor of the input, e.g. a pupil mask, for even shapes only.
+ *
+ * In both cases, the origin is moved to index `shape / 2` (integer division), like with NumPy's `fftshift()`.
+ * \code
+ * ComplexDft dft({width, height});
+ * ... // Fill dft.inBuffer()
+ * Fits::VecRaster<double> psf({width, height});
+ * centerCrop(dft.transform().outBuffer(), psf, Norm2()); // Centered intensity, for even or odd shapes
+ * \endcode
+ */
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Identity function object.
+ */
+struct Identity {
+
+  /** @brief Return the value. */
+  template <typename T>
+  const T& operator()(const T& value) const {
+    return value;
+  }
+};
+
+/**
+ * @brief Apply a function to contiguous values.
+ */
+template <typename TIn, typename TOut, typename TFunc>
+void transformData(const TIn* in, TOut* out, long size, TFunc&& func) {
+#pragma omp simd
+  for (long i = 0; i < size; ++i) {
+    out[i] = func(in[i]);
+  }
+}
+
+/**
+ * @brief Copy the centered window of a raster or stack, optionally through a pointwise function.
+ * @param in The input raster or stack, e.g. the output buffer of a complex DFT
+ * @param out The output raster or stack, not larger than `in` and with at most as many planes
+ * @param func The function applied to each value
+ * @details
+ * Value `in(0, 0)` is copied to `out(width / 2, height / 2)`, where `(width, height)` is the shape of `out`,
+ * and the input is read periodically, such that the output is the centered and cropped input.
+ * If the shapes are equal, this is NumPy's `fftshift()`, for even and odd sizes.
+ * Rows are copied in two contiguous segments each, in parallel (`omp parallel for`).
+ * Hermitian half planes (e.g. real DFT outputs) are not supported.
+ */
+template <typename TIn, typename TOut, typename TFunc = Identity>
+void centerCrop(const TIn& in, TOut&& out, TFunc&& func = TFunc()) {
+  const long inWidth = in.shape()[0];
+  const long inHeight = in.shape()[1];
+  const long width = out.shape()[0];
+  const long height = out.shape()[1];
+  if (width > inWidth || height > inHeight) {
+    throw std::invalid_argument(
+        "Crop shape " + std::to_string(width) + "x" + std::to_string(height) + " exceeds input shape " +
+        std::to_string(inWidth) + "x" + std::to_string(inHeight));
+  }
+  const long count = planeCount(out, width * height);
+  if (in.size() < inWidth * inHeight * count) {
+    throw std::invalid_argument("Input has less planes than output");
+  }
+  const long left = width / 2;
+  const long top = height / 2;
+  const long rows = height * count;
+  const auto* src = in.data();
+  auto* dst = out.data();
+#pragma omp parallel for if (rows > 1)
+  for (long r = 0; r < rows; ++r) {
+    const long k = r / height;
+    const long y = (r % height - top + inHeight) % inHeight;
+    const auto* i = src + (y + k * inHeight) * inWidth;
+    auto* o = dst + r * width;
+    transformData(i + inWidth - left, o, left, func); // Negative indices
+    transformData(i, o + left, width - left, func); // Nonnegative indices
+  }
+}
+
+/**
+ * @brief Multiply each plane of a raster or stack by `(-1)^(x + y)`.
+ * @details
+ * The DFT of the result is the DFT of the input shifted by half the shape, i.e. centered.
+ * As the modulation is linear, it can be applied once to a factor of the input which does not change across DFTs,
+ * e.g. to a pupil mask, which makes centering free.
+ * This is only exact for even shapes, and throws for odd ones (see `centerCrop()` instead).
+ */
+template <typename TRaster>
+void checkerboard(TRaster&& raster) {
+  const long width = raster.shape()[0];
+  const long height = raster.shape()[1];
+  if (width % 2 != 0 || height % 2 != 0) {
+    throw std::invalid_argument(
+        "Checkerboard modulation only centers even shapes, got " + std::to_string(width) + "x" +
+        std::to_string(height));
+  }
+  using Value = typename std::decay<decltype(*raster.data())>::type;
+  using Real = typename FftwReal<Value>::Type;
+  const long rows = height * planeCount(raster, width * height);
+  auto* data = raster.data();
+#pragma omp parallel for if (rows > 1)
+  for (long r = 0; r < rows; ++r) {
+    auto* row = data + r * width;
+    const long y = r % height;
+#pragma omp simd
+    for (long x = 0; x < width; ++x) {
+      row[x] *= Real(1 - 2 * ((x + y) & 1));
+    }
+  }
+}
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,247 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ELEFOURIER_SPARSEPUPIL_H
+#define _ELEFOURIER_SPARSEPUPIL_H
+
+#include "EleFitsData/Raster.h"
+
+#include <algorithm> // copy_n, fill_n
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Euclid {
+namespace Fourier {
+
+/**
+ * @brief Compressed support of a pupil mask, with the Zernike polynomials compacted to the support.
+ * @details
+ * The support, i.e. the set of points where the mask is not null, is stored as row spans,
+ * and the mask values and Zernike polynomials are stored densely, for the support points only, in span order.
+ * Functions of the pupil (e.g. the complex amplitude) can then be evaluated with dense, branch-free loops
+ * over the support, and scattered into a plane (e.g. the input buffer of a `DftPlan`),
+ * instead of looping over the whole mask and testing each point.
+ *
+ * \code
+ * SparsePupil sparse(mask, Zernike::ansiCube(side, alphaCount));
+ * std::vector<std::complex<double>> amplitude(sparse.size());
+ * const auto* z = sparse.zernike().data();
+ * for (long i = 0; i < sparse.size(); ++i, z += alphaCount) {
+ *   amplitude[i] = ... ; // Function of sparse.values()[i] and z[0] to z[alphaCount - 1]
+ * }
+ * sparse.scatter(amplitude.data(), dft.inBuffer()); // Zero outside the support
+ * \endcode
+ */
+class SparsePupil {
+
+public:
+  /**
+   * @brief A row span of the support.
+   */
+  struct Span {
+
+    /** @brief The row index. */
+    long y;
+
+    /** @brief The index of the first column. */
+    long x;
+
+    /** @brief The number of points. */
+    long size;
+
+    /** @brief The index of the first point in the dense arrays. */
+    long offset;
+  };
+
+  /**
+   * @brief Create a pupil from a mask.
+   * @param mask The mask, a contiguous 2D raster
+   */
+  template <typename TMask>
+  explicit SparsePupil(const TMask& mask) :
+      m_shape {mask.shape()[0], mask.shape()[1]}, m_spans(), m_values(), m_zernike(), m_zernikeCount(0) {
+    const auto* data = mask.data();
+    for (long y = 0; y < m_shape[1]; ++y) {
+      const auto* row = data + y * m_shape[0];
+      long x = 0;
+      while (x < m_shape[0]) {
+        if (row[x] == 0) {
+          ++x;
+          continue;
+        }
+        Span span {y, x, 0, static_cast<long>(m_values.size())};
+        for (; x < m_shape[0] && row[x] != 0; ++x) {
+          m_values.push_back(row[x]);
+        }
+        span.size = x - span.x;
+        m_spans.push_back(span);
+      }
+    }
+  }
+
+  /**
+   * @brief Create a pupil from a mask and compact the Zernike polynomials to its support.
+   * @param mask The mask, a contiguous 2D raster
+   * @param zernike The Zernike polynomials, a 3D raster of shape `(count, width, height)` (see `Zernike::ansiCube()`)
+   */
+  template <typename TMask, typename TCube>
+  SparsePupil(const TMask& mask, const TCube& zernike) : SparsePupil(mask) {
+    const auto& shape = zernike.shape();
+    if (shape[1] != m_shape[0] || shape[2] != m_shape[1]) {
+      throw std::invalid_argument(
+          "Zernike cube shape differs from mask shape " + std::to_string(m_shape[0]) + "x" +
+          std::to_string(m_shape[1]));
+    }
+    m_zernikeCount = shape[0];
+    m_zernike.resize(size() * m_zernikeCount);
+    auto* dst = m_zernike.data();
+    for (const auto& span : m_spans) {
+      const auto* src = zernike.data() + (span.x + span.y * m_shape[0]) * m_zernikeCount;
+      dst = std::copy_n(src, span.size * m_zernikeCount, dst);
+    }
+  }
+
+  /**
+   * @brief Get the mask shape.
+   */
+  const Fits::Position<2>& shape() const {
+    return m_shape;
+  }
+
+  /**
+   * @brief Get the number of support points.
+   */
+  long size() const {
+    return m_values.size();
+  }
+
+  /**
+   * @brief Get the ratio of support points to mask points.
+   */
+  double fillFactor() const {
+    return double(size()) / (m_shape[0] * m_shape[1]);
+  }
+
+  /**
+   * @brief Get the row spans.
+   */
+  const std::vector<Span>& spans() const {
+    return m_spans;
+  }
+
+  /**
+   * @brief Get the mask values over the support.
+   */
+  const std::vector<double>& values() const {
+    return m_values;
+  }
+
+  /**
+   * @brief Get the number of Zernike polynomials, or 0 if they were not provided.
+   */
+  long zernikeCount() const {
+    return m_zernikeCount;
+  }
+
+  /**
+   * @brief Get the Zernike polynomials over the support.
+   * @details
+   * For each support point `i`, the polynomials are contiguous, from index `i * zernikeCount()`.
+   */
+  const std::vector<double>& zernike() const {
+    return m_zernike;
+  }
+
+  /**
+   * @brief Write dense support values into a plane, and zeros elsewhere.
+   * @param values The `size()` values, in span order
+   * @param plane The output plane, whose rows may be padded (e.g. for in-place real DFTs)
+   */
+  template <typename T, typename TRaster>
+  void scatter(const T* values, TRaster&& plane) const {
+    const long stride = checkStride(plane);
+    auto* data = plane.data();
+    using Value = typename std::decay<decltype(*data)>::type;
+    std::fill_n(data, stride * m_shape[1], Value(0));
+    for (const auto& span : m_spans) {
+      std::copy_n(values + span.offset, span.size, data + span.x + span.y * stride);
+    }
+  }
+
+  /**
+   * @brief Read the support values of a plane.
+   * @param plane The input plane, whose rows may be padded
+   * @param values The `size()` output values, in span order
+   */
+  template <typename TRaster, typename T>
+  void gather(const TRaster& plane, T* values) const {
+    const long stride = checkStride(plane);
+    const auto* data = plane.data();
+    for (const auto& span : m_spans) {
+      std::copy_n(data + span.x + span.y * stride, span.size, values + span.offset);
+    }
+  }
+
+private:
+  /**
+   * @brief Check that a plane can hold the mask and get its row stride.
+   */
+  template <typename TRaster>
+  long checkStride(const TRaster& plane) const {
+    const long stride = plane.shape()[0];
+    if (stride < m_shape[0] || plane.shape()[1] != m_shape[1]) {
+      throw std::invalid_argument(
+          "Plane shape " + std::to_string(plane.shape()[0]) + "x" + std::to_string(plane.shape()[1]) +
+          " does not match mask shape " + std::to_string(m_shape[0]) + "x" + std::to_string(m_shape[1]));
+    }
+    return stride;
+  }
+
+  /**
+   * @brief The mask shape.
+   */
+  Fits::Position<2> m_shape;
+
+  /**
+   * @brief The row spans.
+   */
+  std::vector<Span> m_spans;
+
+  /**
+   * @brief The mask values over the support.
+   */
+  std::vector<double> m_values;
+
+  /**
+   * @brief The Zernike polynomials over the support.
+   */
+  std::vector<double> m_zernike;
+
+  /**
+   * @brief The number of Zernike polynomials.
+   */
+  long m_zernikeCount;
+};
+
+} // namespace Fourier
+} // namespace Euclid
+
+#endif
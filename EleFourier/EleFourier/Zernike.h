@@ -25,6 +25,7 @@
 #include <algorithm> // copy_n
 #include <array>
 #include <limits> // NaN
+#include <string>
 #include <utility> // index_sequence
 
 namespace Euclid {
@@ -77,7 +78,7 @@ struct LocalZernikeSeries {
  * The axes are ordered as (lambda, u, v) for performance:
  * for each point, indices are contiguous in memory.
  */
-Fits::VecRaster<double, 3> ansiCube(long side, long count) {
+inline Fits::VecRaster<double, 3> ansiCube(long side, long count) {
   const Fits::Position<3> shape = {count, side, side};
   const double radius = 0.5 * side;
   Fits::VecRaster<double, 3> zernike(shape);
@@ -90,11 +91,64 @@ Fits::VecRaster<double, 3> ansiCube(long side, long count) {
   return zernike;
 }
 
+/**
+ * @brief The radial and azimuthal orders of a Zernike polynomial.
+ */
+struct AnsiOrders {
+
+  /** @brief The radial order. */
+  long n;
+
+  /** @brief The azimuthal order, from `-n` to `n`. */
+  long m;
+};
+
+/**
+ * @brief Get the orders of an ANSI index.
+ */
+AnsiOrders ansiOrders(long j);
+
+/**
+ * @brief Get the ANSI index of given orders.
+ */
+long ansiIndex(long n, long m);
+
+/**
+ * @brief Generate Zernike polynomials of any order for each ANSI index over a square domain.
+ * @param side The domain side
+ * @param count The number of indices
+ * @details
+ * The output is that of `ansiCube()`, i.e. the axes are ordered as (index, u, v),
+ * the polynomials are not normalized, and they are null outside the unit disk.
+ * Unlike `ansiCube()`, the number of indices is not bounded, and only the `count` first indices are computed:
+ * the radial polynomials are obtained with the recurrence
+ * \f$R_n^m(\rho) = \rho (R_{n-1}^{|m-1|}(\rho) + R_{n-1}^{m+1}(\rho)) - R_{n-2}^m(\rho)\f$,
+ * and the azimuthal factors with the Chebyshev recurrences of \f$\cos(m \theta)\f$ and \f$\sin(m \theta)\f$.
+ * Rows are processed in parallel (`omp parallel for`), and each recurrence is a vectorized loop over a row.
+ */
+Fits::VecRaster<double, 3> ansiBasis(long side, long count);
+
+/**
+ * @brief Get the cache file name of `ansiBasis()`.
+ */
+std::string ansiBasisFilename(long side, long count, const std::string& directory);
+
+/**
+ * @brief Read the output of `ansiBasis()` from a cache directory, or generate and cache it.
+ * @param side The domain side
+ * @param count The number of indices
+ * @param directory The cache directory
+ * @details
+ * The cube is cached as a FITS file named after `side` and `count` (see `ansiBasisFilename()`).
+ * If the file does not exist or the shape of its image differs, the cube is generated and the file is (over)written.
+ */
+Fits::VecRaster<double, 3> cachedAnsiBasis(long side, long count, const std::string& directory);
+
 // Precompute first polynomials
 
 #define DEF_ZERNIKE(J, expr) \
   template <> \
-  double LocalZernikeSeries::ansi<J>() const { \
+  inline double LocalZernikeSeries::ansi<J>() const { \
     if (x2 + y2 > 1) { \
       return nan; \
     } \
@@ -127,13 +181,13 @@ DEF_ZERNIKE(14, x4 - 6 * x2 * y2 + y4)
 DEF_ZERNIKE(15, x5 - 10 * x3 * y2 + 5 * x1 * y4)
 DEF_ZERNIKE(16, 4 * x3 - 12 * x1 * y2 - 5 * x5 + 10 * x3 * y2 + 15 * x1 * y4)
 DEF_ZERNIKE(17, 3 * x1 - 12 * x3 - 12 * x1 * y2 + 10 * x5 + 20 * x3 * y2 + 10 * x1 * y4)
-DEF_ZERNIKE(18, 3 * y1 - 12 * y3 - 12 * x2 * y1 + 10 * y5 + 20 * x2 * y3 - 15 * x4 * y1)
+DEF_ZERNIKE(18, 3 * y1 - 12 * y3 - 12 * x2 * y1 + 10 * y5 + 20 * x2 * y3 + 10 * x4 * y1)
 DEF_ZERNIKE(19, -4 * y3 + 12 * x2 * y1 + 5 * y5 - 10 * x2 * y3 - 15 * x4 * y1)
 DEF_ZERNIKE(20, y5 - 10 * x2 * y3 + 5 * x4 * y1)
 // 6
 DEF_ZERNIKE(21, 6 * x5 * y1 - 20 * x3 * y3 + 6 * x1 * y5)
 DEF_ZERNIKE(22, 20 * x3 * y1 - 20 * x1 * y3 - 24 * x5 * y1 + 24 * x1 * y5)
-DEF_ZERNIKE(23, 12 * x1 * y1 - 40 * x3 * y1 - 40 * x1 * y3 + 30 * x5 * y1 + 60 * x3 * y3 - 30 * x1 * y5)
+DEF_ZERNIKE(23, 12 * x1 * y1 - 40 * x3 * y1 - 40 * x1 * y3 + 30 * x5 * y1 + 60 * x3 * y3 + 30 * x1 * y5)
 DEF_ZERNIKE(
     24,
     -1 + 12 * x2 + 12 * y2 - 30 * x4 - 60 * x2 * y2 - 30 * y4 + 20 * x6 + 60 * x4 * y2 + 60 * x2 * y4 + 20 * y6)
@@ -157,20 +211,22 @@ DEF_ZERNIKE(
         105 * x4 * y3 + 35 * x6 * y1)
 DEF_ZERNIKE(
     33,
-    30 * y3 - 30 * x2 * y1 - 30 * y5 + 60 * x2 * y3 + 90 * x4 * y1 + 21 * y7 - 21 * x2 * y5 - 105 * x4 * y3 +
+    10 * y3 - 30 * x2 * y1 - 30 * y5 + 60 * x2 * y3 + 90 * x4 * y1 + 21 * y7 - 21 * x2 * y5 - 105 * x4 * y3 -
         63 * x6 * y1)
 DEF_ZERNIKE(34, -6 * y5 + 60 * x2 * y3 - 30 * x4 * y1 + 7 * y7 - 63 * x2 * y5 - 35 * x4 * y3 + 35 * x6 * y1)
-DEF_ZERNIKE(35, x7 - 21 * x2 * y5 + 35 * x4 * y3 - 7 * x6 * y1)
+DEF_ZERNIKE(35, y7 - 21 * x2 * y5 + 35 * x4 * y3 - 7 * x6 * y1)
 // 8
 DEF_ZERNIKE(36, -8 * x7 * y1 + 56 * x5 * y3 - 56 * x3 * y5 + 8 * x1 * y7)
-DEF_ZERNIKE(37, -42 * x5 * y1 + 140 * x3 * y3 - 42 * x1 * y5 + 48 * x7 * y1 - 112 * x5 * y3 + 48 * x1 * y7)
+DEF_ZERNIKE(
+    37,
+    -42 * x5 * y1 + 140 * x3 * y3 - 42 * x1 * y5 + 48 * x7 * y1 - 112 * x5 * y3 - 112 * x3 * y5 + 48 * x1 * y7)
 DEF_ZERNIKE(
     38,
     -60 * x3 * y1 + 60 * x1 * y3 + 168 * x5 * y1 - 168 * x1 * y5 - 112 * x7 * y1 - 112 * x5 * y3 + 112 * x3 * y5 +
         112 * x1 * y7)
 DEF_ZERNIKE(
     39,
-    -20 * x1 * y1 + 120 * x3 * y1 + 120 * x1 * y3 - 210 * x5 * y1 - 420 * x3 * y3 - 210 * x1 * y5 - 112 * x7 * y1 +
+    -20 * x1 * y1 + 120 * x3 * y1 + 120 * x1 * y3 - 210 * x5 * y1 - 420 * x3 * y3 - 210 * x1 * y5 + 112 * x7 * y1 +
         336 * x5 * y3 + 336 * x3 * y5 + 112 * x1 * y7)
 DEF_ZERNIKE(
     40,
@@ -0,0 +1,190 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/GpuKernels.h"
+
+#include <algorithm> // min
+#include <cuda_runtime.h>
+#include <stdexcept>
+#include <string>
+
+namespace Euclid {
+namespace Fourier {
+namespace Gpu {
+
+namespace {
+
+/**
+ * @brief The number of threads per block.
+ */
+constexpr int blockSize = 256;
+
+/**
+ * @brief Throw a `std::runtime_error` if a CUDA call failed.
+ * @details
+ * Kernel launches do not return a status: `cudaGetLastError()` reports invalid configurations right after them.
+ */
+void checkCuda(cudaError_t status, const std::string& call) {
+  if (status != cudaSuccess) {
+    throw std::runtime_error(call + " failed: " + cudaGetErrorString(status));
+  }
+}
+
+/**
+ * @brief Compute the number of blocks of a grid-stride loop.
+ */
+int gridSize(long size) {
+  return static_cast<int>(std::min<long>((size + blockSize - 1) / blockSize, 65535));
+}
+
+template <typename T>
+__global__ void scaleKernel(T* data, long size, T factor) {
+  for (long i = blockIdx.x * blockDim.x + threadIdx.x; i < size; i += blockDim.x * gridDim.x) {
+    data[i] *= factor;
+  }
+}
+
+template <typename T>
+__global__ void accumulateKernel(const T* data, T* acc, long size) {
+  for (long i = blockIdx.x * blockDim.x + threadIdx.x; i < size; i += blockDim.x * gridDim.x) {
+    acc[i] += data[i];
+  }
+}
+
+template <typename T>
+__global__ void norm2Kernel(const T* in, T* out, long size, T factor) {
+  const T factor2 = factor * factor;
+  for (long i = blockIdx.x * blockDim.x + threadIdx.x; i < size; i += blockDim.x * gridDim.x) {
+    const T re = in[2 * i];
+    const T im = in[2 * i + 1];
+    out[i] = (re * re + im * im) * factor2;
+  }
+}
+
+template <typename T>
+__global__ void pupilAmplitudeKernel(
+    const long* indices,
+    const double* mask,
+    const double* opd,
+    long support,
+    double factor,
+    T* plane) {
+  for (long i = blockIdx.x * blockDim.x + threadIdx.x; i < support; i += blockDim.x * gridDim.x) {
+    double s;
+    double c;
+    sincos(factor * opd[i], &s, &c);
+    const long j = 2 * indices[i];
+    plane[j] = static_cast<T>(mask[i] * c);
+    plane[j + 1] = static_cast<T>(mask[i] * s);
+  }
+}
+
+template <typename T>
+void launchScale(T* data, long size, T factor) {
+  if (size > 0) {
+    scaleKernel<<<gridSize(size), blockSize>>>(data, size, factor);
+    checkCuda(cudaGetLastError(), "scaleKernel");
+  }
+}
+
+template <typename T>
+void launchAccumulate(const T* data, T* acc, long size) {
+  if (size > 0) {
+    accumulateKernel<<<gridSize(size), blockSize>>>(data, acc, size);
+    checkCuda(cudaGetLastError(), "accumulateKernel");
+  }
+}
+
+template <typename T>
+void launchNorm2(const std::complex<T>* in, T* out, long size, T factor) {
+  if (size > 0) {
+    norm2Kernel<<<gridSize(size), blockSize>>>(reinterpret_cast<const T*>(in), out, size, factor);
+    checkCuda(cudaGetLastError(), "norm2Kernel");
+  }
+}
+
+template <typename T>
+void launchPupilAmplitude(
+    const long* indices,
+    const double* mask,
+    const double* opd,
+    long support,
+    double factor,
+    std::complex<T>* plane) {
+  if (support > 0) {
+    pupilAmplitudeKernel<<<gridSize(support), blockSize>>>(
+        indices,
+        mask,
+        opd,
+        support,
+        factor,
+        reinterpret_cast<T*>(plane));
+    checkCuda(cudaGetLastError(), "pupilAmplitudeKernel");
+  }
+}
+
+} // namespace
+
+void scale(float* data, long size, float factor) {
+  launchScale(data, size, factor);
+}
+
+void scale(double* data, long size, double factor) {
+  launchScale(data, size, factor);
+}
+
+void accumulate(const float* data, float* acc, long size) {
+  launchAccumulate(data, acc, size);
+}
+
+void accumulate(const double* data, double* acc, long size) {
+  launchAccumulate(data, acc, size);
+}
+
+void norm2(const std::complex<float>* in, float* out, long size, float factor) {
+  launchNorm2(in, out, size, factor);
+}
+
+void norm2(const std::complex<double>* in, double* out, long size, double factor) {
+  launchNorm2(in, out, size, factor);
+}
+
+void pupilAmplitude(
+    const long* indices,
+    const double* mask,
+    const double* opd,
+    long support,
+    double factor,
+    std::complex<float>* plane) {
+  launchPupilAmplitude(indices, mask, opd, support, factor, plane);
+}
+
+void pupilAmplitude(
+    const long* indices,
+    const double* mask,
+    const double* opd,
+    long support,
+    double factor,
+    std::complex<double>* plane) {
+  launchPupilAmplitude(indices, mask, opd, support, factor, plane);
+}
+
+} // namespace Gpu
+} // namespace Fourier
+} // namespace Euclid
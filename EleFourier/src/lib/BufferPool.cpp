@@ -0,0 +1,126 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/BufferPool.h"
+
+#include <cstring> // memset
+#include <iterator> // next
+#include <new> // bad_alloc
+
+namespace Euclid {
+namespace Fourier {
+
+constexpr std::size_t BufferPool::defaultCapacity;
+
+BufferPool::BufferPool(std::size_t capacity, bool firstTouch) :
+    m_mutex(), m_capacity(capacity), m_firstTouch(firstTouch), m_cached(0), m_hits(0), m_misses(0), m_free(),
+    m_deleters() {}
+
+BufferPool::~BufferPool() {
+  purge();
+}
+
+std::shared_ptr<BufferPool> BufferPool::local() {
+  thread_local auto pool = std::make_shared<BufferPool>();
+  return pool;
+}
+
+std::size_t BufferPool::capacity() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_capacity;
+}
+
+void BufferPool::capacity(std::size_t bytes) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_capacity = bytes;
+  shrink(m_capacity);
+}
+
+std::size_t BufferPool::cachedBytes() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_cached;
+}
+
+long BufferPool::hits() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_hits;
+}
+
+long BufferPool::misses() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_misses;
+}
+
+void BufferPool::purge() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  shrink(0);
+}
+
+void* BufferPool::allocate(std::size_t index, std::size_t bytes, void* (*allocator)(std::size_t), Deleter deleter) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_deleters[index] = deleter;
+    auto it = m_free.find({index, bytes});
+    if (it != m_free.end() && not it->second.empty()) {
+      void* data = it->second.back();
+      it->second.pop_back();
+      m_cached -= bytes;
+      ++m_hits;
+      return data;
+    }
+    ++m_misses;
+  }
+  void* data = allocator(bytes);
+  if (not data && bytes > 0) {
+    throw std::bad_alloc();
+  }
+  if (m_firstTouch) {
+    std::memset(data, 0, bytes); // First touch by the allocating thread
+  }
+  return data;
+}
+
+void BufferPool::release(std::size_t index, std::size_t bytes, void* data) {
+  if (not data) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_cached + bytes > m_capacity) {
+    m_deleters.at(index)(data);
+    return;
+  }
+  m_free[{index, bytes}].push_back(data);
+  m_cached += bytes;
+}
+
+void BufferPool::shrink(std::size_t capacity) {
+  for (auto it = m_free.begin(); it != m_free.end() && m_cached > capacity;) {
+    auto& buffers = it->second;
+    const auto deleter = m_deleters.at(it->first.first);
+    while (not buffers.empty() && m_cached > capacity) {
+      deleter(buffers.back());
+      buffers.pop_back();
+      m_cached -= it->first.second;
+    }
+    it = buffers.empty() ? m_free.erase(it) : std::next(it);
+  }
+}
+
+} // namespace Fourier
+} // namespace Euclid
@@ -0,0 +1,235 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/DftGraph.h"
+
+#include <algorithm> // lower_bound
+#include <atomic>
+#include <exception>
+#include <omp.h>
+#include <stdexcept>
+
+namespace Euclid {
+namespace Fourier {
+
+TaskPool::TaskPool(long threads) : m_mutex(), m_condition(), m_queue(), m_stop(false), m_threads() {
+  const long count = threads > 0 ? threads : omp_get_max_threads();
+  for (long i = 0; i < count; ++i) {
+    m_threads.emplace_back(&TaskPool::work, this);
+  }
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_condition.notify_all();
+  for (auto& t : m_threads) {
+    t.join();
+  }
+}
+
+void TaskPool::post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.push_back(std::move(task));
+  }
+  m_condition.notify_one();
+}
+
+void TaskPool::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_condition.wait(lock, [&]() {
+        return m_stop || not m_queue.empty();
+      });
+      if (m_queue.empty()) {
+        return; // Stopped and drained
+      }
+      task = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+    task();
+  }
+}
+
+struct DftGraph::Run {
+
+  /** @brief Constructor. */
+  Run(long size, long i) : pending(size), remaining(size), failed(false), error(), mutex(), done(), index(i) {}
+
+  /** @brief The number of uncompleted dependencies, by node. */
+  std::vector<std::atomic<long>> pending;
+
+  /** @brief The number of uncompleted nodes. */
+  std::atomic<long> remaining;
+
+  /** @brief The failure flag. */
+  std::atomic<bool> failed;
+
+  /** @brief The first exception. */
+  std::exception_ptr error;
+
+  /** @brief The exception mutex. */
+  std::mutex mutex;
+
+  /** @brief The completion promise. */
+  std::promise<void> done;
+
+  /** @brief The index passed to the tasks. */
+  long index;
+};
+
+long DftGraph::add(
+    const std::string& name,
+    Task task,
+    const std::vector<const void*>& reads,
+    const std::vector<const void*>& writes) {
+  const long node = m_nodes.size();
+  m_nodes.push_back({name, std::move(task), {}, {}});
+  for (const auto* buffer : reads) {
+    auto& access = m_accesses[buffer];
+    depend(node, access.writer);
+    access.readers.push_back(node);
+  }
+  for (const auto* buffer : writes) {
+    auto& access = m_accesses[buffer];
+    depend(node, access.writer);
+    for (auto r : access.readers) {
+      depend(node, r);
+    }
+    access.writer = node;
+    access.readers.clear();
+  }
+  return node;
+}
+
+void DftGraph::after(long node, long dependency) {
+  if (node < 0 || node >= size() || dependency < 0 || dependency >= node) {
+    throw std::invalid_argument(
+        "Invalid dependency of node " + std::to_string(node) + " on node " + std::to_string(dependency));
+  }
+  depend(node, dependency);
+}
+
+void DftGraph::depend(long node, long dependency) {
+  if (dependency < 0 || dependency == node) {
+    return;
+  }
+  auto& dependencies = m_nodes[node].dependencies;
+  const auto it = std::lower_bound(dependencies.begin(), dependencies.end(), dependency);
+  if (it != dependencies.end() && *it == dependency) {
+    return;
+  }
+  dependencies.insert(it, dependency);
+  m_nodes[dependency].successors.push_back(node);
+}
+
+std::future<void> DftGraph::run(TaskPool& pool, long index) const {
+  const long count = size();
+  auto state = std::make_shared<Run>(count, index);
+  auto future = state->done.get_future();
+  if (count == 0) {
+    state->done.set_value();
+    return future;
+  }
+  for (long n = 0; n < count; ++n) {
+    state->pending[n] = m_nodes[n].dependencies.size();
+  }
+  for (long n = 0; n < count; ++n) {
+    if (m_nodes[n].dependencies.empty()) {
+      pool.submit([this, &pool, state, n]() {
+        execute(pool, state, n);
+      });
+    }
+  }
+  return future;
+}
+
+void DftGraph::execute(TaskPool& pool, const std::shared_ptr<Run>& run, long node) const {
+  const auto& n = m_nodes[node];
+  if (not run->failed) {
+    try {
+      n.task(run->index);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(run->mutex);
+      if (not run->error) {
+        run->error = std::current_exception();
+      }
+      run->failed = true; // Skip the nodes which have not started yet
+    }
+  }
+  for (auto s : n.successors) {
+    if (--run->pending[s] == 0) {
+      pool.submit([this, &pool, run, s]() {
+        execute(pool, run, s);
+      });
+    }
+  }
+  if (--run->remaining == 0) {
+    if (run->error) {
+      run->done.set_exception(run->error);
+    } else {
+      run->done.set_value();
+    }
+  }
+}
+
+long DftGraph::stream(TaskPool& pool, const std::vector<DftGraph>& graphs, long count) {
+  if (graphs.empty()) {
+    throw std::invalid_argument("No graphs to stream through");
+  }
+  const long slots = graphs.size();
+  std::vector<std::future<void>> futures(slots);
+  std::exception_ptr error;
+  long k = 0;
+  for (; k < count; ++k) {
+    auto& future = futures[k % slots];
+    if (future.valid()) {
+      try {
+        future.get();
+      } catch (...) {
+        error = std::current_exception();
+        break;
+      }
+    }
+    future = graphs[k % slots].run(pool, k);
+  }
+  for (auto& future : futures) {
+    if (future.valid()) {
+      try {
+        future.get();
+      } catch (...) {
+        if (not error) {
+          error = std::current_exception();
+        }
+      }
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return k;
+}
+
+} // namespace Fourier
+} // namespace Euclid
@@ -19,128 +19,481 @@
 
 #include "EleFourier/DftType.h"
 
+#include "EleFourier/Kernels.h"
+
+#include <array>
+#include <stdexcept>
+
 namespace Euclid {
 namespace Fourier {
 
-template <>
-Fits::Position<2> RealDftType::Parent::outShape(const Fits::Position<2>& shape) {
-  return {shape[0] / 2 + 1, shape[1]};
+namespace {
+
+template <typename T>
+typename FftwTraits<T>::Complex* fftwData(Fits::PtrRaster<std::complex<T>, 3>& raster) {
+  return reinterpret_cast<typename FftwTraits<T>::Complex*>(raster.data());
+}
+
+template <typename T>
+T* fftwData(Fits::PtrRaster<T, 3>& raster) {
+  return raster.data();
 }
 
-template <>
-fftw_plan initFftwPlan<RealDftType>(Fits::PtrRaster<double, 3>& in, Fits::PtrRaster<std::complex<double>, 3>& out) {
-  const auto& shape = in.shape();
-  const int width = static_cast<int>(shape[0]);
-  const int height = static_cast<int>(shape[1]);
-  int n[] = {height, width}; // FFTW ordering
-  return fftw_plan_many_dft_r2c(
+template <typename T>
+int planeSize(const Fits::PtrRaster<T, 3>& raster) {
+  return static_cast<int>(raster.shape()[0] * raster.shape()[1]);
+}
+
+template <typename T>
+typename FftwTraits<T>::Plan initR2cPlan(
+    const Fits::Position<2>& shape,
+    Fits::PtrRaster<T, 3>& in,
+    Fits::PtrRaster<std::complex<T>, 3>& out,
+    unsigned flags) {
+  int n[] = {static_cast<int>(shape[1]), static_cast<int>(shape[0])}; // FFTW ordering
+  int inembed[] = {static_cast<int>(in.shape()[1]), static_cast<int>(in.shape()[0])}; // Padded if in place
+  int onembed[] = {static_cast<int>(out.shape()[1]), static_cast<int>(out.shape()[0])};
+  return FftwTraits<T>::planManyDftR2c(
       2, // rank
       n, // n
-      shape[2], // howmany
-      reinterpret_cast<double*>(in.data()), // in
-      nullptr, // inembed
+      in.shape()[2], // howmany
+      fftwData(in), // in
+      inembed, // inembed
       1, // istride
-      width * height, // idist
-      reinterpret_cast<fftw_complex*>(out.data()), // out
-      nullptr, // onembed
+      planeSize(in), // idist
+      fftwData(out), // out
+      onembed, // onembed
       1, // ostride
-      (width / 2 + 1) * height, // odist
-      FFTW_MEASURE); // FIXME other flags?
+      planeSize(out), // odist
+      flags);
 }
 
-template <>
-fftw_plan
-initFftwPlan<Inverse<RealDftType>>(Fits::PtrRaster<std::complex<double>, 3>& in, Fits::PtrRaster<double, 3>& out) {
-  const auto& shape = out.shape();
-  const int width = static_cast<int>(shape[0]);
-  const int height = static_cast<int>(shape[1]);
-  int n[] = {height, width}; // FFTW ordering
-  return fftw_plan_many_dft_c2r(
+template <typename T>
+typename FftwTraits<T>::Plan initC2rPlan(
+    const Fits::Position<2>& shape,
+    Fits::PtrRaster<std::complex<T>, 3>& in,
+    Fits::PtrRaster<T, 3>& out,
+    unsigned flags) {
+  int n[] = {static_cast<int>(shape[1]), static_cast<int>(shape[0])}; // FFTW ordering
+  int inembed[] = {static_cast<int>(in.shape()[1]), static_cast<int>(in.shape()[0])};
+  int onembed[] = {static_cast<int>(out.shape()[1]), static_cast<int>(out.shape()[0])}; // Padded if in place
+  return FftwTraits<T>::planManyDftC2r(
       2, // rank
       n, // n
-      shape[2], // howmany
-      reinterpret_cast<fftw_complex*>(in.data()), // in
-      nullptr, // inembed
+      out.shape()[2], // howmany
+      fftwData(in), // in
+      inembed, // inembed
       1, // istride
-      (width / 2 + 1) * height, // idist
-      reinterpret_cast<double*>(out.data()), // out
-      nullptr, // onembed
+      planeSize(in), // idist
+      fftwData(out), // out
+      onembed, // onembed
       1, // ostride
-      width * height, // odist
-      FFTW_MEASURE); // FIXME other flags?
+      planeSize(out), // odist
+      flags);
 }
 
-template <>
-fftw_plan initFftwPlan<ComplexDftType>(
-    Fits::PtrRaster<std::complex<double>, 3>& in,
-    Fits::PtrRaster<std::complex<double>, 3>& out) {
-  const auto& shape = in.shape();
-  const int width = static_cast<int>(shape[0]);
-  const int height = static_cast<int>(shape[1]);
-  int n[] = {height, width}; // FFTW ordering
-  return fftw_plan_many_dft(
+template <typename T>
+typename FftwTraits<T>::Plan initC2cPlan(
+    const Fits::Position<2>& shape,
+    Fits::PtrRaster<std::complex<T>, 3>& in,
+    Fits::PtrRaster<std::complex<T>, 3>& out,
+    int sign,
+    unsigned flags) {
+  int n[] = {static_cast<int>(shape[1]), static_cast<int>(shape[0])}; // FFTW ordering
+  return FftwTraits<T>::planManyDft(
       2, // rank
       n,
-      shape[2], // howmany,
-      reinterpret_cast<fftw_complex*>(in.data()), // in
+      in.shape()[2], // howmany,
+      fftwData(in), // in
       nullptr, // inembed
       1, // istride
-      width * height, // idist
-      reinterpret_cast<fftw_complex*>(out.data()), // out
+      planeSize(in), // idist
+      fftwData(out), // out
       nullptr, // onembed
       1, // ostride
-      width * height, // odist
-      FFTW_FORWARD, // sign
-      FFTW_MEASURE); // FIXME other flags?
+      planeSize(out), // odist
+      sign, // sign
+      flags);
 }
 
-template <>
-fftw_plan initFftwPlan<Inverse<ComplexDftType>>(
-    Fits::PtrRaster<std::complex<double>, 3>& in,
-    Fits::PtrRaster<std::complex<double>, 3>& out) {
-  const auto& shape = out.shape();
-  const int width = static_cast<int>(shape[0]);
-  const int height = static_cast<int>(shape[1]);
-  int n[] = {height, width}; // FFTW ordering
-  return fftw_plan_many_dft(
-      2, // rank
-      n,
-      shape[2], // howmany,
-      reinterpret_cast<fftw_complex*>(in.data()), // in
-      nullptr, // inembed
-      1, // istride
-      width * height, // idist
-      reinterpret_cast<fftw_complex*>(out.data()), // out
-      nullptr, // onembed
-      1, // ostride
-      width * height, // odist
-      FFTW_BACKWARD, // sign
-      FFTW_MEASURE); // FIXME other flags?
+template <typename T>
+Fits::Position<2> planeShape(const Fits::PtrRaster<T, 3>& raster) {
+  return {raster.shape()[0], raster.shape()[1]};
+}
+
+/**
+ * @brief Make the guru dimensions of a transform along one axis.
+ * @details
+ * The first dimension is the transform axis, the next ones are the loops over the other axis and the planes.
+ * Strides are in number of values of the respective buffers.
+ */
+template <typename T, typename TIn, typename TOut>
+std::array<typename FftwTraits<T>::IoDim, 3>
+axisDims(long axis, const Fits::Position<2>& shape, const TIn& in, const TOut& out) {
+  const int inWidth = static_cast<int>(in.shape()[0]);
+  const int outWidth = static_cast<int>(out.shape()[0]);
+  std::array<typename FftwTraits<T>::IoDim, 3> dims;
+  dims[0] = {static_cast<int>(shape[axis]), axis ? inWidth : 1, axis ? outWidth : 1};
+  dims[1] = {static_cast<int>(shape[1 - axis]), axis ? 1 : inWidth, axis ? 1 : outWidth};
+  dims[2] = {static_cast<int>(in.shape()[2]), planeSize(in), planeSize(out)};
+  return dims;
+}
+
+template <typename T>
+typename FftwTraits<T>::Plan initAxisC2cPlan(
+    long axis,
+    const Fits::Position<2>& shape,
+    Fits::PtrRaster<std::complex<T>, 3>& in,
+    Fits::PtrRaster<std::complex<T>, 3>& out,
+    int sign,
+    unsigned flags) {
+  const auto dims = axisDims<T>(axis, shape, in, out);
+  return FftwTraits<T>::planGuruDft(1, &dims[0], 2, &dims[1], fftwData(in), fftwData(out), sign, flags);
+}
+
+void checkAxisPlacement(long axis, const void* in, const void* out) {
+  if (axis != 0 && in == out) {
+    throw std::invalid_argument("In-place real DFTs are only supported along the rows");
+  }
+}
+
+template <typename T>
+typename FftwTraits<T>::Plan initAxisR2cPlan(
+    long axis,
+    const Fits::Position<2>& shape,
+    Fits::PtrRaster<T, 3>& in,
+    Fits::PtrRaster<std::complex<T>, 3>& out,
+    unsigned flags) {
+  checkAxisPlacement(axis, in.data(), out.data());
+  const auto dims = axisDims<T>(axis, shape, in, out);
+  return FftwTraits<T>::planGuruDftR2c(1, &dims[0], 2, &dims[1], fftwData(in), fftwData(out), flags);
 }
 
-template <>
-Fits::Position<2> HermitianComplexDftType::Parent::inShape(const Fits::Position<2>& shape) {
-  return {shape[0] / 2 + 1, shape[1]};
+template <typename T>
+typename FftwTraits<T>::Plan initAxisC2rPlan(
+    long axis,
+    const Fits::Position<2>& shape,
+    Fits::PtrRaster<std::complex<T>, 3>& in,
+    Fits::PtrRaster<T, 3>& out,
+    unsigned flags) {
+  checkAxisPlacement(axis, in.data(), out.data());
+  auto dims = axisDims<T>(axis, shape, in, out);
+  dims[2].n = static_cast<int>(out.shape()[2]);
+  return FftwTraits<T>::planGuruDftC2r(1, &dims[0], 2, &dims[1], fftwData(in), fftwData(out), flags);
 }
 
-template <>
-Fits::Position<2> HermitianComplexDftType::Parent::outShape(const Fits::Position<2>& shape) {
-  return {shape[0] / 2 + 1, shape[1]};
+template <typename T>
+typename FftwTraits<T>::Plan initStackC2cPlan(
+    const Fits::Position<2>& shape,
+    Fits::PtrRaster<std::complex<T>, 3>& in,
+    Fits::PtrRaster<std::complex<T>, 3>& out,
+    int sign,
+    unsigned flags) {
+  const int count = static_cast<int>(in.shape()[2]);
+  int n[] = {count, static_cast<int>(shape[1]), static_cast<int>(shape[0])}; // FFTW ordering
+  int inembed[] = {count, static_cast<int>(in.shape()[1]), static_cast<int>(in.shape()[0])};
+  int onembed[] = {count, static_cast<int>(out.shape()[1]), static_cast<int>(out.shape()[0])};
+  return FftwTraits<T>::planManyDft(3, n, 1, fftwData(in), inembed, 1, 0, fftwData(out), onembed, 1, 0, sign, flags);
 }
 
-template <>
-fftw_plan initFftwPlan<HermitianComplexDftType>(
-    Fits::PtrRaster<std::complex<double>, 3>& in,
-    Fits::PtrRaster<std::complex<double>, 3>& out) {
-  return initFftwPlan<ComplexDftType>(in, out);
+template <typename T>
+typename FftwTraits<T>::Plan initStackR2cPlan(
+    const Fits::Position<2>& shape,
+    Fits::PtrRaster<T, 3>& in,
+    Fits::PtrRaster<std::complex<T>, 3>& out,
+    unsigned flags) {
+  const int count = static_cast<int>(in.shape()[2]);
+  int n[] = {count, static_cast<int>(shape[1]), static_cast<int>(shape[0])}; // FFTW ordering
+  int inembed[] = {count, static_cast<int>(in.shape()[1]), static_cast<int>(in.shape()[0])}; // Padded if in place
+  int onembed[] = {count, static_cast<int>(out.shape()[1]), static_cast<int>(out.shape()[0])};
+  return FftwTraits<T>::planManyDftR2c(3, n, 1, fftwData(in), inembed, 1, 0, fftwData(out), onembed, 1, 0, flags);
 }
 
-template <>
-fftw_plan initFftwPlan<Inverse<HermitianComplexDftType>>(
-    Fits::PtrRaster<std::complex<double>, 3>& in,
-    Fits::PtrRaster<std::complex<double>, 3>& out) {
-  return initFftwPlan<Inverse<ComplexDftType>>(in, out);
+template <typename T>
+typename FftwTraits<T>::Plan initStackC2rPlan(
+    const Fits::Position<2>& shape,
+    Fits::PtrRaster<std::complex<T>, 3>& in,
+    Fits::PtrRaster<T, 3>& out,
+    unsigned flags) {
+  const int count = static_cast<int>(out.shape()[2]);
+  int n[] = {count, static_cast<int>(shape[1]), static_cast<int>(shape[0])}; // FFTW ordering
+  int inembed[] = {count, static_cast<int>(in.shape()[1]), static_cast<int>(in.shape()[0])};
+  int onembed[] = {count, static_cast<int>(out.shape()[1]), static_cast<int>(out.shape()[0])}; // Padded if in place
+  return FftwTraits<T>::planManyDftC2r(3, n, 1, fftwData(in), inembed, 1, 0, fftwData(out), onembed, 1, 0, flags);
 }
 
+} // namespace
+
+#define DEF_DFT_TYPE_SPECIALIZATIONS(T) \
+  template <> \
+  FftwPlan<BasicRealDftType<T>> initFftwPlan<BasicRealDftType<T>>( \
+      const Fits::Position<2>& shape, \
+      Fits::PtrRaster<T, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return initR2cPlan(shape, in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<BasicRealDftType<T>> initFftwPlan<BasicRealDftType<T>>( \
+      Fits::PtrRaster<T, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return initFftwPlan<BasicRealDftType<T>>(planeShape(in), in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<Inverse<BasicRealDftType<T>>> initFftwPlan<Inverse<BasicRealDftType<T>>>( \
+      const Fits::Position<2>& shape, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<T, 3> & out, \
+      unsigned flags) { \
+    return initC2rPlan(shape, in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<Inverse<BasicRealDftType<T>>> initFftwPlan<Inverse<BasicRealDftType<T>>>( \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<T, 3> & out, \
+      unsigned flags) { \
+    return initFftwPlan<Inverse<BasicRealDftType<T>>>(planeShape(out), in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<BasicComplexDftType<T>> initFftwPlan<BasicComplexDftType<T>>( \
+      const Fits::Position<2>& shape, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return initC2cPlan(shape, in, out, FFTW_FORWARD, flags); \
+  } \
+  template <> \
+  FftwPlan<BasicComplexDftType<T>> initFftwPlan<BasicComplexDftType<T>>( \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return initFftwPlan<BasicComplexDftType<T>>(planeShape(in), in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<Inverse<BasicComplexDftType<T>>> initFftwPlan<Inverse<BasicComplexDftType<T>>>( \
+      const Fits::Position<2>& shape, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return initC2cPlan(shape, in, out, FFTW_BACKWARD, flags); \
+  } \
+  template <> \
+  FftwPlan<Inverse<BasicComplexDftType<T>>> initFftwPlan<Inverse<BasicComplexDftType<T>>>( \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return initFftwPlan<Inverse<BasicComplexDftType<T>>>(planeShape(in), in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<BasicHermitianComplexDftType<T>> initFftwPlan<BasicHermitianComplexDftType<T>>( \
+      const Fits::Position<2>& shape, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<T, 3> & out, \
+      unsigned flags) { \
+    return initC2rPlan(shape, in, out, flags); /* Of the conjugated input */ \
+  } \
+  template <> \
+  FftwPlan<BasicHermitianComplexDftType<T>> initFftwPlan<BasicHermitianComplexDftType<T>>( \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<T, 3> & out, \
+      unsigned flags) { \
+    return initFftwPlan<BasicHermitianComplexDftType<T>>(planeShape(out), in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<Inverse<BasicHermitianComplexDftType<T>>> initFftwPlan<Inverse<BasicHermitianComplexDftType<T>>>( \
+      const Fits::Position<2>& shape, \
+      Fits::PtrRaster<T, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return initR2cPlan(shape, in, out, flags); /* Conjugated after execution */ \
+  } \
+  template <> \
+  FftwPlan<Inverse<BasicHermitianComplexDftType<T>>> initFftwPlan<Inverse<BasicHermitianComplexDftType<T>>>( \
+      Fits::PtrRaster<T, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return initFftwPlan<Inverse<BasicHermitianComplexDftType<T>>>(planeShape(in), in, out, flags); \
+  } \
+  template <> \
+  void executeFftwPlan<BasicRealDftType<T>>( \
+      FftwPlan<BasicRealDftType<T>> plan, \
+      Fits::PtrRaster<T, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out) { \
+    FftwTraits<T>::executeDftR2c(plan, fftwData(in), fftwData(out)); \
+  } \
+  template <> \
+  void executeFftwPlan<Inverse<BasicRealDftType<T>>>( \
+      FftwPlan<Inverse<BasicRealDftType<T>>> plan, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<T, 3> & out) { \
+    FftwTraits<T>::executeDftC2r(plan, fftwData(in), fftwData(out)); \
+  } \
+  template <> \
+  void executeFftwPlan<BasicComplexDftType<T>>( \
+      FftwPlan<BasicComplexDftType<T>> plan, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out) { \
+    FftwTraits<T>::executeDft(plan, fftwData(in), fftwData(out)); \
+  } \
+  template <> \
+  void executeFftwPlan<Inverse<BasicComplexDftType<T>>>( \
+      FftwPlan<Inverse<BasicComplexDftType<T>>> plan, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out) { \
+    FftwTraits<T>::executeDft(plan, fftwData(in), fftwData(out)); \
+  } \
+  template <> \
+  void executeFftwPlan<BasicHermitianComplexDftType<T>>( \
+      FftwPlan<BasicHermitianComplexDftType<T>> plan, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<T, 3> & out) { \
+    conjugateData(in.data(), in.size()); \
+    FftwTraits<T>::executeDftC2r(plan, fftwData(in), fftwData(out)); \
+  } \
+  template <> \
+  void executeFftwPlan<Inverse<BasicHermitianComplexDftType<T>>>( \
+      FftwPlan<Inverse<BasicHermitianComplexDftType<T>>> plan, \
+      Fits::PtrRaster<T, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out) { \
+    FftwTraits<T>::executeDftR2c(plan, fftwData(in), fftwData(out)); \
+    conjugateData(out.data(), out.size()); \
+  }
+
+DEF_DFT_TYPE_SPECIALIZATIONS(float)
+DEF_DFT_TYPE_SPECIALIZATIONS(double)
+DEF_DFT_TYPE_SPECIALIZATIONS(long double)
+
+#undef DEF_DFT_TYPE_SPECIALIZATIONS
+
+/**
+ * @brief Define the plan initialization and execution of complex and real types from the planning functions.
+ * @param T The real value type
+ * @param TC The complex type
+ * @param TR The real type
+ * @param C2C The complex initialization function, which takes the sign as 4th argument
+ * @param R2C The real initialization function
+ * @param C2R The inverse real initialization function
+ * @param ... The leading arguments of the initialization functions, if any
+ */
+#define DEF_GENERIC_DFT_TYPE_SPECIALIZATIONS(T, TC, TR, C2C, R2C, C2R, ...) \
+  template <> \
+  FftwPlan<TC> initFftwPlan<TC>( \
+      const Fits::Position<2>& shape, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return C2C(__VA_ARGS__ shape, in, out, FFTW_FORWARD, flags); \
+  } \
+  template <> \
+  FftwPlan<TC> initFftwPlan<TC>( \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return initFftwPlan<TC>(planeShape(in), in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<Inverse<TC>> initFftwPlan<Inverse<TC>>( \
+      const Fits::Position<2>& shape, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return C2C(__VA_ARGS__ shape, in, out, FFTW_BACKWARD, flags); \
+  } \
+  template <> \
+  FftwPlan<Inverse<TC>> initFftwPlan<Inverse<TC>>( \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return initFftwPlan<Inverse<TC>>(planeShape(in), in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<TR> initFftwPlan<TR>( \
+      const Fits::Position<2>& shape, \
+      Fits::PtrRaster<T, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out, \
+      unsigned flags) { \
+    return R2C(__VA_ARGS__ shape, in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<TR> initFftwPlan<TR>(Fits::PtrRaster<T, 3> & in, Fits::PtrRaster<std::complex<T>, 3> & out, unsigned flags) { \
+    return initFftwPlan<TR>(planeShape(in), in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<Inverse<TR>> initFftwPlan<Inverse<TR>>( \
+      const Fits::Position<2>& shape, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<T, 3> & out, \
+      unsigned flags) { \
+    return C2R(__VA_ARGS__ shape, in, out, flags); \
+  } \
+  template <> \
+  FftwPlan<Inverse<TR>> initFftwPlan<Inverse<TR>>( \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<T, 3> & out, \
+      unsigned flags) { \
+    return initFftwPlan<Inverse<TR>>(planeShape(out), in, out, flags); \
+  } \
+  template <> \
+  void executeFftwPlan<TC>( \
+      FftwPlan<TC> plan, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out) { \
+    FftwTraits<T>::executeDft(plan, fftwData(in), fftwData(out)); \
+  } \
+  template <> \
+  void executeFftwPlan<Inverse<TC>>( \
+      FftwPlan<Inverse<TC>> plan, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<std::complex<T>, 3> & out) { \
+    FftwTraits<T>::executeDft(plan, fftwData(in), fftwData(out)); \
+  } \
+  template <> \
+  void executeFftwPlan<TR>(FftwPlan<TR> plan, Fits::PtrRaster<T, 3> & in, Fits::PtrRaster<std::complex<T>, 3> & out) { \
+    FftwTraits<T>::executeDftR2c(plan, fftwData(in), fftwData(out)); \
+  } \
+  template <> \
+  void executeFftwPlan<Inverse<TR>>( \
+      FftwPlan<Inverse<TR>> plan, \
+      Fits::PtrRaster<std::complex<T>, 3> & in, \
+      Fits::PtrRaster<T, 3> & out) { \
+    FftwTraits<T>::executeDftC2r(plan, fftwData(in), fftwData(out)); \
+  }
+
+#define SINGLE_ARG(...) __VA_ARGS__
+
+#define DEF_AXIS_AND_STACK_DFT_TYPE_SPECIALIZATIONS(T) \
+  DEF_GENERIC_DFT_TYPE_SPECIALIZATIONS( \
+      T, \
+      SINGLE_ARG(BasicComplexAxisDftType<T, 0>), \
+      SINGLE_ARG(BasicRealAxisDftType<T, 0>), \
+      initAxisC2cPlan, \
+      initAxisR2cPlan, \
+      initAxisC2rPlan, \
+      0, ) \
+  DEF_GENERIC_DFT_TYPE_SPECIALIZATIONS( \
+      T, \
+      SINGLE_ARG(BasicComplexAxisDftType<T, 1>), \
+      SINGLE_ARG(BasicRealAxisDftType<T, 1>), \
+      initAxisC2cPlan, \
+      initAxisR2cPlan, \
+      initAxisC2rPlan, \
+      1, ) \
+  DEF_GENERIC_DFT_TYPE_SPECIALIZATIONS( \
+      T, \
+      BasicComplexStackDftType<T>, \
+      BasicRealStackDftType<T>, \
+      initStackC2cPlan, \
+      initStackR2cPlan, \
+      initStackC2rPlan, )
+
+DEF_AXIS_AND_STACK_DFT_TYPE_SPECIALIZATIONS(float)
+DEF_AXIS_AND_STACK_DFT_TYPE_SPECIALIZATIONS(double)
+DEF_AXIS_AND_STACK_DFT_TYPE_SPECIALIZATIONS(long double)
+
+#undef SINGLE_ARG
+#undef DEF_AXIS_AND_STACK_DFT_TYPE_SPECIALIZATIONS
+#undef DEF_GENERIC_DFT_TYPE_SPECIALIZATIONS
+
 } // namespace Fourier
-} // namespace Euclid
\ No newline at end of file
+} // namespace Euclid
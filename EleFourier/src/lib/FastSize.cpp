@@ -0,0 +1,62 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/FastSize.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace Euclid {
+namespace Fourier {
+
+bool isFastSize(long size) {
+  if (size <= 0) {
+    return false;
+  }
+  for (long factor : {2, 3, 5, 7}) {
+    while (size % factor == 0) {
+      size /= factor;
+    }
+  }
+  return size == 1;
+}
+
+long fastSize(long min) {
+  if (min <= 0) {
+    throw std::invalid_argument("Nonpositive size: " + std::to_string(min));
+  }
+  long size = min;
+  while (not isFastSize(size)) {
+    ++size; // 7-smooth numbers are dense enough for a linear search
+  }
+  return size;
+}
+
+std::vector<long> fastSizes(long min, long max) {
+  std::vector<long> sizes;
+  for (long size = min > 0 ? min : 1; size <= max; ++size) {
+    if (isFastSize(size)) {
+      sizes.push_back(size);
+    }
+  }
+  return sizes;
+}
+
+} // namespace Fourier
+} // namespace Euclid
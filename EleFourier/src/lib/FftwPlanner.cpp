@@ -0,0 +1,55 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/FftwPlanner.h"
+
+namespace Euclid {
+namespace Fourier {
+
+FftwPlanner::FftwPlanner() : m_mutex(), m_plans() {
+  FftwGlobalsCleaner::instantiate(); // Ensure FFTW's globals outlive the planner
+}
+
+FftwPlanner& FftwPlanner::instance() {
+  static FftwPlanner planner;
+  return planner;
+}
+
+std::mutex& FftwPlanner::mutex() {
+  return m_mutex;
+}
+
+long FftwPlanner::size() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  purge();
+  return m_plans.size();
+}
+
+void FftwPlanner::purge() {
+  for (auto it = m_plans.begin(); it != m_plans.end();) {
+    if (it->second.expired()) {
+      it = m_plans.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+} // namespace Fourier
+} // namespace Euclid
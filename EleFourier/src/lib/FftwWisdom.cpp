@@ -0,0 +1,138 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/FftwWisdom.h"
+
+#include "EleFourier/FftwPlanner.h"
+
+#include <boost/filesystem.hpp>
+#include <unistd.h> // gethostname
+
+namespace Euclid {
+namespace Fourier {
+
+FftwWisdom::FftwWisdom() : m_mutex(), m_directory(), m_autosave(false), m_loaded(), m_new() {
+  FftwPlanner::instance(); // Ensure the planner and FFTW's globals outlive the registry, which saves at destruction
+}
+
+FftwWisdom::~FftwWisdom() {
+  if (m_autosave) {
+    save();
+  }
+}
+
+FftwWisdom& FftwWisdom::instance() {
+  static FftwWisdom registry;
+  return registry;
+}
+
+std::string FftwWisdom::hostname() {
+  char name[256] = {0};
+  if (gethostname(name, sizeof(name) - 1) != 0) {
+    return "localhost";
+  }
+  return name;
+}
+
+void FftwWisdom::enable(const std::string& directory, bool autosave) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  boost::filesystem::create_directories(boost::filesystem::path(directory) / hostname());
+  m_directory = directory;
+  m_autosave = autosave;
+}
+
+void FftwWisdom::disable() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_directory.clear();
+  m_autosave = false;
+  m_new.clear();
+}
+
+bool FftwWisdom::enabled() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return not m_directory.empty();
+}
+
+std::string FftwWisdom::directory() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_directory;
+}
+
+std::string
+FftwWisdom::key(const std::string& type, const Fits::Position<2>& shape, long count, const PlanningPolicy& policy) {
+  return type + "_" + std::to_string(shape[0]) + "x" + std::to_string(shape[1]) + "x" + std::to_string(count) + "_" +
+      policy.name();
+}
+
+std::string FftwWisdom::filename(const std::string& key) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return (boost::filesystem::path(m_directory) / hostname() / (key + ".wisdom")).string();
+}
+
+bool FftwWisdom::load(const std::string& key, WisdomIo importer) {
+  if (not enabled()) {
+    return false;
+  }
+  const auto path = filename(key);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_loaded.count(key)) {
+    return true;
+  }
+  if (not boost::filesystem::exists(path)) {
+    return false;
+  }
+  if (not importer(path.c_str())) {
+    return false;
+  }
+  m_loaded.insert(key);
+  return true;
+}
+
+void FftwWisdom::record(const std::string& key, WisdomIo exporter) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_directory.empty() || m_loaded.count(key)) {
+    return;
+  }
+  m_new[key] = exporter;
+}
+
+long FftwWisdom::save() {
+  std::map<std::string, WisdomIo> keys;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_directory.empty()) {
+      return 0;
+    }
+    std::swap(keys, m_new);
+  }
+  long written = 0;
+  std::lock_guard<std::mutex> planning(FftwPlanner::instance().mutex());
+  for (const auto& k : keys) {
+    const auto path = filename(k.first);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (k.second(path.c_str())) {
+      m_loaded.insert(k.first);
+      ++written;
+    }
+  }
+  return written;
+}
+
+} // namespace Fourier
+} // namespace Euclid
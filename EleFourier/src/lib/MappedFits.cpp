@@ -0,0 +1,358 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/MappedFits.h"
+
+#include <cerrno>
+#include <cstring> // strerror
+#include <fcntl.h>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility> // exchange
+
+namespace Euclid {
+namespace Fourier {
+
+namespace {
+
+/**
+ * @brief The card size.
+ */
+constexpr long cardSize = 80;
+
+/**
+ * @brief Make an error message with the system error.
+ */
+std::string systemError(const std::string& message, const std::string& filename) {
+  return message + " " + filename + ": " + std::strerror(errno);
+}
+
+/**
+ * @brief Check whether a `BITPIX` value is valid.
+ */
+bool isValidBitpix(long bitpix) {
+  return bitpix == 8 || bitpix == 16 || bitpix == 32 || bitpix == 64 || bitpix == -32 || bitpix == -64;
+}
+
+/**
+ * @brief Round a size up to a multiple of the block size.
+ */
+long padded(long size) {
+  return (size + MappedFits::blockSize - 1) / MappedFits::blockSize * MappedFits::blockSize;
+}
+
+/**
+ * @brief Trim the leading and trailing spaces of a string.
+ */
+std::string trim(const std::string& value) {
+  const auto begin = value.find_first_not_of(' ');
+  if (begin == std::string::npos) {
+    return "";
+  }
+  const auto end = value.find_last_not_of(' ');
+  return value.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Get the value of a card, without comment nor quotes.
+ */
+std::string cardValue(const char* card) {
+  std::string value(card + 10, cardSize - 10);
+  value = trim(value);
+  if (not value.empty() && value[0] == '\'') {
+    const auto end = value.find('\'', 1);
+    return trim(value.substr(1, end == std::string::npos ? std::string::npos : end - 1));
+  }
+  return trim(value.substr(0, value.find('/')));
+}
+
+/**
+ * @brief Make a card.
+ */
+std::string card(const std::string& keyword, const std::string& value) {
+  std::string record = keyword;
+  record.resize(8, ' ');
+  record += "= ";
+  if (value.size() < 20) {
+    record += std::string(20 - value.size(), ' '); // Fixed format: right-justified in columns 11-30
+  }
+  record += value;
+  record.resize(cardSize, ' ');
+  return record;
+}
+
+/**
+ * @brief Make a header unit, padded to the block size.
+ */
+std::string header(const std::vector<std::string>& cards) {
+  std::string unit;
+  for (const auto& c : cards) {
+    unit += c;
+  }
+  unit += "END";
+  unit.resize(padded(unit.size()), ' ');
+  return unit;
+}
+
+/**
+ * @brief Make the header unit of an image extension.
+ */
+std::string imageHeader(long bitpix, std::uint64_t bzero, const std::vector<long>& shape) {
+  std::vector<std::string> cards {
+      card("XTENSION", "'IMAGE   '"),
+      card("BITPIX", std::to_string(bitpix)),
+      card("NAXIS", std::to_string(shape.size()))};
+  for (std::size_t i = 0; i < shape.size(); ++i) {
+    cards.push_back(card("NAXIS" + std::to_string(i + 1), std::to_string(shape[i])));
+  }
+  cards.push_back(card("PCOUNT", "0"));
+  cards.push_back(card("GCOUNT", "1"));
+  if (bzero) {
+    cards.push_back(card("BZERO", std::to_string(bzero))); // Unsigned integers
+  }
+  return header(cards);
+}
+
+} // namespace
+
+constexpr long MappedFits::blockSize;
+constexpr long MappedFits::parallelThreshold;
+
+MappedFits::MappedFits(const std::string& filename) :
+    m_filename(filename), m_fd(-1), m_data(nullptr), m_size(0), m_writable(false), m_hdus() {
+  m_fd = open(filename.c_str(), O_RDONLY);
+  if (m_fd < 0) {
+    throw std::runtime_error(systemError("Cannot open", filename));
+  }
+  struct stat status;
+  if (fstat(m_fd, &status) != 0) {
+    close(m_fd);
+    throw std::runtime_error(systemError("Cannot stat", filename));
+  }
+  map(status.st_size, false);
+  try {
+    parse();
+  } catch (...) {
+    unmap();
+    throw;
+  }
+}
+
+MappedFits::MappedFits(
+    const std::string& filename,
+    long bitpix,
+    std::uint64_t bzero,
+    const std::vector<long>& shape,
+    long count) :
+    m_filename(filename), m_fd(-1), m_data(nullptr), m_size(0), m_writable(true), m_hdus() {
+  if (not isValidBitpix(bitpix)) {
+    throw std::invalid_argument("Unsupported BITPIX: " + std::to_string(bitpix));
+  }
+  const std::string primary =
+      header({card("SIMPLE", "T"), card("BITPIX", "8"), card("NAXIS", "0"), card("EXTEND", "T")});
+  const std::string extension = imageHeader(bitpix, bzero, shape);
+  long size = std::abs(bitpix) / 8;
+  for (auto length : shape) {
+    size *= length;
+  }
+  const long hduSize = extension.size() + padded(size);
+  m_fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (m_fd < 0) {
+    throw std::runtime_error(systemError("Cannot create", filename));
+  }
+  if (ftruncate(m_fd, primary.size() + count * hduSize) != 0) { // Data units are zero-filled
+    close(m_fd);
+    throw std::runtime_error(systemError("Cannot resize", filename));
+  }
+  map(primary.size() + count * hduSize, true);
+  std::memcpy(m_data, primary.data(), primary.size());
+  for (long i = 0; i < count; ++i) {
+    std::memcpy(m_data + primary.size() + i * hduSize, extension.data(), extension.size());
+  }
+  try {
+    parse();
+  } catch (...) {
+    unmap();
+    throw;
+  }
+}
+
+MappedFits::~MappedFits() {
+  unmap();
+}
+
+MappedFits::MappedFits(MappedFits&& other) :
+    m_filename(std::move(other.m_filename)), m_fd(std::exchange(other.m_fd, -1)),
+    m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)),
+    m_writable(other.m_writable), m_hdus(std::move(other.m_hdus)) {}
+
+MappedFits& MappedFits::operator=(MappedFits&& other) {
+  if (this != &other) {
+    MappedFits released(std::move(*this));
+    m_filename = std::move(other.m_filename);
+    m_fd = std::exchange(other.m_fd, -1);
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+    m_writable = other.m_writable;
+    m_hdus = std::move(other.m_hdus);
+  }
+  return *this;
+}
+
+long MappedFits::hduCount() const {
+  return m_hdus.size();
+}
+
+bool MappedFits::isImage(long index) const {
+  return m_hdus.at(index).image;
+}
+
+long MappedFits::bitpix(long index) const {
+  return image(index).bitpix;
+}
+
+const std::vector<long>& MappedFits::shape(long index) const {
+  return image(index).shape;
+}
+
+long MappedFits::size(long index) const {
+  return image(index).size;
+}
+
+void MappedFits::sync() {
+  if (m_writable && msync(m_data, m_size, MS_SYNC) != 0) {
+    throw std::runtime_error(systemError("Cannot sync", m_filename));
+  }
+}
+
+void MappedFits::unmap() {
+  if (m_data) {
+    if (m_writable) {
+      msync(m_data, m_size, MS_SYNC);
+    }
+    munmap(m_data, m_size);
+    m_data = nullptr;
+  }
+  if (m_fd >= 0) {
+    close(m_fd);
+    m_fd = -1;
+  }
+}
+
+void MappedFits::map(long size, bool writable) {
+  m_size = size;
+  if (size == 0) {
+    return;
+  }
+  void* data = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_fd, 0);
+  if (data == MAP_FAILED) {
+    close(m_fd);
+    m_fd = -1;
+    throw std::runtime_error(systemError("Cannot map", m_filename));
+  }
+  m_data = static_cast<unsigned char*>(data);
+  if (not writable) {
+    madvise(m_data, m_size, MADV_SEQUENTIAL);
+  }
+}
+
+void MappedFits::parse() {
+  long offset = 0;
+  while (offset + blockSize <= m_size) {
+    std::map<std::string, std::string> records;
+    bool end = false;
+    long position = offset;
+    while (not end) {
+      if (position + cardSize > m_size) {
+        throw std::runtime_error("Truncated header in " + m_filename);
+      }
+      const char* c = reinterpret_cast<const char*>(m_data + position);
+      const auto keyword = trim(std::string(c, 8));
+      position += cardSize;
+      if (keyword == "END") {
+        end = true;
+      } else if (c[8] == '=' && not records.count(keyword)) {
+        records[keyword] = cardValue(c);
+      }
+    }
+    const auto get = [&](const std::string& keyword, long fallback) {
+      const auto it = records.find(keyword);
+      return it == records.end() ? fallback : std::stol(it->second);
+    };
+    const auto getDouble = [&](const std::string& keyword, double fallback) {
+      const auto it = records.find(keyword);
+      return it == records.end() ? fallback : std::stod(it->second);
+    };
+    Hdu hdu;
+    hdu.offset = padded(position);
+    hdu.bitpix = get("BITPIX", 8);
+    if (not isValidBitpix(hdu.bitpix)) {
+      throw std::runtime_error("Unsupported BITPIX " + std::to_string(hdu.bitpix) + " in " + m_filename);
+    }
+    const long naxis = get("NAXIS", 0);
+    hdu.size = naxis ? 1 : 0;
+    for (long i = 1; i <= naxis; ++i) {
+      hdu.shape.push_back(get("NAXIS" + std::to_string(i), 0));
+      hdu.size *= hdu.shape.back();
+    }
+    hdu.bscale = getDouble("BSCALE", 1);
+    hdu.bzero = getDouble("BZERO", 0);
+    const bool primary = records.count("SIMPLE");
+    const auto xtension = records.count("XTENSION") ? records["XTENSION"] : "";
+    hdu.image = (primary || xtension == "IMAGE") && not records.count("ZIMAGE");
+    const long pcount = get("PCOUNT", 0);
+    const long gcount = get("GCOUNT", 1);
+    const long bytes = std::abs(hdu.bitpix) / 8 * gcount * (pcount + hdu.size);
+    if (hdu.offset + bytes > m_size) {
+      throw std::runtime_error("Truncated data in " + m_filename);
+    }
+    m_hdus.push_back(std::move(hdu));
+    offset = m_hdus.back().offset + padded(bytes);
+  }
+}
+
+const MappedFits::Hdu& MappedFits::image(long index) const {
+  const auto& hdu = m_hdus.at(index);
+  if (not hdu.image) {
+    throw std::runtime_error("HDU " + std::to_string(index) + " of " + m_filename + " is not an uncompressed image");
+  }
+  return hdu;
+}
+
+const MappedFits::Hdu& MappedFits::writableImage(long index) const {
+  if (not m_writable) {
+    throw std::runtime_error("File is read-only: " + m_filename);
+  }
+  return image(index);
+}
+
+long MappedFits::checkRows(const Hdu& hdu, long stride, long size) {
+  const long width = hdu.shape.empty() ? 0 : hdu.shape[0];
+  if (stride < width || (stride && width && size / stride != hdu.size / width) || (stride && size % stride)) {
+    throw std::invalid_argument(
+        "Raster of size " + std::to_string(size) + " and row length " + std::to_string(stride) +
+        " does not match image of size " + std::to_string(hdu.size) + " and row length " + std::to_string(width));
+  }
+  return stride;
+}
+
+} // namespace Fourier
+} // namespace Euclid
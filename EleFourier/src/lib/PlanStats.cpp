@@ -0,0 +1,193 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/PlanStats.h"
+
+#include <algorithm> // nth_element
+#include <cstdlib> // getenv
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace Euclid {
+namespace Fourier {
+
+namespace {
+
+/**
+ * @brief Get a percentile of some values, which are reordered.
+ */
+double percentile(std::vector<double>& values, double q) {
+  if (values.empty()) {
+    return 0;
+  }
+  const auto nth = values.begin() + static_cast<long>(q * (values.size() - 1) + .5);
+  std::nth_element(values.begin(), nth, values.end());
+  return *nth;
+}
+
+} // namespace
+
+constexpr long PlanCounters::sampleCapacity;
+
+PlanCounters::PlanCounters() : m_mutex(), m_summary {0, 0, 0, 0, 0, 0, 0, 0, 0}, m_samples() {}
+
+void PlanCounters::recordPlanning(double seconds, double flops) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_summary.plannings;
+  m_summary.planningTime += seconds;
+  m_summary.flops = flops;
+}
+
+void PlanCounters::recordTransform(double seconds, double bytes) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (static_cast<long>(m_samples.size()) < sampleCapacity) {
+    m_samples.push_back(seconds);
+  } else {
+    m_samples[m_summary.transforms % sampleCapacity] = seconds;
+  }
+  ++m_summary.transforms;
+  m_summary.executeTime += seconds;
+  m_summary.bytes += bytes;
+}
+
+PlanCounters::Summary PlanCounters::summary() const {
+  std::vector<double> samples;
+  Summary summary;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    samples = m_samples;
+    summary = m_summary;
+  }
+  summary.p50 = percentile(samples, .5);
+  summary.p90 = percentile(samples, .9);
+  summary.p99 = percentile(samples, .99);
+  return summary;
+}
+
+PlanStats::PlanStats() : m_mutex(), m_enabled(false), m_filename(), m_counters() {
+  const char* filename = std::getenv("ELEFOURIER_PLAN_STATS");
+  if (filename) {
+    enable(filename);
+  }
+}
+
+PlanStats::~PlanStats() {
+  if (not m_filename.empty()) {
+    try {
+      save(m_filename);
+    } catch (...) {
+      // Do not throw at program ending
+    }
+  }
+}
+
+PlanStats& PlanStats::instance() {
+  static PlanStats registry;
+  return registry;
+}
+
+void PlanStats::enable(const std::string& filename) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_filename = filename;
+  m_enabled = true;
+}
+
+void PlanStats::disable() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_filename.clear();
+  m_enabled = false;
+}
+
+std::shared_ptr<PlanCounters> PlanStats::counters(const std::string& key) {
+  if (not enabled()) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& counters = m_counters[key];
+  if (not counters) {
+    counters = std::make_shared<PlanCounters>();
+  }
+  return counters;
+}
+
+std::map<std::string, PlanCounters::Summary> PlanStats::summaries() const {
+  std::map<std::string, std::shared_ptr<PlanCounters>> counters;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    counters = m_counters;
+  }
+  std::map<std::string, PlanCounters::Summary> out;
+  for (const auto& c : counters) {
+    out[c.first] = c.second->summary();
+  }
+  return out;
+}
+
+std::string PlanStats::json() const {
+  std::ostringstream os;
+  os << "{";
+  const char* separator = "\n";
+  for (const auto& s : summaries()) {
+    const auto& v = s.second;
+    os << separator << "  \"" << s.first << "\": {";
+    os << "\"plannings\": " << v.plannings << ", ";
+    os << "\"planning_ms\": " << v.planningTime * 1.e3 << ", ";
+    os << "\"transforms\": " << v.transforms << ", ";
+    os << "\"total_ms\": " << v.executeTime * 1.e3 << ", ";
+    os << "\"mean_ms\": " << v.mean() * 1.e3 << ", ";
+    os << "\"p50_ms\": " << v.p50 * 1.e3 << ", ";
+    os << "\"p90_ms\": " << v.p90 * 1.e3 << ", ";
+    os << "\"p99_ms\": " << v.p99 * 1.e3 << ", ";
+    os << "\"bytes\": " << v.bytes << ", ";
+    os << "\"flops\": " << v.flops << ", ";
+    os << "\"gflops_per_s\": " << v.gflops() << ", ";
+    os << "\"gbytes_per_s\": " << v.bandwidth() << "}";
+    separator = ",\n";
+  }
+  os << "\n}\n";
+  return os.str();
+}
+
+std::string PlanStats::report() const {
+  std::ostringstream os;
+  for (const auto& s : summaries()) {
+    const auto& v = s.second;
+    os << s.first << ": " << v.transforms << " transforms, mean " << v.mean() * 1.e3 << " ms (p50 " << v.p50 * 1.e3
+       << ", p90 " << v.p90 * 1.e3 << ", p99 " << v.p99 * 1.e3 << "), " << v.gflops() << " GFLOP/s, "
+       << v.bandwidth() << " GB/s; planned " << v.plannings << " times in " << v.planningTime * 1.e3 << " ms\n";
+  }
+  return os.str();
+}
+
+void PlanStats::save(const std::string& filename) const {
+  std::ofstream file(filename);
+  if (not file) {
+    throw std::runtime_error("Cannot open plan statistics file: " + filename);
+  }
+  file << json();
+}
+
+void PlanStats::reset() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_counters.clear();
+}
+
+} // namespace Fourier
+} // namespace Euclid
@@ -0,0 +1,114 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/PlanningPolicy.h"
+
+#include <omp.h>
+#include <stdexcept>
+
+namespace Euclid {
+namespace Fourier {
+
+PlanningPolicy::Rigor PlanningPolicy::parseRigor(const std::string& name) {
+  if (name == "Estimate") {
+    return Rigor::Estimate;
+  }
+  if (name == "Measure") {
+    return Rigor::Measure;
+  }
+  if (name == "Patient") {
+    return Rigor::Patient;
+  }
+  if (name == "Exhaustive") {
+    return Rigor::Exhaustive;
+  }
+  throw std::invalid_argument("Unknown planning rigor: " + name);
+}
+
+PlanningPolicy& PlanningPolicy::parallelize(long count) {
+  threads = count > 0 ? count : omp_get_max_threads();
+  return *this;
+}
+
+unsigned PlanningPolicy::flags() const {
+  unsigned f = 0;
+  switch (rigor) {
+    case Rigor::Estimate:
+      f = FFTW_ESTIMATE;
+      break;
+    case Rigor::Measure:
+      f = FFTW_MEASURE;
+      break;
+    case Rigor::Patient:
+      f = FFTW_PATIENT;
+      break;
+    case Rigor::Exhaustive:
+      f = FFTW_EXHAUSTIVE;
+      break;
+  }
+  switch (input) {
+    case Input::Default:
+      break;
+    case Input::Preserve:
+      f |= FFTW_PRESERVE_INPUT;
+      break;
+    case Input::Destroy:
+      f |= FFTW_DESTROY_INPUT;
+      break;
+  }
+  return f;
+}
+
+std::string PlanningPolicy::name() const {
+  std::string n;
+  switch (rigor) {
+    case Rigor::Estimate:
+      n = "Estimate";
+      break;
+    case Rigor::Measure:
+      n = "Measure";
+      break;
+    case Rigor::Patient:
+      n = "Patient";
+      break;
+    case Rigor::Exhaustive:
+      n = "Exhaustive";
+      break;
+  }
+  switch (input) {
+    case Input::Default:
+      break;
+    case Input::Preserve:
+      n += "Preserve";
+      break;
+    case Input::Destroy:
+      n += "Destroy";
+      break;
+  }
+  if (isInPlace()) {
+    n += "InPlace";
+  }
+  if (threads > 1) {
+    n += std::to_string(threads) + "Threads";
+  }
+  return n;
+}
+
+} // namespace Fourier
+} // namespace Euclid
@@ -18,3 +18,143 @@
  */
 
 #include "EleFourier/Zernike.h"
+
+#include "EleFits/SifFile.h"
+
+#include <algorithm> // fill_n, min
+#include <cmath> // sqrt
+#include <cstdlib> // abs
+#include <fstream>
+#include <stdexcept>
+#include <utility> // swap
+#include <vector>
+
+namespace Euclid {
+namespace Zernike {
+
+AnsiOrders ansiOrders(long j) {
+  if (j < 0) {
+    throw std::invalid_argument("Negative ANSI index: " + std::to_string(j));
+  }
+  long n = 0;
+  while ((n + 1) * (n + 2) / 2 <= j) {
+    ++n;
+  }
+  return {n, 2 * j - n * (n + 2)};
+}
+
+long ansiIndex(long n, long m) {
+  if (n < 0 || m < -n || m > n || (n - m) % 2 != 0) {
+    throw std::invalid_argument("Invalid Zernike orders: " + std::to_string(n) + ", " + std::to_string(m));
+  }
+  return (n * (n + 2) + m) / 2;
+}
+
+Fits::VecRaster<double, 3> ansiBasis(long side, long count) {
+  if (side < 1 || count < 1) {
+    throw std::invalid_argument(
+        "Invalid Zernike basis: " + std::to_string(count) + " indices over side " + std::to_string(side));
+  }
+  const double radius = 0.5 * side;
+  const long maxN = ansiOrders(count - 1).n;
+  const long orders = maxN + 1;
+  Fits::VecRaster<double, 3> zernike({count, side, side});
+  double* out = zernike.data();
+
+#pragma omp parallel for
+  for (long v = 0; v < side; ++v) {
+
+    // Polar coordinates, with the axes of LocalZernikeSeries: theta is measured from the v axis
+    std::vector<double> rho(side);
+    std::vector<double> inside(side);
+    std::vector<double> cosines(orders * side); // cos(m theta), for each m
+    std::vector<double> sines(orders * side); // sin(m theta), for each m
+    const double y = (v - radius) / radius;
+#pragma omp simd
+    for (long u = 0; u < side; ++u) {
+      const double x = (u - radius) / radius;
+      const double r2 = x * x + y * y;
+      const double r = std::sqrt(r2);
+      rho[u] = r;
+      inside[u] = r2 <= 1;
+      cosines[u] = 1;
+      sines[u] = 0;
+      if (orders > 1) {
+        cosines[side + u] = r > 0 ? y / r : 1;
+        sines[side + u] = r > 0 ? x / r : 0;
+      }
+    }
+    for (long m = 2; m < orders; ++m) {
+      const double* c1 = &cosines[side];
+      const double* cPrev = &cosines[(m - 1) * side];
+      const double* cPrev2 = &cosines[(m - 2) * side];
+      const double* sPrev = &sines[(m - 1) * side];
+      const double* sPrev2 = &sines[(m - 2) * side];
+      double* c = &cosines[m * side];
+      double* s = &sines[m * side];
+#pragma omp simd
+      for (long u = 0; u < side; ++u) {
+        c[u] = 2 * c1[u] * cPrev[u] - cPrev2[u];
+        s[u] = 2 * c1[u] * sPrev[u] - sPrev2[u];
+      }
+    }
+
+    // Radial polynomials R_n^m, for each m, of orders n - 2, n - 1 and n
+    std::vector<double> previous2(orders * side, 0.);
+    std::vector<double> previous(orders * side, 0.);
+    std::vector<double> current(orders * side, 0.);
+    const std::vector<double> zeros(side, 0.);
+    std::fill_n(current.begin(), side, 1.); // R_0^0
+    double* row = out + v * side * count;
+    for (long n = 0; n <= maxN; ++n) {
+      if (n > 0) {
+        std::swap(previous2, previous);
+        std::swap(previous, current);
+        for (long m = n % 2; m <= n; m += 2) {
+          const double* left = &previous[std::abs(m - 1) * side];
+          const double* right = m + 1 < n ? &previous[(m + 1) * side] : zeros.data(); // R_n^m = 0 if m > n
+          const double* below = m + 2 <= n ? &previous2[m * side] : zeros.data();
+          double* r = &current[m * side];
+#pragma omp simd
+          for (long u = 0; u < side; ++u) {
+            r[u] = rho[u] * (left[u] + right[u]) - below[u];
+          }
+        }
+      }
+      const long last = std::min(ansiIndex(n, n), count - 1);
+      for (long j = ansiIndex(n, -n); j <= last; ++j) {
+        const long m = 2 * j - n * (n + 2);
+        const long a = std::abs(m);
+        const double* r = &current[a * side];
+        const double* t = m < 0 ? &sines[a * side] : &cosines[a * side];
+        for (long u = 0; u < side; ++u) {
+          row[j + u * count] = inside[u] * r[u] * t[u];
+        }
+      }
+    }
+  }
+  return zernike;
+}
+
+std::string ansiBasisFilename(long side, long count, const std::string& directory) {
+  return directory + "/zernike_ansi_" + std::to_string(side) + "_" + std::to_string(count) + ".fits";
+}
+
+Fits::VecRaster<double, 3> cachedAnsiBasis(long side, long count, const std::string& directory) {
+  const auto filename = ansiBasisFilename(side, count, directory);
+  if (std::ifstream(filename).good()) {
+    Fits::SifFile f(filename, Fits::FileMode::Read);
+    const auto& raster = f.raster();
+    const auto shape = raster.readShape<3>();
+    if (shape[0] == count && shape[1] == side && shape[2] == side) {
+      return raster.read<double, 3>();
+    }
+  }
+  auto zernike = ansiBasis(side, count);
+  Fits::SifFile f(filename, Fits::FileMode::Overwrite);
+  f.writeRaster(zernike);
+  return zernike;
+}
+
+} // namespace Zernike
+} // namespace Euclid
@@ -0,0 +1,451 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFitsUtils/ProgramOptions.h"
+#include "EleFitsValidation/Chronometer.h"
+#include "EleFourier/BroadbandPsf.h"
+#include "EleFourier/Dft.h"
+#include "EleFourier/PupilPhase.h"
+#include "EleFourier/Zernike.h"
+#include "ElementsKernel/ProgramHeaders.h"
+
+#include <algorithm> // sort
+#include <chrono>
+#include <cmath> // log2
+#include <complex>
+#include <fstream>
+#include <map>
+#include <omp.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using boost::program_options::value;
+
+using namespace Euclid;
+using namespace Fourier;
+
+static auto logger = Elements::Logging::getLogger("EleFourierBenchmark");
+
+using Chrono = Fits::Validation::Chronometer<std::chrono::microseconds>;
+
+/**
+ * @brief Parse a `<width>x<height>[x<count>]` string.
+ */
+std::pair<Fits::Position<2>, long> parseShape(const std::string& str) {
+  std::istringstream iss(str);
+  long width = 0;
+  long height = 0;
+  long count = 1;
+  char sep = 0;
+  iss >> width >> sep >> height;
+  if (not iss || sep != 'x') {
+    throw std::runtime_error("Cannot parse shape: " + str);
+  }
+  if (iss >> sep) {
+    if (sep != 'x' || not(iss >> count)) {
+      throw std::runtime_error("Cannot parse shape: " + str);
+    }
+  }
+  return {{width, height}, count};
+}
+
+/**
+ * @brief Generate a circular pupil mask.
+ */
+Fits::VecRaster<double> generatePupil(long side) {
+  Fits::VecRaster<double> pupil({side, side});
+  const auto center = side / 2;
+  const auto radius = side / 4;
+  for (const auto& p : pupil.domain()) {
+    const auto u = p[0] - center;
+    const auto v = p[1] - center;
+    pupil[p] = u * u + v * v < radius * radius ? 1. : 0.;
+  }
+  return pupil;
+}
+
+/**
+ * @brief A benchmark case: its parameters, as JSON values, and its timings.
+ */
+struct Result {
+
+  /** @brief The parameters, as (name, JSON value) pairs. */
+  std::vector<std::pair<std::string, std::string>> params;
+
+  /** @brief The setup time (e.g. planning), in ms. */
+  double setup;
+
+  /** @brief The repetition times, in ms, sorted. */
+  std::vector<double> samples;
+
+  /** @brief The nominal number of floating point operations per repetition, or 0 if irrelevant. */
+  double flops;
+
+  /** @brief Add a string parameter. */
+  Result& param(const std::string& name, const std::string& val) {
+    params.emplace_back(name, '"' + val + '"');
+    return *this;
+  }
+
+  /** @brief Add a numeric parameter. */
+  Result& param(const std::string& name, long val) {
+    params.emplace_back(name, std::to_string(val));
+    return *this;
+  }
+
+  /** @brief Set the samples from a chronometer. */
+  void time(const Chrono& chrono) {
+    samples.clear();
+    for (const auto& i : chrono.increments()) {
+      samples.push_back(i.count() * 1.e-3);
+    }
+    std::sort(samples.begin(), samples.end());
+  }
+
+  /** @brief Get the minimum time. */
+  double min() const {
+    return samples.empty() ? 0 : samples.front();
+  }
+
+  /** @brief Get the median time. */
+  double median() const {
+    return samples.empty() ? 0 : samples[samples.size() / 2];
+  }
+
+  /** @brief Get the mean time. */
+  double mean() const {
+    double sum = 0;
+    for (auto s : samples) {
+      sum += s;
+    }
+    return samples.empty() ? 0 : sum / samples.size();
+  }
+
+  /** @brief Get the maximum time. */
+  double max() const {
+    return samples.empty() ? 0 : samples.back();
+  }
+
+  /** @brief Get the throughput at the median time, in GFLOP/s. */
+  double gflops() const {
+    return median() > 0 ? flops / median() * 1.e-6 : 0;
+  }
+
+  /** @brief Write as a JSON object. */
+  std::string json() const {
+    std::ostringstream os;
+    os << "{";
+    for (const auto& p : params) {
+      os << '"' << p.first << "\": " << p.second << ", ";
+    }
+    os << "\"setup_ms\": " << setup << ", \"repeat\": " << samples.size() << ", \"min_ms\": " << min()
+       << ", \"median_ms\": " << median() << ", \"mean_ms\": " << mean() << ", \"max_ms\": " << max()
+       << ", \"gflops_per_s\": " << gflops() << "}";
+    return os.str();
+  }
+};
+
+/**
+ * @brief Get the nominal number of floating point operations of a complex DFT, `5 n log2(n)`.
+ * @details
+ * This is the convention of benchFFT: it is not the actual count, but allows comparing algorithms and sizes.
+ * Real DFTs have half this count.
+ */
+double nominalFlops(const Fits::Position<2>& shape, long count) {
+  const double n = double(shape[0]) * shape[1];
+  return 5. * n * std::log2(n) * count;
+}
+
+/**
+ * @brief Plan a transform, warm it up, and time repeated executions.
+ */
+template <typename TPlan>
+Result benchmarkPlan(
+    const std::string& type,
+    const Fits::Position<2>& shape,
+    long count,
+    const PlanningPolicy& policy,
+    long warmUp,
+    long repeat) {
+  Result result;
+  result.param("case", "transform").param("type", type).param("width", shape[0]).param("height", shape[1]);
+  result.param("count", count).param("policy", policy.name());
+  Chrono chrono;
+  chrono.start();
+  TPlan plan(shape, count, policy);
+  result.setup = chrono.stop().count() * 1.e-3;
+  std::default_random_engine engine;
+  std::uniform_real_distribution<typename TPlan::Real> distribution(0., 1.);
+  for (auto& v : plan.inStack()) {
+    v = distribution(engine);
+  }
+  for (long i = 0; i < warmUp; ++i) {
+    plan.transform();
+  }
+  chrono.reset();
+  for (long i = 0; i < repeat; ++i) {
+    chrono.start();
+    plan.transform();
+    chrono.stop();
+  }
+  result.time(chrono);
+  result.flops = nominalFlops(shape, count) * (type == "complex" ? 1. : .5);
+  return result;
+}
+
+/**
+ * @brief Dispatch `benchmarkPlan()` according to a transform type name.
+ */
+Result benchmarkType(
+    const std::string& type,
+    const Fits::Position<2>& shape,
+    long count,
+    const PlanningPolicy& policy,
+    long warmUp,
+    long repeat) {
+  if (type == "real") {
+    return benchmarkPlan<RealDft>(type, shape, count, policy, warmUp, repeat);
+  }
+  if (type == "complex") {
+    return benchmarkPlan<ComplexDft>(type, shape, count, policy, warmUp, repeat);
+  }
+  if (type == "hermitian") {
+    return benchmarkPlan<HermitianComplexDft>(type, shape, count, policy, warmUp, repeat);
+  }
+  throw std::runtime_error("Unknown transform type: " + type);
+}
+
+/**
+ * @brief Time the sparse exponentiation pipeline, one wavelength per repetition:
+ * pupil amplitude, PSF amplitude, PSF intensity and MTF.
+ */
+Result benchmarkSparseExp(long side, long alphaCount, long threads, long warmUp, long repeat) {
+  Result result;
+  result.param("case", "sparse-exp").param("side", side).param("alphas", alphaCount).param("threads", threads);
+  omp_set_num_threads(threads);
+  Chrono chrono;
+  chrono.start();
+  const auto mask = generatePupil(side);
+  SparsePupil pupil(mask, Zernike::ansiBasis(side, alphaCount));
+  PupilPhase phase(pupil);
+  phase.evalOpd(std::vector<double>(alphaCount, .1));
+  ComplexDft pupilToPsf({side, side});
+  RealDft psfToMtf({side, side});
+  result.setup = chrono.stop().count() * 1.e-3;
+  auto run = [&](long i) {
+    phase.evalAmplitude(.5 + .001 * i, pupilToPsf.inBuffer());
+    pupilToPsf.transform().pipe(psfToMtf, Norm2());
+    psfToMtf.transform();
+  };
+  for (long i = 0; i < warmUp; ++i) {
+    run(i);
+  }
+  chrono.reset();
+  for (long i = 0; i < repeat; ++i) {
+    chrono.start();
+    run(i);
+    chrono.stop();
+  }
+  result.time(chrono);
+  result.flops = nominalFlops({side, side}, 1) * 1.5;
+  return result;
+}
+
+/**
+ * @brief Time the broadband pipeline, one complete run of the engine per repetition.
+ */
+Result benchmarkBroadband(
+    long side,
+    long broadbandSide,
+    long alphaCount,
+    long params,
+    long lambdas,
+    long threads,
+    long warmUp,
+    long repeat) {
+  Result result;
+  result.param("case", "broadband").param("side", side).param("broadband", broadbandSide);
+  result.param("alphas", alphaCount).param("params", params).param("lambdas", lambdas).param("threads", threads);
+  Chrono chrono;
+  chrono.start();
+  const auto mask = generatePupil(side);
+  SparsePupil pupil(mask, Zernike::ansiBasis(side, alphaCount));
+  PupilPhase phase(pupil);
+  phase.evalOpd(std::vector<double>(alphaCount, .1));
+  BroadbandPsf engine({side, side}, {broadbandSide, broadbandSide}, threads);
+  result.setup = chrono.stop().count() * 1.e-3;
+  auto run = [&]() {
+    engine.run(params, lambdas, [&](long, long l, Fits::PtrRaster<std::complex<double>>& plane) {
+      phase.evalAmplitude(.5 + .001 * l, plane);
+    });
+  };
+  for (long i = 0; i < warmUp; ++i) {
+    run();
+  }
+  chrono.reset();
+  for (long i = 0; i < repeat; ++i) {
+    chrono.start();
+    run();
+    chrono.stop();
+  }
+  result.time(chrono);
+  const double monochromatic = nominalFlops({side, side}, lambdas) * 1.5;
+  const double inverse = nominalFlops({broadbandSide, broadbandSide}, 1) * .5;
+  result.flops = (monochromatic + inverse) * params;
+  return result;
+}
+
+/**
+ * Program class.
+ */
+class EleFourierBenchmark : public Elements::Program {
+
+public:
+  std::pair<OptionsDescription, PositionalOptionsDescription> defineProgramArguments() override {
+    Fits::ProgramOptions options("Benchmark transforms and PSF pipelines, and write the results as JSON.");
+    options.named(
+        "shape",
+        value<std::vector<std::string>>()->multitoken()->default_value(
+            {"256x256", "1000x1000", "1024x1024", "1536x1536", "1024x1024x8"},
+            "256x256 1000x1000 1024x1024 1536x1536 1024x1024x8"),
+        "Transform logical shapes as <width>x<height>[x<count>]");
+    options.named(
+        "type",
+        value<std::vector<std::string>>()->multitoken()->default_value(
+            {"real", "complex", "hermitian"},
+            "real complex hermitian"),
+        "Transform types (real, complex and/or hermitian)");
+    options.named(
+        "threads",
+        value<std::vector<long>>()->multitoken()->default_value({1}, "1"),
+        "Numbers of threads (0 = OpenMP's max)");
+    options.named(
+        "rigor",
+        value<std::vector<std::string>>()->multitoken()->default_value({"Measure"}, "Measure"),
+        "Planning rigors (Estimate, Measure, Patient and/or Exhaustive)");
+    options.flag("inplace", "Also benchmark in-place transforms");
+    options.named(
+        "pipeline",
+        value<std::vector<std::string>>()->multitoken()->default_value(
+            {"sparse-exp", "broadband"},
+            "sparse-exp broadband"),
+        "End-to-end pipelines (sparse-exp and/or broadband, or none)");
+    options.named("side", value<long>()->default_value(1024), "Pupil side of the pipelines");
+    options.named("broadband", value<long>()->default_value(512), "Broadband PSF side");
+    options.named("alphas", value<long>()->default_value(40), "Number of Zernike indices");
+    options.named("params", value<long>()->default_value(4), "Number of parameters of the broadband pipeline");
+    options.named("lambdas", value<long>()->default_value(10), "Number of wavelengths of the broadband pipeline");
+    options.named("warmup", value<long>()->default_value(2), "Number of untimed repetitions per case");
+    options.named("repeat", value<long>()->default_value(10), "Number of timed repetitions per case");
+    options.named("output", value<std::string>()->default_value("/tmp/EleFourierBenchmark.json"), "Output JSON file");
+    return options.asPair();
+  }
+
+  Elements::ExitCode mainMethod(std::map<std::string, VariableValue>& args) override {
+
+    const auto shapes = args["shape"].as<std::vector<std::string>>();
+    const auto types = args["type"].as<std::vector<std::string>>();
+    auto threadCounts = args["threads"].as<std::vector<long>>();
+    const auto rigors = args["rigor"].as<std::vector<std::string>>();
+    const auto inPlace = args["inplace"].as<bool>();
+    const auto pipelines = args["pipeline"].as<std::vector<std::string>>();
+    const auto side = args["side"].as<long>();
+    const auto broadbandSide = args["broadband"].as<long>();
+    const auto alphaCount = args["alphas"].as<long>();
+    const auto params = args["params"].as<long>();
+    const auto lambdas = args["lambdas"].as<long>();
+    const auto warmUp = args["warmup"].as<long>();
+    const auto repeat = args["repeat"].as<long>();
+    const auto filename = args["output"].as<std::string>();
+
+    const long maxThreads = omp_get_max_threads();
+    for (auto& t : threadCounts) {
+      if (t <= 0) {
+        t = maxThreads;
+      }
+    }
+
+    std::vector<Result> results;
+    auto log = [&](const Result& result) {
+      logger.info() << "  " << result.json();
+      results.push_back(result);
+    };
+
+    // Transforms
+    logger.info() << "Benchmarking transforms...";
+    for (const auto& s : shapes) {
+      const auto shapeCount = parseShape(s);
+      for (const auto& r : rigors) {
+        for (const auto t : threadCounts) {
+          for (int placement = 0; placement < (inPlace ? 2 : 1); ++placement) {
+            PlanningPolicy policy(PlanningPolicy::parseRigor(r));
+            if (t != 1) {
+              policy.parallelize(t);
+            }
+            if (placement) {
+              policy.inPlace();
+            }
+            for (const auto& type : types) {
+              log(benchmarkType(type, shapeCount.first, shapeCount.second, policy, warmUp, repeat).param("threads", t));
+            }
+          }
+        }
+      }
+    }
+
+    // Pipelines
+    for (const auto& p : pipelines) {
+      if (p == "none") {
+        continue;
+      }
+      logger.info() << "Benchmarking " << p << " pipeline...";
+      for (const auto t : threadCounts) {
+        if (p == "sparse-exp") {
+          log(benchmarkSparseExp(side, alphaCount, t, warmUp, repeat));
+        } else if (p == "broadband") {
+          log(benchmarkBroadband(side, broadbandSide, alphaCount, params, lambdas, t, warmUp, repeat));
+        } else {
+          throw std::runtime_error("Unknown pipeline: " + p);
+        }
+      }
+    }
+    omp_set_num_threads(maxThreads);
+
+    // Write results
+    std::ofstream file(filename);
+    if (not file) {
+      throw std::runtime_error("Cannot open output file: " + filename);
+    }
+    file << "{\n  \"host\": \"" << FftwWisdom::hostname() << "\",\n  \"fftw\": \"" << fftw_version
+         << "\",\n  \"max_threads\": " << maxThreads << ",\n  \"warmup\": " << warmUp << ",\n  \"results\": [";
+    const char* separator = "\n    ";
+    for (const auto& r : results) {
+      file << separator << r.json();
+      separator = ",\n    ";
+    }
+    file << "\n  ]\n}\n";
+    logger.info() << "See: " << filename;
+
+    return Elements::ExitCode::OK;
+  }
+};
+
+MAIN_FOR(EleFourierBenchmark)
@@ -19,7 +19,10 @@
 
 #include "EleFitsUtils/ProgramOptions.h"
 #include "EleFitsValidation/Chronometer.h"
+#include "EleFourier/BroadbandPsf.h"
 #include "EleFourier/Dft.h"
+#include "EleFourier/PlanStats.h"
+#include "EleFourier/PrunedDft.h"
 #include "ElementsKernel/ProgramHeaders.h"
 
 #include <chrono>
@@ -27,6 +30,7 @@
 #include <map>
 #include <omp.h>
 #include <random>
+#include <sstream>
 #include <string>
 
 using boost::program_options::value;
@@ -36,26 +40,25 @@ using namespace Fourier;
 
 /**
  * @brief The set of DFT plans of each parallel branch.
- * @warning
- * Plans should be initialized in a single thread, as this writes in global variables.
+ * @details
+ * Plans can be initialized in parallel, as planning is serialized by `FftwPlanner`.
+ * Plans with identical geometry are planned once and shared among the branches.
  */
 struct BranchDfts {
 
   /** Pupil to monochromatic PSF transform. */
   RealDft pupilToPsf;
 
-  /** Monochromatic PSF to MTF transform. */
-  RealDft psfToMtf;
+  /** Monochromatic PSF to MTF transform, only evaluated on the broadband frequency grid. */
+  PrunedRealDft psfToMtf;
 
-  /** Total MTF to broadband PSF transform. */
-  ComplexDft::Inverse mtfToBroadband;
-
-  /** Branch-wise chronometer. */
-  Fits::Validation::Chronometer<std::chrono::milliseconds> chrono;
+  /** Total MTF (Hermitian) to broadband PSF transform. */
+  RealDft::Inverse mtfToBroadband;
 
   /** Constructor. */
   BranchDfts(const Fits::Position<2>& pupilShape, const Fits::Position<2>& broadbandShape) :
-      pupilToPsf(pupilShape), psfToMtf(pupilShape), mtfToBroadband(broadbandShape), chrono() {}
+      pupilToPsf(pupilShape), psfToMtf(pupilShape, {0, 0}, pupilShape, pupilShape[0] / broadbandShape[0]),
+      mtfToBroadband(broadbandShape) {}
 };
 
 /**
@@ -74,6 +77,7 @@ public:
     options.named("lambdas", value<long>()->default_value(40), "Number of wavelengths per branch");
     options.named("pupil", value<long>()->default_value(1024), "Input pupil mask side");
     options.named("psf", value<long>()->default_value(512), "Output PSF side (oversampled)");
+    options.flag("engine", "Use the BroadbandPsf engine with dynamic scheduling instead of the manual loop");
     return options.asPair();
   }
 
@@ -90,24 +94,39 @@ public:
     const auto lambdas = args["lambdas"].as<long>();
     const auto pupilSide = args["pupil"].as<long>();
     const auto broadbandSide = args["psf"].as<long>();
-    const long sideRatio = pupilSide / broadbandSide;
     const Fits::Position<2> pupilShape {pupilSide, pupilSide};
     const Fits::Position<2> broadbandShape {broadbandSide, broadbandSide};
-    Fits::Validation::Chronometer<std::chrono::milliseconds> programChrono;
+    using Chrono = Fits::Validation::Chronometer<std::chrono::milliseconds>;
+    Chrono programChrono;
+    PlanStats::instance().enable(); // Instrument the plans created from now on
 
-    // Initialize DFT plans sequentially - NOT THREAD SAFE!
-    std::vector<BranchDfts> dfts;
-    dfts.reserve(params);
-    for (long i = 0; i < params; ++i) {
-      logger.info() << "Initializing param #" << i << "'s plans...";
+    // Let the engine schedule the (param, lambda) items
+    if (args["engine"].as<bool>()) {
+      logger.info() << "Planning...";
+      programChrono.start();
+      BroadbandPsf psf(pupilShape, broadbandShape, branches);
+      programChrono.stop();
+      logger.info() << "  Done in " << programChrono.last().count() << " ms.";
+      logger.info() << "Executing with " << psf.threads() << " threads...";
       programChrono.start();
-      dfts.emplace_back(pupilShape, broadbandShape);
+      psf.run(params, lambdas, [](long p, long l, Fits::PtrRaster<std::complex<double>>& pupil) {
+        std::default_random_engine engine(p * 7919 + l);
+        std::uniform_real_distribution<double> distribution(0., 1.);
+        std::generate(pupil.begin(), pupil.end(), [&]() {
+          return distribution(engine);
+        });
+      });
       programChrono.stop();
       logger.info() << "  Done in " << programChrono.last().count() << " ms.";
+      const auto& items = psf.itemCounts();
+      for (std::size_t t = 0; t < items.size(); ++t) {
+        logger.info() << "  Thread #" << t << ": " << items[t] << " items";
+      }
+      return Elements::ExitCode::OK;
     }
 
-    // Use plans in parallel
-    logger.info() << "Executing plans in parallel...";
+    // Create and use plans in parallel
+    logger.info() << "Planning and executing in parallel...";
     logger.info() << "  Number of parameters: " << params;
     logger.info() << "  Number of branches: " << branches;
     logger.info() << "  Available number of threads: " << omp_get_max_threads();
@@ -116,12 +135,15 @@ public:
 #pragma omp parallel for
     for (long i = 0; i < params; ++i) {
 
+      // Plan lazily in the thread
+      BranchDfts dfts(pupilShape, broadbandShape);
+
       // Shortcuts
-      auto& pupilToPsf = dfts[i].pupilToPsf;
-      auto& psfToMtf = dfts[i].psfToMtf;
-      auto& mtfToBroadband = dfts[i].mtfToBroadband;
-      auto& chrono = dfts[i].chrono;
+      auto& pupilToPsf = dfts.pupilToPsf;
+      auto& psfToMtf = dfts.psfToMtf;
+      auto& mtfToBroadband = dfts.mtfToBroadband;
       auto mtfSum = mtfToBroadband.inBuffer();
+      std::fill(mtfSum.begin(), mtfSum.end(), std::complex<double>(0));
 
       // Random number generator
       auto pupilBegin = pupilToPsf.inBuffer().begin();
@@ -137,37 +159,26 @@ public:
           return distribution(engine);
         });
 
-        // Perform and time transforms
-        chrono.start();
+        // Perform transforms
         const auto dft = pupilToPsf.transform().outBuffer(); // Compute the DFT of the pupil function
-        chrono.stop();
-        psfToMtf.inBuffer().generate(
-            [](auto c) {
-              return std::norm(c);
-            },
-            dft); // Feed psfToMft with |pupilToPsf|^2
-        chrono.start();
-        const auto mtf = psfToMtf.transform().outBuffer(); // Compute the MTF
-        chrono.stop();
-        for (long y = 0; y < broadbandSide; ++y) {
-          for (long x = 0; x < broadbandSide; ++x) {
-            mtfSum[{x, y}] += mtf[{x * sideRatio, y * sideRatio}];
+        norm2HermitianData(dft.data(), psfToMtf.window().data(), pupilSide, pupilSide); // Feed psfToMtf with |dft|^2
+        const auto mtf = psfToMtf.transform().outBuffer(); // Compute the MTF, on the broadband grid
+        for (long y = 0; y < mtf.shape()[1]; ++y) {
+          for (long x = 0; x < mtf.shape()[0]; ++x) {
+            mtfSum[{x, y}] += mtf[{x, y}];
           }
         }
       }
-      chrono.start();
       mtfToBroadband.transform();
-      chrono.stop();
     }
     programChrono.stop();
     logger.info() << "  Done in " << programChrono.last().count() << " ms.";
 
-    // Print aggregate times
-    logger.info() << "Parameter-wise timings:";
-    for (long i = 0; i < params; ++i) {
-      const auto count = dfts[i].chrono.count();
-      const auto mean = dfts[i].chrono.mean();
-      logger.info() << "  Parameter #" << i << ": " << count << " transforms lasted " << mean << " ms in average.";
+    // Print plan-wise statistics
+    logger.info() << "Plan-wise statistics:";
+    std::istringstream report(PlanStats::instance().report());
+    for (std::string line; std::getline(report, line);) {
+      logger.info() << "  " << line;
     }
 
     return Elements::ExitCode::OK;
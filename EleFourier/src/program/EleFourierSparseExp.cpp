@@ -23,6 +23,8 @@
 #include "EleFitsUtils/ProgramOptions.h"
 #include "EleFitsValidation/Chronometer.h"
 #include "EleFourier/Dft.h"
+#include "EleFourier/PupilPhase.h"
+#include "EleFourier/Shift.h"
 #include "EleFourier/Zernike.h"
 #include "ElementsKernel/ProgramHeaders.h"
 
@@ -53,43 +55,6 @@ Fits::VecRaster<double> generatePupil(long maskSide, long pupilRadius) {
   return pupil;
 }
 
-template <typename TIter>
-void swapRanges(TIter aBegin, TIter aEnd, TIter bBegin) {
-  TIter aIt = aBegin;
-  TIter bIt = bBegin;
-  while (aIt != aEnd) {
-    std::iter_swap(aIt++, bIt++);
-  }
-}
-
-template <typename TRaster>
-TRaster& fftShift(TRaster& raster) {
-  const auto width = raster.shape()[0];
-  const auto height = raster.shape()[1];
-  if (width % 2 != 0 || height % 2 != 0) {
-    throw std::runtime_error("fftShift() only works with even sizes.");
-  }
-  const long halfWidth = raster.shape()[0] / 2;
-  const long halfHeight = raster.shape()[1] / 2;
-
-  for (long y = 0; y < halfHeight; ++y) {
-
-    // Swap UL with LR
-    auto ulBegin = &raster[{0, y}];
-    auto ulEnd = ulBegin + halfWidth;
-    auto lrBegin = &raster[{halfWidth, y + halfHeight}];
-    swapRanges(ulBegin, ulEnd, lrBegin);
-
-    // Swap UR and LL
-    auto urBegin = ulEnd;
-    auto urEnd = urBegin + halfWidth;
-    auto llBegin = &raster[{0, y + halfHeight}];
-    swapRanges(urBegin, urEnd, llBegin);
-  }
-
-  return raster;
-}
-
 /**
  * @brief Save as a SIF file.
  * @details
@@ -110,16 +75,19 @@ void saveSif(const TRaster& raster, const std::string& filename) {
  */
 struct MonochromaticData {
 
+  double lambda;
   double minusTwoPiOverLambda;
   std::vector<double> alphas;
   Fourier::ComplexDft pupilToPsf;
   Fits::PtrRaster<std::complex<double>> pupil;
   Fits::PtrRaster<std::complex<double>> amplitude;
-  Fits::VecRaster<double> intensity;
+  Fourier::RealDft psfToMtf; // Its input buffer holds the intensity
+  Fits::PtrRaster<double> intensity;
 
-  MonochromaticData(double lambda, long maskSide, std::vector<double> alphaGuesses) :
-      minusTwoPiOverLambda(-2 * 3.1415926 / lambda), alphas(std::move(alphaGuesses)), pupilToPsf({maskSide, maskSide}),
-      pupil(pupilToPsf.inBuffer()), amplitude(pupilToPsf.outBuffer()), intensity({maskSide, maskSide}) {}
+  MonochromaticData(double wavelength, long maskSide, std::vector<double> alphaGuesses) :
+      lambda(wavelength), minusTwoPiOverLambda(-2 * 3.1415926 / wavelength), alphas(std::move(alphaGuesses)),
+      pupilToPsf({maskSide, maskSide}), pupil(pupilToPsf.inBuffer()), amplitude(pupilToPsf.outBuffer()),
+      psfToMtf({maskSide, maskSide}), intensity(psfToMtf.inBuffer()) {}
 
   std::complex<double> computeLocalPhase(double mask, const double* zernikes) {
     double sum = 0;
@@ -141,18 +109,11 @@ struct MonochromaticData {
     return pupil;
   }
 
-  template <typename TP, typename TZ>
-  Fits::PtrRaster<std::complex<double>>& evalSparsePupil(const TP& mask, const TZ& zernikes) {
-    auto maskData = mask.data();
-    auto zernikesData = zernikes.data();
-    const auto size = alphas.size();
-    for (auto it = pupil.begin(); it != pupil.end(); ++it, ++maskData, zernikesData += size) {
-      if (*maskData != 0) {
-        *it = computeLocalPhase(*maskData, zernikesData);
-      } else {
-        *it = 0;
-      }
-    }
+  /**
+   * @brief Evaluate the pupil over the support only, from the precomputed OPD, into the DFT input buffer.
+   */
+  Fits::PtrRaster<std::complex<double>>& evalSparsePupil(const Fourier::PupilPhase& phase) {
+    phase.evalAmplitude(lambda, pupil);
     return pupil;
   }
 
@@ -161,12 +122,8 @@ struct MonochromaticData {
     return amplitude;
   }
 
-  Fits::VecRaster<double>& evalIntensity() {
-    intensity.generate(
-        [](const auto& amp) {
-          return std::norm(amp);
-        },
-        amplitude);
+  Fits::PtrRaster<double>& evalIntensity() {
+    pupilToPsf.pipe(psfToMtf, Fourier::Norm2());
     return intensity;
   }
 };
@@ -184,6 +141,7 @@ public:
     options.named("mask", value<std::string>()->default_value("/tmp/mask.fits"), "Pupil mask file");
     options.named("zernike", value<std::string>()->default_value("/tmp/zernike.fits"), "Zernike polynomials file");
     options.named("psf", value<std::string>()->default_value("/tmp/psf.fits"), "PSF file");
+    options.named("cache", value<std::string>()->default_value("/tmp"), "Zernike polynomials cache directory");
 
     options.flag("sparse", "Compute pupil only where mask is not null");
     return options.asPair();
@@ -197,6 +155,7 @@ public:
     const auto maskFilename = args["mask"].as<std::string>();
     const auto zernikeFilename = args["zernike"].as<std::string>();
     const auto psfFilename = args["psf"].as<std::string>();
+    const auto cacheDirectory = args["cache"].as<std::string>();
     const auto sparse = args["sparse"].as<bool>();
 
     using Chrono = Fits::Validation::Chronometer<std::chrono::milliseconds>;
@@ -209,10 +168,14 @@ public:
     chrono.stop();
     logger.info() << "  " << chrono.last().count() << "ms";
     saveSif(pupil, maskFilename);
+    const bool centered = maskSide % 2 == 0;
+    if (centered) {
+      Fourier::checkerboard(pupil); // The PSF will come out centered, for free
+    }
 
-    logger.info("Generating Zernike polynomials...");
+    logger.info("Loading or generating Zernike polynomials...");
     chrono.start();
-    auto zernike = Zernike::ansiCube(maskSide, alphaCount);
+    auto zernike = Zernike::cachedAnsiBasis(maskSide, alphaCount, cacheDirectory);
     chrono.stop();
     logger.info() << "  " << chrono.last().count() << "ms";
     Fits::VecRaster<double, 3> zernikeDisp({maskSide, maskSide, alphaCount});
@@ -232,17 +195,31 @@ public:
       logger.debug() << "    " << a;
     }
 
+    logger.info("Indexing pupil support...");
+    chrono.start();
+    const auto support = sparse ? Fourier::SparsePupil(pupil, zernike) : Fourier::SparsePupil(pupil);
+    chrono.stop();
+    logger.info() << "  " << chrono.last().count() << "ms";
+    logger.info() << "  Fill factor: " << support.fillFactor();
+
     logger.info("Planning DFT and allocating memory...");
     chrono.start();
     MonochromaticData data(.500, maskSide, alphas);
     chrono.stop();
     logger.info() << "  " << chrono.last().count() << "ms";
 
-    chrono.start();
     if (sparse) {
-      logger.info("Computing pupil amplitude over non zero points (complex exp)...");
-      data.evalSparsePupil(pupil, zernike);
+      logger.info("Computing OPD over non zero points (Zernike GEMV)...");
+      chrono.start();
+      Fourier::PupilPhase phase(support);
+      phase.evalOpd(alphas);
+      chrono.stop();
+      logger.info() << "  " << chrono.last().count() << "ms";
+      logger.info("Computing pupil amplitude over non zero points (sincos)...");
+      chrono.start();
+      data.evalSparsePupil(phase);
     } else {
+      chrono.start();
       logger.info("Computing pupil amplitude over all points (complex exp)...");
       data.evalCompletePupil(pupil, zernike);
     }
@@ -260,7 +237,13 @@ public:
     data.evalIntensity();
     chrono.stop();
     logger.info() << "  " << chrono.last().count() << "ms";
-    saveSif(fftShift(data.intensity), psfFilename);
+    if (centered) {
+      saveSif(data.intensity, psfFilename);
+    } else if (psfFilename != "") {
+      Fits::VecRaster<double> psf(data.intensity.shape());
+      Fourier::centerCrop(data.intensity, psf);
+      saveSif(psf, psfFilename);
+    }
 
     logger.info("Done.");
     return ExitCode::OK;
@@ -21,10 +21,11 @@
 #include "EleFitsUtils/ProgramOptions.h"
 #include "EleFitsValidation/Chronometer.h"
 #include "EleFourier/Dft.h"
+#include "EleFourier/DftGraph.h"
+#include "EleFourier/MappedFits.h"
 #include "ElementsKernel/ProgramHeaders.h"
 
 #include <chrono>
-#include <functional>
 #include <map>
 #include <string>
 
@@ -39,6 +40,8 @@ public:
   std::pair<OptionsDescription, PositionalOptionsDescription> defineProgramArguments() override {
     Fits::ProgramOptions options("Convolve via DFT.");
     options.positional("filename", value<std::string>()->default_value("/tmp/data.fits"), "File name");
+    options.flag("mmap", "Read images through memory mapping instead of CFITSIO (uncompressed images only)");
+    options.flag("graph", "Run the transforms as a task graph, such that independent branches overlap");
     return options.asPair();
   }
 
@@ -46,6 +49,8 @@ public:
 
     Elements::Logging logger = Elements::Logging::getLogger("EleFourierTutorial");
     const auto filename = args["filename"].as<std::string>();
+    const auto mmap = args["mmap"].as<bool>();
+    const auto graph = args["graph"].as<bool>();
     Fits::Validation::Chronometer<std::chrono::milliseconds> chrono;
 
     // Open Fits file
@@ -91,65 +96,93 @@ public:
     logger.info() << "Reading filter and images...";
     chrono.start();
     auto lvalueRaster = filterDft.inBuffer(); // We cannot readTo() rvalues
-    primary.readTo(lvalueRaster);
-    for (long i = 0; i < count; ++i) {
-      lvalueRaster = imageDft.inBuffer(i);
-      f.access<Fits::ImageRaster>(i + 1).readTo(lvalueRaster);
+    if (mmap) {
+      MappedFits mapped(filename); // Decode straight into the buffers
+      mapped.readTo(0, lvalueRaster);
+      for (long i = 0; i < count; ++i) {
+        lvalueRaster = imageDft.inBuffer(i);
+        mapped.readTo(i + 1, lvalueRaster);
+      }
+    } else {
+      primary.readTo(lvalueRaster);
+      for (long i = 0; i < count; ++i) {
+        lvalueRaster = imageDft.inBuffer(i);
+        f.access<Fits::ImageRaster>(i + 1).readTo(lvalueRaster);
+      }
     }
     chrono.stop();
     logger.info() << "  Done in: " << chrono.last().count() << "ms";
 
-    // Fourier transform
-    logger.info() << "Applying DFT to filter...";
-    chrono.start();
-    filterDft.transform();
-    chrono.stop();
-    logger.info() << "  Done in: " << chrono.last().count() << "ms";
-    logger.info() << "Applying DFT to images...";
-    chrono.start();
-    imageDft.transform();
-    chrono.stop();
-    logger.info() << "  Done in: " << chrono.last().count() << "ms";
-
-    // Dummy direct + inverse transforms for demonstration
-    logger.info() << "Applying dummy complex DFT...";
-    chrono.start();
-    dummyDft.transform();
-    chrono.stop();
-    logger.info() << "  Done in: " << chrono.last().count() << "ms";
-    logger.info() << "Applying normalized inverse dummy complex DFT...";
-    chrono.start();
-    dummyInverseDft.transform();
-    chrono.stop();
-    logger.info() << "  Done in: " << chrono.last().count() << "ms";
-    logger.info() << "Normalizing...";
-    chrono.start();
-    dummyInverseDft.normalize();
-    chrono.stop();
-    logger.info() << "  Done in: " << chrono.last().count() << "ms";
-
-    // Perform convolution (frequency-domain multiplication into dft0 and dft1)
-    logger.info() << "Convolving...";
-    chrono.start();
-    auto filterCoefficients = filterDft.outBuffer();
-    for (long i = 0; i < count; ++i) {
-      auto out = imageDft.outBuffer(i);
-      std::transform(out.begin(), out.end(), filterCoefficients.begin(), out.begin(), std::multiplies<>());
+    // Let the task graph order the transforms from their buffers, and overlap the filter and image branches
+    if (graph) {
+      logger.info() << "Building task graph...";
+      DftGraph dag;
+      dag.transform(filterDft, "filter DFT");
+      dag.transform(imageDft, "image DFT"); // Independent of the filter DFT
+      dag.transform(dummyDft, "dummy DFT");
+      dag.transform(dummyInverseDft, "dummy inverse DFT");
+      dag.add(
+          "convolve",
+          [&](long) {
+            dummyInverseDft.normalizeLazily(); // Output is imageDft's: applied by the multiplication below
+            imageDft.normalizeLazily().multiply(filterDft.outBuffer());
+          },
+          {filterDft.outStack().data()},
+          {imageDft.outStack().data()});
+      dag.transform(imageInverseDft, "image inverse DFT");
+      logger.info() << "Running task graph...";
+      chrono.start();
+      TaskPool pool(2);
+      dag.run(pool).get();
+      chrono.stop();
+      logger.info() << "  Done in: " << chrono.last().count() << "ms";
+    } else {
+
+      // Fourier transform
+      logger.info() << "Applying DFT to filter...";
+      chrono.start();
+      filterDft.transform();
+      chrono.stop();
+      logger.info() << "  Done in: " << chrono.last().count() << "ms";
+      logger.info() << "Applying DFT to images...";
+      chrono.start();
+      imageDft.transform();
+      chrono.stop();
+      logger.info() << "  Done in: " << chrono.last().count() << "ms";
+
+      // Dummy direct + inverse transforms for demonstration
+      logger.info() << "Applying dummy complex DFT...";
+      chrono.start();
+      dummyDft.transform();
+      chrono.stop();
+      logger.info() << "  Done in: " << chrono.last().count() << "ms";
+      logger.info() << "Applying normalized inverse dummy complex DFT...";
+      chrono.start();
+      dummyInverseDft.transform();
+      chrono.stop();
+      logger.info() << "  Done in: " << chrono.last().count() << "ms";
+      logger.info() << "Normalizing...";
+      chrono.start();
+      dummyInverseDft.normalize();
+      chrono.stop();
+      logger.info() << "  Done in: " << chrono.last().count() << "ms";
+
+      // Perform convolution (frequency-domain multiplication into dft0 and dft1)
+      // The lazy normalization is applied by the multiplication, in the same pass
+      logger.info() << "Convolving and normalizing...";
+      chrono.start();
+      const auto filterCoefficients = filterDft.outBuffer();
+      imageDft.normalizeLazily().multiply(filterCoefficients);
+      chrono.stop();
+      logger.info() << "  Done in: " << chrono.last().count() << "ms";
+
+      // Inverse Fourier transform (in-place, overwrites space-domain data)
+      logger.info() << "Applying inverse DFTs...";
+      chrono.start();
+      imageInverseDft.transform();
+      chrono.stop();
+      logger.info() << "  Done in: " << chrono.last().count() << "ms";
     }
-    chrono.stop();
-    logger.info() << "  Done in: " << chrono.last().count() << "ms";
-
-    // Inverse Fourier transform (in-place, overwrites space-domain data)
-    logger.info() << "Applying inverse DFTs...";
-    chrono.start();
-    imageInverseDft.transform();
-    chrono.stop();
-    logger.info() << "  Done in: " << chrono.last().count() << "ms";
-    logger.info() << "Normalizing...";
-    chrono.start();
-    imageInverseDft.normalize();
-    chrono.stop();
-    logger.info() << "  Done in: " << chrono.last().count() << "ms";
 
     logger.info() << "Writing images...";
     chrono.start();
@@ -0,0 +1,132 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFitsUtils/ProgramOptions.h"
+#include "EleFitsValidation/Chronometer.h"
+#include "EleFourier/Dft.h"
+#include "ElementsKernel/ProgramHeaders.h"
+
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using boost::program_options::value;
+
+using namespace Euclid;
+using namespace Fourier;
+
+static auto logger = Elements::Logging::getLogger("EleFourierWisdom");
+
+/**
+ * @brief Parse a `<width>x<height>[x<count>]` string.
+ */
+std::pair<Fits::Position<2>, long> parseShape(const std::string& str) {
+  std::istringstream iss(str);
+  long width = 0;
+  long height = 0;
+  long count = 1;
+  char sep = 0;
+  iss >> width >> sep >> height;
+  if (not iss || sep != 'x') {
+    throw std::runtime_error("Cannot parse shape: " + str);
+  }
+  if (iss >> sep) {
+    if (sep != 'x' || not(iss >> count)) {
+      throw std::runtime_error("Cannot parse shape: " + str);
+    }
+  }
+  return {{width, height}, count};
+}
+
+/**
+ * @brief Plan a transform and its inverse.
+ */
+template <typename TPlan>
+void warmUp(const Fits::Position<2>& shape, long count, const PlanningPolicy& policy) {
+  Fits::Validation::Chronometer<std::chrono::milliseconds> chrono;
+  logger.info() << "Planning " << FftwWisdom::key<typename TPlan::Type>(shape, count, policy) << "...";
+  chrono.start();
+  TPlan plan(shape, count, policy);
+  plan.inverse();
+  chrono.stop();
+  logger.info() << "  Done in: " << chrono.last().count() << "ms";
+}
+
+/**
+ * Program class.
+ */
+class EleFourierWisdom : public Elements::Program {
+
+public:
+  std::pair<OptionsDescription, PositionalOptionsDescription> defineProgramArguments() override {
+    Fits::ProgramOptions options("Pre-warm the FFTW wisdom for a list of shapes.");
+    options.named(
+        "shape",
+        value<std::vector<std::string>>()->multitoken()->default_value({"1024x1024"}, "1024x1024"),
+        "Logical shapes as <width>x<height>[x<count>]");
+    options.named("type", value<std::string>()->default_value("all"), "Transform type (real, complex or all)");
+    options.named(
+        "rigor",
+        value<std::string>()->default_value("Measure"),
+        "Planning rigor (Estimate, Measure, Patient or Exhaustive)");
+    options.named("timeout", value<double>()->default_value(-1), "Planning time limit per plan in s (-1 = none)");
+    options.named("threads", value<long>()->default_value(1), "Number of FFTW threads per plan (0 = OpenMP's max)");
+    options.flag("inplace", "Plan in-place transforms");
+    options.named("dir", value<std::string>()->default_value("/tmp/wisdom"), "Wisdom directory");
+    return options.asPair();
+  }
+
+  Elements::ExitCode mainMethod(std::map<std::string, VariableValue>& args) override {
+
+    const auto shapes = args["shape"].as<std::vector<std::string>>();
+    const auto type = args["type"].as<std::string>();
+    PlanningPolicy policy(PlanningPolicy::parseRigor(args["rigor"].as<std::string>()), args["timeout"].as<double>());
+    const auto threads = args["threads"].as<long>();
+    if (threads != 1) {
+      policy.parallelize(threads);
+    }
+    if (args["inplace"].as<bool>()) {
+      policy.inPlace();
+    }
+    const auto directory = args["dir"].as<std::string>();
+
+    auto& wisdom = FftwWisdom::instance();
+    wisdom.enable(directory, false);
+    logger.info() << "Wisdom directory: " << directory << '/' << FftwWisdom::hostname();
+
+    for (const auto& s : shapes) {
+      const auto shapeCount = parseShape(s);
+      if (type == "real" || type == "all") {
+        warmUp<RealDft>(shapeCount.first, shapeCount.second, policy);
+      }
+      if (type == "complex" || type == "all") {
+        warmUp<ComplexDft>(shapeCount.first, shapeCount.second, policy);
+      }
+    }
+
+    const auto written = wisdom.save();
+    logger.info() << "Wrote " << written << " wisdom file(s).";
+
+    return Elements::ExitCode::OK;
+  }
+};
+
+MAIN_FOR(EleFourierWisdom)
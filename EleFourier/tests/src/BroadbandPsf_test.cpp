@@ -0,0 +1,139 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/BroadbandPsf.h"
+
+#include <boost/test/unit_test.hpp>
+#include <numeric> // accumulate
+
+using namespace Euclid;
+using namespace Fourier;
+
+/**
+ * @brief A deterministic pupil function.
+ */
+void fillPupil(long p, long l, Fits::PtrRaster<std::complex<double>>& pupil) {
+  for (long y = 0; y < pupil.shape()[1]; ++y) {
+    for (long x = 0; x < pupil.shape()[0]; ++x) {
+      pupil[{x, y}] = std::complex<double>((x + 2 * y + p) % 5, (3 * x + y + l) % 7 - 3.);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(BroadbandPsf_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(serial_reference_test) {
+  const Fits::Position<2> pupilShape {8, 8};
+  const Fits::Position<2> broadbandShape {4, 4};
+  const long params = 2;
+  const long lambdas = 3;
+  BroadbandPsf engine(pupilShape, broadbandShape, 3);
+  BOOST_TEST(engine.threads() == 3);
+  const auto psfs = engine.run(params, lambdas, fillPupil);
+  BOOST_TEST(psfs.shape()[0] == broadbandShape[0]);
+  BOOST_TEST(psfs.shape()[1] == broadbandShape[1]);
+  BOOST_TEST(psfs.shape()[2] == params);
+
+  ComplexDft pupilToPsf(pupilShape);
+  PrunedRealDft psfToMtf(pupilShape, {0, 0}, pupilShape, 2);
+  RealDft::Inverse mtfToBroadband(broadbandShape);
+  for (long p = 0; p < params; ++p) {
+    auto sum = mtfToBroadband.inBuffer();
+    std::fill(sum.begin(), sum.end(), std::complex<double>(0));
+    for (long l = 0; l < lambdas; ++l) {
+      auto pupil = pupilToPsf.inBuffer();
+      fillPupil(p, l, pupil);
+      const auto amplitude = pupilToPsf.transform().outBuffer();
+      auto intensity = psfToMtf.window();
+      for (long i = 0; i < intensity.size(); ++i) {
+        intensity.data()[i] = std::norm(amplitude.data()[i]);
+      }
+      const auto mtf = psfToMtf.transform().outBuffer();
+      for (long i = 0; i < sum.size(); ++i) {
+        sum.data()[i] += mtf.data()[i];
+      }
+    }
+    const auto expected = mtfToBroadband.transform().normalize().outBuffer();
+    for (long y = 0; y < broadbandShape[1]; ++y) {
+      for (long x = 0; x < broadbandShape[0]; ++x) {
+        BOOST_TEST((psfs[{x, y, p}]) == (expected[{x, y}]), boost::test_tools::tolerance(1e-9));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(item_count_test) {
+  BroadbandPsf engine({8, 8}, {8, 8}, 2);
+  engine.run(5, 7, fillPupil);
+  const auto& items = engine.itemCounts();
+  BOOST_TEST(items.size() == 2);
+  BOOST_TEST(std::accumulate(items.begin(), items.end(), 0L) == 35);
+}
+
+BOOST_AUTO_TEST_CASE(split_range_test) {
+  const long params = 3;
+  const long lambdas = 4;
+  BroadbandPsf engine({8, 8}, {4, 4}, 2);
+  const auto expected = engine.run(params, lambdas, fillPupil);
+  auto sums = engine.accumulate(params, lambdas, 0, 5, fillPupil); // Parameters 0 and 1
+  const auto tail = engine.accumulate(params, lambdas, 5, params * lambdas, fillPupil); // Parameters 1 and 2
+  BOOST_TEST((BroadbandPsf::paramRange(lambdas, 5, params * lambdas) == std::pair<long, long>(1, 3)));
+  BOOST_TEST(sums.size() == 2);
+  BOOST_TEST(tail.size() == 2);
+  BOOST_TEST(sums[0].size() == std::size_t(engine.mtfSize()));
+  for (long i = 0; i < engine.mtfSize(); ++i) {
+    sums[1][i] += tail[0][i];
+  }
+  sums.push_back(tail[1]);
+  const auto psfs = engine.integrate(sums);
+  for (long i = 0; i < psfs.size(); ++i) {
+    BOOST_TEST(psfs.data()[i] == expected.data()[i], boost::test_tools::tolerance(1e-9));
+  }
+  BOOST_CHECK_THROW(engine.accumulate(params, lambdas, 5, 13, fillPupil), std::invalid_argument);
+  sums[1].pop_back();
+  BOOST_CHECK_THROW(engine.integrate(sums), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(pupil_exception_test) {
+  BroadbandPsf engine({8, 8}, {4, 4}, 2);
+  BOOST_CHECK_THROW(
+      engine.run(
+          2,
+          3,
+          [](long p, long l, Fits::PtrRaster<std::complex<double>>& pupil) {
+            if (p == 1 && l == 1) {
+              throw std::runtime_error("Pupil failure");
+            }
+            fillPupil(p, l, pupil);
+          }),
+      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(shape_ratio_test) {
+  BOOST_CHECK_THROW(BroadbandPsf({8, 8}, {3, 3}), std::invalid_argument);
+  BOOST_CHECK_THROW(BroadbandPsf({8, 8}, {4, 2}), std::invalid_argument);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
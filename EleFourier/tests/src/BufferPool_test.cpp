@@ -0,0 +1,110 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/BufferPool.h"
+#include "EleFourier/Dft.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(BufferPool_test)
+
+BOOST_AUTO_TEST_CASE(recycling_test) {
+  BufferPool pool;
+  double* data = pool.allocate<double>(100);
+  BOOST_TEST(data);
+  BOOST_TEST(pool.misses() == 1);
+  pool.release(data, 100);
+  BOOST_TEST(pool.cachedBytes() == 100 * sizeof(double));
+  BOOST_TEST(pool.allocate<double>(100) == data);
+  BOOST_TEST(pool.hits() == 1);
+  BOOST_TEST(pool.cachedBytes() == 0);
+  double* other = pool.allocate<double>(50); // Different size
+  BOOST_TEST(other != data);
+  BOOST_TEST(pool.misses() == 2);
+  pool.release(data, 100);
+  pool.release(other, 50);
+  pool.purge();
+  BOOST_TEST(pool.cachedBytes() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(first_touch_test) {
+  BOOST_TEST(not BufferPool().firstTouch());
+  BufferPool pool(BufferPool::defaultCapacity, true);
+  BOOST_TEST(pool.firstTouch());
+  double* data = pool.allocate<double>(100);
+  BOOST_TEST(data[99] == 0); // Fresh buffers are zero-filled
+  pool.release(data, 100);
+}
+
+BOOST_AUTO_TEST_CASE(precision_separation_test) {
+  BufferPool pool;
+  double* d = pool.allocate<double>(10);
+  pool.release(d, 10);
+  float* f = pool.allocate<float>(20); // Same size in bytes, but different precision
+  BOOST_TEST(pool.hits() == 0);
+  pool.release(f, 20);
+  BOOST_TEST(pool.allocate<std::complex<double>>(5) == reinterpret_cast<std::complex<double>*>(d));
+}
+
+BOOST_AUTO_TEST_CASE(capacity_test) {
+  BufferPool pool(100 * sizeof(double));
+  double* a = pool.allocate<double>(100);
+  double* b = pool.allocate<double>(100);
+  pool.release(a, 100);
+  pool.release(b, 100); // Over capacity: freed
+  BOOST_TEST(pool.cachedBytes() == 100 * sizeof(double));
+  pool.capacity(0);
+  BOOST_TEST(pool.cachedBytes() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(plan_recycling_test) {
+  const Fits::Position<2> shape {8, 6};
+  auto pool = std::make_shared<BufferPool>();
+  const double* in = nullptr;
+  {
+    RealDft dft(shape, 2, PlanningPolicy(), pool);
+    auto inverse = dft.inverse(); // Shares the buffers, does not allocate
+    in = dft.inBuffer().data();
+    BOOST_TEST(pool->misses() == 2);
+  }
+  BOOST_TEST(pool->cachedBytes() > 0);
+  RealDft dft(shape, 2, PlanningPolicy(), pool);
+  BOOST_TEST(dft.inBuffer().data() == in);
+  BOOST_TEST(pool->hits() == 2);
+  BOOST_TEST(pool->misses() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(local_arena_test) {
+  const auto pool = BufferPool::local();
+  BOOST_TEST(pool == BufferPool::local());
+  const long misses = pool->misses();
+  RealDft unpooled({4, 4}); // Not pooled by default
+  BOOST_TEST(unpooled.inBuffer().data());
+  BOOST_TEST(pool->misses() == misses);
+  BOOST_TEST(pool->cachedBytes() == 0);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
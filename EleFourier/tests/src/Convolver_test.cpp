@@ -0,0 +1,127 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Convolver.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Convolver_test)
+
+//-----------------------------------------------------------------------------
+
+Fits::VecRaster<double> makeKernel() {
+  Fits::VecRaster<double> kernel({3, 3});
+  for (long i = 0; i < kernel.size(); ++i) {
+    kernel.data()[i] = 1. + i % 4;
+  }
+  return kernel;
+}
+
+template <typename TRaster>
+void fillImages(TRaster& raster) {
+  for (long i = 0; i < raster.size(); ++i) {
+    raster.data()[i] = (i * 7) % 11 - 3.;
+  }
+}
+
+/**
+ * @brief Naive centered convolution of a plane, either periodic or with zero boundaries.
+ */
+Fits::VecRaster<double> naive(const double* image, const Fits::Position<2>& shape, bool periodic) {
+  const auto kernel = makeKernel();
+  Fits::VecRaster<double> out(shape);
+  for (long y = 0; y < shape[1]; ++y) {
+    for (long x = 0; x < shape[0]; ++x) {
+      double sum = 0;
+      for (long j = 0; j < 3; ++j) {
+        for (long i = 0; i < 3; ++i) {
+          long ix = x - (i - 1);
+          long iy = y - (j - 1);
+          if (periodic) {
+            ix = (ix + shape[0]) % shape[0];
+            iy = (iy + shape[1]) % shape[1];
+          } else if (ix < 0 || ix >= shape[0] || iy < 0 || iy >= shape[1]) {
+            continue;
+          }
+          sum += kernel[{i, j}] * image[ix + iy * shape[0]];
+        }
+      }
+      out[{x, y}] = sum;
+    }
+  }
+  return out;
+}
+
+BOOST_AUTO_TEST_CASE(filter_cache_test) {
+  Convolver convolver({8, 6}, 2);
+  BOOST_TEST(not convolver.hasFilter("psf"));
+  const auto& spectrum = convolver.addFilter("psf", makeKernel());
+  BOOST_TEST(convolver.hasFilter("psf"));
+  BOOST_TEST((spectrum.shape() == Fits::Position<2>({5, 6})));
+  BOOST_TEST(&convolver.spectrum("psf") == &spectrum);
+  convolver.removeFilter("psf");
+  BOOST_TEST(not convolver.hasFilter("psf"));
+  BOOST_CHECK_THROW(convolver.spectrum("psf"), std::invalid_argument);
+  Fits::VecRaster<double> huge({9, 6});
+  BOOST_CHECK_THROW(convolver.addFilter("huge", huge), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(batched_periodic_test) {
+  const Fits::Position<2> shape {8, 6};
+  Convolver convolver(shape, 2);
+  convolver.addFilter("psf", makeKernel());
+  Fits::VecRaster<double, 3> stack({shape[0], shape[1], 5}); // 2 full batches and a partial one
+  fillImages(stack);
+  const auto input = stack;
+  convolver.convolveStack("psf", stack);
+  BOOST_TEST(convolver.count() == 5);
+  BOOST_TEST(convolver.throughput() > 0);
+  for (long i = 0; i < 5; ++i) {
+    const auto expected = naive(input.data() + i * shapeSize(shape), shape, true);
+    for (long j = 0; j < expected.size(); ++j) {
+      BOOST_TEST(std::abs(stack.data()[i * shapeSize(shape) + j] - expected.data()[j]) < 1.e-9);
+    }
+  }
+  convolver.resetStatistics();
+  BOOST_TEST(convolver.count() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_save_test) {
+  Convolver convolver({8, 8}, 3, PlanningPolicy().inPlace());
+  convolver.addFilter("psf", makeKernel());
+  const Fits::Position<2> shape {13, 9}; // Not a multiple of the step
+  Fits::VecRaster<double> image(shape);
+  fillImages(image);
+  Fits::VecRaster<double> result(shape);
+  convolver.convolveTiled("psf", image, result);
+  BOOST_TEST(convolver.count() == 1);
+  const auto expected = naive(image.data(), shape, false);
+  for (long j = 0; j < expected.size(); ++j) {
+    BOOST_TEST(std::abs(result.data()[j] - expected.data()[j]) < 1.e-9);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,243 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/DftGraph.h"
+
+#include <atomic>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(DftGraph_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(task_pool_test) {
+  std::atomic<long> sum(0);
+  std::vector<std::future<void>> futures;
+  {
+    TaskPool pool(3);
+    BOOST_TEST(pool.threads() == 3);
+    for (long i = 1; i <= 10; ++i) {
+      futures.push_back(pool.submit([&sum, i]() {
+        sum += i;
+      }));
+    }
+    auto failing = pool.submit([]() {
+      throw std::runtime_error("Expected");
+    });
+    BOOST_CHECK_THROW(failing.get(), std::runtime_error);
+  } // Drains the queue
+  BOOST_TEST(sum == 55);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_dependencies_test) {
+  int a = 0;
+  int b = 0;
+  int c = 0;
+  DftGraph graph;
+  auto noop = [](long) {};
+  const auto writeA = graph.add("writeA", noop, {}, {&a});
+  const auto writeB = graph.add("writeB", noop, {}, {&b});
+  const auto readA = graph.add("readA", noop, {&a}, {&c});
+  const auto readAB = graph.add("readAB", noop, {&a, &b}, {});
+  const auto overwriteA = graph.add("overwriteA", noop, {}, {&a});
+  BOOST_TEST(graph.size() == 5);
+  BOOST_TEST(graph.name(readA) == "readA");
+  BOOST_TEST(graph.dependencies(writeA).empty());
+  BOOST_TEST(graph.dependencies(writeB).empty()); // Independent branch
+  BOOST_TEST(graph.dependencies(readA) == std::vector<long>({writeA}));
+  BOOST_TEST(graph.dependencies(readAB) == std::vector<long>({writeA, writeB}));
+  BOOST_TEST(graph.dependencies(overwriteA) == std::vector<long>({writeA, readA, readAB}));
+  graph.after(writeB, writeA);
+  BOOST_TEST(graph.dependencies(writeB) == std::vector<long>({writeA}));
+  BOOST_CHECK_THROW(graph.after(writeA, writeB), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(execution_order_test) {
+  int a = 0;
+  int b = 0;
+  std::mutex mutex;
+  std::vector<long> order;
+  auto log = [&](long node) {
+    return [&, node](long) {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(node);
+    };
+  };
+  DftGraph graph;
+  graph.add("a", log(0), {}, {&a});
+  graph.add("b", log(1), {}, {&b});
+  graph.add("ab", log(2), {&a, &b}, {&a});
+  graph.add("a", log(3), {&a}, {});
+  TaskPool pool(2);
+  for (long run = 0; run < 3; ++run) {
+    order.clear();
+    graph.run(pool, run).get();
+    BOOST_TEST(order.size() == 4);
+    BOOST_TEST(order[2] == 2);
+    BOOST_TEST(order[3] == 3);
+  }
+  BOOST_CHECK_NO_THROW(DftGraph().run(pool).get());
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_branches_test) {
+  int a = 0;
+  int b = 0;
+  std::atomic<long> running(0);
+  std::atomic<long> maxRunning(0);
+  auto task = [&](long) {
+    const long r = ++running;
+    long m = maxRunning;
+    while (r > m && not maxRunning.compare_exchange_weak(m, r)) {}
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    --running;
+  };
+  DftGraph graph;
+  graph.add("a", task, {}, {&a});
+  graph.add("b", task, {}, {&b});
+  TaskPool pool(2);
+  graph.run(pool).get();
+  BOOST_TEST(maxRunning == 2);
+}
+
+BOOST_AUTO_TEST_CASE(exception_test) {
+  int a = 0;
+  std::atomic<long> calls(0);
+  DftGraph graph;
+  graph.add(
+      "throw",
+      [&](long) {
+        ++calls;
+        throw std::runtime_error("Expected");
+      },
+      {},
+      {&a});
+  graph.add(
+      "skipped",
+      [&](long) {
+        ++calls;
+      },
+      {&a},
+      {});
+  TaskPool pool(2);
+  BOOST_CHECK_THROW(graph.run(pool).get(), std::runtime_error);
+  BOOST_TEST(calls == 1);
+  BOOST_CHECK_THROW(DftGraph::stream(pool, {graph, graph}, 4), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(convolution_test) {
+  const Fits::Position<2> shape {8, 6};
+  const long count = 3;
+  RealDft filterDft(shape);
+  RealDft imageDft(shape, count);
+  auto inverse = imageDft.inverse();
+  RealDft refFilterDft(shape);
+  RealDft refImageDft(shape, count);
+  auto refInverse = refImageDft.inverse();
+  for (auto* dft : {&filterDft, &refFilterDft}) {
+    auto in = dft->inBuffer();
+    for (const auto& p : in.domain()) {
+      in[p] = p[0] == 1 && p[1] == 0 ? 1 : 0; // Shift by one pixel
+    }
+  }
+  for (auto* dft : {&imageDft, &refImageDft}) {
+    auto in = dft->inStack();
+    for (const auto& p : in.domain()) {
+      in[p] = p[0] + 10 * p[1] + 100 * p[2];
+    }
+  }
+
+  // Synchronous reference
+  refFilterDft.transform();
+  refImageDft.transform().normalizeLazily().multiply(refFilterDft.outBuffer());
+  refInverse.transform();
+
+  // Graph
+  DftGraph graph;
+  const auto filterNode = graph.transform(filterDft, "filter");
+  const auto imageNode = graph.transform(imageDft, "image");
+  const auto convolveNode = graph.add(
+      "convolve",
+      [&](long) {
+        imageDft.normalizeLazily().multiply(filterDft.outBuffer());
+      },
+      {filterDft.outStack().data()},
+      {imageDft.outStack().data()});
+  const auto inverseNode = graph.transform(inverse, "inverse");
+  BOOST_TEST(graph.dependencies(imageNode).empty());
+  BOOST_TEST(graph.dependencies(convolveNode) == std::vector<long>({filterNode, imageNode}));
+  BOOST_TEST(graph.dependencies(inverseNode) == std::vector<long>({imageNode, convolveNode}));
+  TaskPool pool(2);
+  graph.run(pool).get();
+
+  const auto expected = refInverse.outStack();
+  const auto result = inverse.outStack();
+  for (const auto& p : result.domain()) {
+    BOOST_TEST(std::abs((result[p]) - (expected[p])) < 1.e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(stream_test) {
+  const Fits::Position<2> shape {4, 4};
+  const long count = 7;
+  std::vector<ComplexDft> plans;
+  plans.emplace_back(shape);
+  plans.emplace_back(shape);
+  std::vector<std::complex<double>> sums(count);
+  std::vector<DftGraph> graphs(plans.size());
+  for (std::size_t i = 0; i < plans.size(); ++i) {
+    auto& plan = plans[i];
+    auto& graph = graphs[i];
+    graph.add(
+        "read",
+        [&plan](long k) {
+          auto in = plan.inBuffer();
+          std::fill(in.begin(), in.end(), std::complex<double>(k));
+        },
+        {},
+        {plan.inStack().data()});
+    graph.transform(plan);
+    graph.add(
+        "write",
+        [&plan, &sums](long k) {
+          sums[k] = plan.outBuffer()[{0, 0}];
+        },
+        {plan.outStack().data()},
+        {});
+  }
+  TaskPool pool(3);
+  BOOST_TEST(DftGraph::stream(pool, graphs, count) == count);
+  for (long k = 0; k < count; ++k) {
+    BOOST_TEST(std::abs(sums[k] - std::complex<double>(16. * k)) < 1.e-9);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -17,9 +17,16 @@
  *
  */
 
-#include "EleFourier/DftPlan.h"
+#include "EleFourier/Dft.h"
 
+#include <algorithm> // fill
+#include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
+#include <type_traits>
+#include <vector>
+
+using namespace Euclid;
+using namespace Fourier;
 
 //-----------------------------------------------------------------------------
 
@@ -27,9 +34,460 @@ BOOST_AUTO_TEST_SUITE(DftPlan_test)
 
 //-----------------------------------------------------------------------------
 
-BOOST_AUTO_TEST_CASE(example_test) {
+BOOST_AUTO_TEST_CASE(policy_propagation_test) {
+  const Fits::Position<2> shape {4, 3};
+  const auto policy = PlanningPolicy::estimate();
+  RealDft dft(shape, 2, policy);
+  BOOST_TEST((dft.policy() == policy));
+  BOOST_TEST((dft.inverse().policy() == policy));
+  BOOST_TEST((dft.compose<ComplexDft>(dft.outShape()).policy() == policy));
+}
+
+BOOST_AUTO_TEST_CASE(default_policy_test) {
+  ComplexDft dft({4, 3});
+  BOOST_TEST((dft.policy() == PlanningPolicy::measure()));
+}
+
+BOOST_AUTO_TEST_CASE(multithreaded_round_trip_test) {
+  const Fits::Position<2> shape {5, 6};
+  const long count = 3;
+  RealDft dft(shape, count, PlanningPolicy().parallelize(2));
+  auto inverse = dft.inverse();
+  BOOST_TEST(inverse.policy().threads == 2);
+  for (long i = 0; i < count; ++i) {
+    auto signal = dft.inBuffer(i);
+    for (const auto& p : signal.domain()) {
+      signal[p] = 1 + p[0] + p[1] + i;
+    }
+  }
+  dft.transform();
+  inverse.transform().normalize();
+  for (long i = 0; i < count; ++i) {
+    const auto signal = inverse.outBuffer(i);
+    for (const auto& p : signal.domain()) {
+      const double expected = 1 + p[0] + p[1] + i;
+      BOOST_TEST(std::abs(signal[p] - expected) < 1.e-6 * expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(in_place_real_round_trip_test) {
+  const Fits::Position<2> shape {5, 4};
+  const long count = 3;
+  RealDft dft(shape, count, PlanningPolicy().inPlace());
+  auto inverse = dft.inverse();
+  const Fits::Position<2> padded {6, 4};
+  BOOST_TEST((dft.logicalShape() == shape));
+  BOOST_TEST((dft.inShape() == padded));
+  BOOST_TEST((dft.outShape() == Fits::Position<2>({3, 4})));
+  BOOST_TEST((inverse.outShape() == padded));
+  BOOST_TEST(static_cast<void*>(dft.inBuffer().data()) == static_cast<void*>(dft.outBuffer().data()));
+  BOOST_TEST(static_cast<void*>(inverse.outBuffer().data()) == static_cast<void*>(dft.inBuffer().data()));
+  for (long i = 0; i < count; ++i) {
+    auto signal = dft.inBuffer(i);
+    for (const auto& p : signal.domain()) {
+      signal[p] = p[0] < shape[0] ? 1 + p[0] + p[1] + i : 0;
+    }
+  }
+  dft.transform();
+  BOOST_TEST(std::abs(dft.outBuffer(1)[{0, 0}] - std::complex<double>(110, 0)) < 1.e-6); // Sum of plane 1
+  inverse.transform().normalize();
+  for (long i = 0; i < count; ++i) {
+    const auto signal = inverse.outBuffer(i);
+    for (const auto& p : signal.domain()) {
+      if (p[0] < shape[0]) { // Skip padding
+        const double expected = 1 + p[0] + p[1] + i;
+        BOOST_TEST(std::abs(signal[p] - expected) < 1.e-6 * expected);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(in_place_complex_compose_test) {
+  const Fits::Position<2> shape {4, 3};
+  RealDft dft(shape, 2, PlanningPolicy().inPlace());
+  auto complex = dft.compose<ComplexDft>(dft.outShape());
+  BOOST_TEST(complex.policy().isInPlace());
+  BOOST_TEST(static_cast<void*>(complex.inBuffer().data()) == static_cast<void*>(dft.outBuffer().data()));
+  BOOST_TEST(static_cast<void*>(complex.outBuffer().data()) == static_cast<void*>(dft.outBuffer().data()));
+  ComplexDft outOfPlace(shape);
+  ComplexDft inPlace(shape, 1, PlanningPolicy().inPlace());
+  for (const auto& p : outOfPlace.inBuffer().domain()) {
+    outOfPlace.inBuffer()[p] = inPlace.inBuffer()[p] = {1. + p[0], 2. - p[1]};
+  }
+  outOfPlace.transform();
+  inPlace.transform();
+  for (const auto& p : outOfPlace.outBuffer().domain()) {
+    BOOST_TEST(std::abs(outOfPlace.outBuffer()[p] - inPlace.outBuffer()[p]) < 1.e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(eager_normalization_test) {
+  const Fits::Position<2> shape {4, 3};
+  RealDft dft(shape);
+  auto signal = dft.inBuffer();
+  for (long i = 0; i < signal.size(); ++i) {
+    signal.data()[i] = 1. + i;
+  }
+  dft.transform().normalize();
+  BOOST_TEST(dft.pendingScale() == 1.);
+  BOOST_TEST(std::abs(dft.outBuffer()[{0, 0}] - std::complex<double>(6.5, 0.)) < 1.e-12); // Mean of 1..12
+  dft.scaleLazily(2).scale(3); // Pending factor applied in the same pass
+  BOOST_TEST(dft.pendingScale() == 1.);
+  BOOST_TEST(std::abs(dft.outBuffer()[{0, 0}] - std::complex<double>(39., 0.)) < 1.e-12);
+}
+
+BOOST_AUTO_TEST_CASE(lazy_normalization_test) {
+  const Fits::Position<2> shape {4, 3};
+  const double n = shapeSize(shape);
+  RealDft dft(shape);
+  auto inverse = dft.inverse();
+  auto signal = dft.inBuffer();
+  for (long i = 0; i < signal.size(); ++i) {
+    signal.data()[i] = 1. + i;
+  }
+  dft.transform().normalizeLazily();
+  BOOST_TEST(dft.pendingScale() == 1. / n);
+  const auto sum = dft.outStack().data()[0]; // Accessors do not apply the factor
+  BOOST_TEST(dft.pendingScale() == 1. / n);
+  BOOST_TEST(std::abs(sum - std::complex<double>(78., 0.)) < 1.e-12); // Sum of 1..12
+  dft.flush();
+  BOOST_TEST(dft.pendingScale() == 1.);
+  const auto dc = dft.outStack().data()[0];
+  BOOST_TEST(std::abs(dc - std::complex<double>(6.5, 0.)) < 1.e-12); // Mean of 1..12
+  inverse.transform().normalizeLazily().scaleLazily(n); // Cancel normalization
+  BOOST_TEST(inverse.pendingScale() == 1.);
+  const auto values = dft.inBuffer(); // Shared with inverse.outBuffer()
+  for (long i = 0; i < values.size(); ++i) {
+    BOOST_TEST(std::abs(values.data()[i] - (1. + i)) < 1.e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pending_scale_propagation_test) {
+  const Fits::Position<2> shape {4, 3};
+  RealDft dft(shape);
+  auto inverse = dft.inverse();
+  auto signal = dft.inBuffer();
+  for (long i = 0; i < signal.size(); ++i) {
+    signal.data()[i] = 2. * i;
+  }
+  Fits::VecRaster<double, 2> half(dft.outShape());
+  for (long i = 0; i < half.size(); ++i) {
+    half.data()[i] = .5;
+  }
+  dft.transform().normalizeLazily().multiply(half); // Pending factor folded into the multiplication
+  BOOST_TEST(dft.pendingScale() == 1.);
+  inverse.transform(); // Already normalized
+  const auto values = inverse.outBuffer();
+  for (long i = 0; i < values.size(); ++i) {
+    BOOST_TEST(std::abs(values.data()[i] - i) < 1.e-9);
+  }
+  dft.transform().scaleLazily(3); // Pending factor forwarded by the inverse transform
+  inverse.transform();
+  BOOST_TEST(inverse.pendingScale() == 3.);
+  inverse.discardScale();
+  BOOST_TEST(inverse.pendingScale() == 1.);
+}
+
+BOOST_AUTO_TEST_CASE(planning_failure_releases_buffers_test) {
+  auto pool = std::make_shared<BufferPool>();
+  BOOST_CHECK_THROW(
+      RealDft::Inverse({4, 3}, 1, PlanningPolicy().preserveInput(), pool),
+      std::runtime_error); // Not supported by FFTW for multidimensional c2r transforms
+  BOOST_TEST(pool->misses() == 2);
+  BOOST_TEST(pool->cachedBytes() == (3 * 3 * sizeof(std::complex<double>) + 4 * 3 * sizeof(double)));
+}
+
+BOOST_AUTO_TEST_CASE(move_only_test) {
+  static_assert(not std::is_copy_constructible<RealDft>::value, "DftPlan should not be copyable");
+  static_assert(std::is_move_constructible<RealDft>::value, "DftPlan should be movable");
+  const Fits::Position<2> shape {4, 4};
+  auto pool = std::make_shared<BufferPool>();
+  std::vector<ComplexDft> dfts;
+  std::vector<const std::complex<double>*> buffers;
+  for (long i = 0; i < 10; ++i) { // Several reallocations
+    dfts.emplace_back(shape, 1, PlanningPolicy(), pool);
+    buffers.push_back(dfts.back().inBuffer().data());
+  }
+  BOOST_TEST(pool->misses() == 20);
+  BOOST_TEST(pool->hits() == 0); // Buffers were neither copied nor released
+  std::swap(dfts.front(), dfts.back());
+  BOOST_TEST(dfts.front().inBuffer().data() == buffers.back());
+  for (auto& dft : dfts) {
+    auto in = dft.inBuffer();
+    std::fill(in.begin(), in.end(), 0);
+    in.data()[0] = 1;
+    BOOST_TEST(std::abs(dft.transform().outBuffer().data()[1] - 1.) < 1.e-9);
+  }
+  dfts.front() = ComplexDft(shape, 1, PlanningPolicy(), pool); // Releases the previous buffers
+  BOOST_TEST(pool->hits() == 0);
+  BOOST_TEST(pool->cachedBytes() == 2 * 16 * sizeof(std::complex<double>));
+  dfts.clear();
+  BOOST_TEST(pool->cachedBytes() == 22 * 16 * sizeof(std::complex<double>));
+}
+
+BOOST_AUTO_TEST_CASE(external_buffers_test) {
+  const Fits::Position<2> shape {6, 4};
+  const long count = 8;
+  RealDft dft(shape, 1);
+  auto pool = std::make_shared<BufferPool>();
+  std::vector<Fits::PtrRaster<double, 3>> ins;
+  std::vector<Fits::PtrRaster<std::complex<double>, 3>> outs;
+  for (long i = 0; i < count; ++i) {
+    ins.emplace_back(dft.inStack().shape(), pool->allocate<double>(dft.inStack().size()));
+    outs.emplace_back(dft.outStack().shape(), pool->allocate<std::complex<double>>(dft.outStack().size()));
+    std::fill(ins.back().begin(), ins.back().end(), i + 1.);
+  }
+#pragma omp parallel for
+  for (long i = 0; i < count; ++i) {
+    dft.transform(ins[i], outs[i]);
+  }
+  for (long i = 0; i < count; ++i) {
+    BOOST_TEST(std::abs(outs[i].data()[0] - (i + 1.) * shapeSize(shape)) < 1.e-9);
+    BOOST_TEST(std::abs(outs[i].data()[1]) < 1.e-9);
+    pool->release(ins[i].data(), ins[i].size());
+    pool->release(outs[i].data(), outs[i].size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(external_buffers_checks_test) {
+  const Fits::Position<2> shape {4, 4};
+  ComplexDft dft(shape);
+  auto pool = std::make_shared<BufferPool>();
+  auto* data = pool->allocate<std::complex<double>>(3 * 16);
+  Fits::PtrRaster<std::complex<double>, 3> in({4, 4, 1}, data);
+  Fits::PtrRaster<std::complex<double>, 3> out({4, 4, 1}, data + 16);
+  Fits::PtrRaster<std::complex<double>, 3> small({4, 2, 1}, data + 32);
+  Fits::PtrRaster<std::complex<double>, 3> misaligned(
+      {4, 4, 1},
+      reinterpret_cast<std::complex<double>*>(reinterpret_cast<double*>(data + 32) - 1));
+  BOOST_CHECK_NO_THROW(dft.transform(in, out));
+  BOOST_CHECK_THROW(dft.transform(in, small), std::invalid_argument);
+  BOOST_CHECK_THROW(dft.transform(in, in), std::invalid_argument); // Out of place
+  BOOST_CHECK_THROW(dft.transform(in, misaligned), std::invalid_argument);
+  ComplexDft inPlace(shape, 1, PlanningPolicy().inPlace());
+  BOOST_CHECK_NO_THROW(inPlace.transform(in, in));
+  BOOST_CHECK_THROW(inPlace.transform(in, out), std::invalid_argument);
+  pool->release(data, 3 * 16);
+}
+
+template <typename TRaster>
+void fillSignal(TRaster& raster) {
+  for (long i = 0; i < raster.size(); ++i) {
+    raster.data()[i] = typename TRaster::Value((i * 7) % 11 - 4., (i * 5) % 3);
+  }
+}
+
+template <typename T>
+void fillSignal(Fits::PtrRaster<T, 3>& raster) {
+  for (long i = 0; i < raster.size(); ++i) {
+    raster.data()[i] = (i * 7) % 11 - 4.;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(row_dft_test) {
+  const Fits::Position<2> shape {6, 3};
+  const long count = 2;
+  ComplexRowDft rows(shape, count);
+  ComplexDft reference({shape[0], 1}, shape[1] * count); // 1D transforms
+  auto in = rows.inStack();
+  fillSignal(in);
+  auto referenceIn = reference.inStack();
+  std::copy(in.begin(), in.end(), referenceIn.begin());
+  const auto& out = rows.transform().outStack();
+  const auto& expected = reference.transform().outStack();
+  for (long i = 0; i < out.size(); ++i) {
+    BOOST_TEST(std::abs(out.data()[i] - expected.data()[i]) < 1.e-9);
+  }
+  BOOST_TEST(rows.normalizationFactor() == shape[0]);
+}
+
+BOOST_AUTO_TEST_CASE(column_dft_test) {
+  const Fits::Position<2> shape {4, 5};
+  const long count = 2;
+  ComplexColumnDft columns(shape, count);
+  ComplexRowDft rows({shape[1], shape[0]}, count); // Transposed
+  auto in = columns.inStack();
+  fillSignal(in);
+  auto transposed = rows.inStack();
+  for (long k = 0; k < count; ++k) {
+    for (long y = 0; y < shape[1]; ++y) {
+      for (long x = 0; x < shape[0]; ++x) {
+        transposed[{y, x, k}] = in[{x, y, k}];
+      }
+    }
+  }
+  const auto& out = columns.transform().outStack();
+  const auto& expected = rows.transform().outStack();
+  for (long k = 0; k < count; ++k) {
+    for (long y = 0; y < shape[1]; ++y) {
+      for (long x = 0; x < shape[0]; ++x) {
+        BOOST_TEST(std::abs(out[{x, y, k}] - expected[{y, x, k}]) < 1.e-9);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(real_axis_dft_test) {
+  const Fits::Position<2> shape {5, 4};
+  const long count = 2;
+  RealColumnDft real(shape, count);
+  ComplexColumnDft complex(shape, count);
+  auto in = real.inStack();
+  fillSignal(in);
+  auto complexIn = complex.inStack();
+  std::copy(in.begin(), in.end(), complexIn.begin());
+  const auto& out = real.transform().outStack();
+  const auto& expected = complex.transform().outStack();
+  BOOST_TEST(out.shape()[1] == shape[1] / 2 + 1);
+  for (long k = 0; k < count; ++k) {
+    for (long y = 0; y < out.shape()[1]; ++y) {
+      for (long x = 0; x < shape[0]; ++x) {
+        BOOST_TEST(std::abs(out[{x, y, k}] - expected[{x, y, k}]) < 1.e-9);
+      }
+    }
+  }
+  BOOST_CHECK_THROW(RealColumnDft(shape, count, PlanningPolicy().inPlace()), std::invalid_argument);
+}
+
+template <typename TDft>
+void checkRealRoundTrip(TDft& dft) {
+  const auto shape = dft.logicalShape();
+  auto inverse = dft.inverse();
+  auto in = dft.inStack();
+  fillSignal(in);
+  std::vector<double> expected(in.begin(), in.end());
+  dft.transform();
+  inverse.transform().normalize();
+  const auto& out = inverse.outStack();
+  for (long k = 0; k < dft.count(); ++k) {
+    for (long y = 0; y < shape[1]; ++y) {
+      for (long x = 0; x < shape[0]; ++x) { // Skip padding
+        const long i = x + out.shape()[0] * (y + shape[1] * k);
+        BOOST_TEST(std::abs(out.data()[i] - expected[i]) < 1.e-9);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(axis_and_stack_round_trip_test) {
+  const Fits::Position<2> shape {6, 4};
+  const long count = 3;
+  RealRowDft rows(shape, count, PlanningPolicy().inPlace());
+  checkRealRoundTrip(rows);
+  RealStackDft stack(shape, count);
+  checkRealRoundTrip(stack);
+  ComplexStackDft complex({2, 2}, 2);
+  auto in = complex.inStack();
+  std::fill(in.begin(), in.end(), 1.);
+  const auto& out = complex.transform().outStack();
+  BOOST_TEST(std::abs(out.data()[0] - 8.) < 1.e-9); // DC over the whole stack
+  for (long i = 1; i < out.size(); ++i) {
+    BOOST_TEST(std::abs(out.data()[i]) < 1.e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pipe_test) {
+  const Fits::Position<2> shape {6, 5};
+  const long count = 3;
+  ComplexDft dft(shape, count);
+  RealDft next(shape, count);
+  RealDft padded(shape, count, PlanningPolicy().inPlace());
+  auto in = dft.inStack();
+  for (const auto& p : in.domain()) {
+    in[p] = {double(p[0] - p[1]), double(p[2] + 1)};
+  }
+  dft.transform();
+  Fits::VecRaster<std::complex<double>, 3> expected(dft.outStack().shape());
+  std::copy(dft.outStack().begin(), dft.outStack().end(), expected.begin());
+  dft.scaleLazily(.5).pipe(next, Norm2()).pipe(padded, Norm2());
+  BOOST_TEST(dft.pendingScale() == .5); // Untouched
+  BOOST_TEST(padded.inShape()[0] == 8);
+  const auto intensity = next.inStack();
+  const auto paddedIntensity = padded.inStack();
+  for (const auto& p : intensity.domain()) {
+    const auto e = std::norm(expected[p] * .5);
+    BOOST_TEST(std::abs(intensity[p] - e) < 1.e-9);
+    BOOST_TEST(std::abs(paddedIntensity[p] - e) < 1.e-9);
+  }
+  Fits::VecRaster<double, 3> small({6, 4, count});
+  BOOST_CHECK_THROW(dft.pipe(small, Norm2()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(padded_round_trip_test) {
+  const Fits::Position<2> shape {11, 13};
+  const long count = 2;
+  for (const auto& policy : {PlanningPolicy(), PlanningPolicy().inPlace()}) {
+    auto dft = RealDft::padded(shape, count, policy);
+    BOOST_TEST(dft.logicalShape()[0] == 12);
+    BOOST_TEST(dft.logicalShape()[1] == 14);
+    auto inverse = dft.inverse();
+    Fits::VecRaster<double, 3> image({shape[0], shape[1], count});
+    for (const auto& p : image.domain()) {
+      image[p] = 1 + p[0] + 2 * p[1] + 3 * p[2];
+    }
+    dft.inStack()[{0, 0, 0}] = 42; // Garbage, overwritten
+    dft.load(image);
+    const auto padded = dft.inStack();
+    BOOST_TEST((padded[{11, 0, 0}]) == 0);
+    BOOST_TEST((padded[{0, 13, 1}]) == 0);
+    BOOST_TEST((padded[{10, 12, 1}]) == (image[{10, 12, 1}]));
+    double sum = 0;
+    for (long y = 0; y < shape[1]; ++y) {
+      for (long x = 0; x < shape[0]; ++x) {
+        sum += image[{x, y, 0}];
+      }
+    }
+    dft.transform();
+    BOOST_TEST(std::abs(dft.outBuffer()[{0, 0}] - sum) < 1.e-9); // Padding does not contribute
+    Fits::VecRaster<double, 3> result(image.shape());
+    inverse.transform().normalizeLazily().crop(result);
+    for (const auto& p : image.domain()) {
+      BOOST_TEST(std::abs((result[p]) - (image[p])) < 1.e-9);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(load_crop_checks_test) {
+  ComplexDft dft({4, 3}, 2);
+  Fits::VecRaster<std::complex<double>, 3> wide({5, 3, 1});
+  Fits::VecRaster<std::complex<double>, 3> deep({4, 3, 3});
+  Fits::VecRaster<std::complex<double>> single({2, 2});
+  BOOST_CHECK_THROW(dft.load(wide), std::invalid_argument);
+  BOOST_CHECK_THROW(dft.load(deep), std::invalid_argument);
+  BOOST_CHECK_THROW(dft.crop(wide), std::invalid_argument);
+  BOOST_CHECK_THROW(dft.crop(deep), std::invalid_argument);
+  single[{1, 1}] = 3;
+  dft.load(single);
+  BOOST_TEST((dft.inBuffer()[{1, 1}]) == (std::complex<double>(3)));
+  BOOST_TEST((dft.inBuffer(1)[{1, 1}]) == (std::complex<double>(0)));
+  dft.transform().scaleLazily(2).crop(single);
+  BOOST_TEST((single[{0, 0}]) == (std::complex<double>(6)));
+}
+
+using Precisions = boost::mpl::list<float, double, long double>;
 
-  BOOST_FAIL("!!!! Please implement your tests !!!!");
+BOOST_AUTO_TEST_CASE_TEMPLATE(precision_round_trip_test, T, Precisions) {
+  const Fits::Position<2> shape {6, 5};
+  BasicRealDft<T> dft(shape, 2, PlanningPolicy::estimate());
+  auto inverse = dft.inverse();
+  auto complex = dft.template compose<BasicComplexDft<T>>(dft.outShape());
+  BOOST_TEST(complex.inShape() == dft.outShape());
+  for (long i = 0; i < dft.count(); ++i) {
+    auto signal = dft.inBuffer(i);
+    for (const auto& p : signal.domain()) {
+      signal[p] = 1 + p[0] * p[1] + i;
+    }
+  }
+  dft.transform();
+  inverse.transform().normalize();
+  for (long i = 0; i < inverse.count(); ++i) {
+    const auto signal = inverse.outBuffer(i);
+    for (const auto& p : signal.domain()) {
+      const T expected = 1 + p[0] * p[1] + i;
+      BOOST_TEST(std::abs(signal[p] - expected) < 1.e-4 * expected);
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,149 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/DftStream.h"
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(DftStream_test)
+
+//-----------------------------------------------------------------------------
+
+double value(long image, long i) {
+  return (image * 13 + i * 7) % 11 - 5.;
+}
+
+BOOST_AUTO_TEST_CASE(stream_matches_batch_test) {
+  const Fits::Position<2> shape {6, 4};
+  const long count = 7; // Last batch is partial
+  const long size = shape[0] * shape[1];
+
+  // Reference
+  RealDft reference(shape, count);
+  for (long k = 0; k < count; ++k) {
+    auto plane = reference.inBuffer(k);
+    for (long i = 0; i < size; ++i) {
+      plane.data()[i] = value(k, i);
+    }
+  }
+  reference.transform().normalize();
+  const auto expected = reference.outStack();
+
+  // Stream
+  DftStream<RealDft> stream(shape, 3);
+  std::vector<std::vector<std::complex<double>>> results(count);
+  stream.run(
+      count,
+      [&](long index, Fits::PtrRaster<double>& plane) {
+        for (long i = 0; i < size; ++i) {
+          plane.data()[i] = value(index, i);
+        }
+      },
+      [](RealDft& plan, long) {
+        plan.transform().normalize();
+      },
+      [&](long index, const Fits::PtrRaster<const std::complex<double>>& plane) {
+        results[index].assign(plane.data(), plane.data() + plane.size());
+      });
+
+  const long outSize = expected.size() / count;
+  for (long k = 0; k < count; ++k) {
+    BOOST_TEST(results[k].size() == static_cast<std::size_t>(outSize));
+    for (long i = 0; i < outSize; ++i) {
+      BOOST_TEST(std::abs(results[k][i] - expected.data()[k * outSize + i]) < 1e-9);
+    }
+  }
+  BOOST_TEST(stream.wallSeconds() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(default_process_and_empty_sequence_test) {
+  const Fits::Position<2> shape {4, 4};
+  DftStream<ComplexDft> stream(shape, 2);
+  long written = 0;
+  const auto read = [](long, Fits::PtrRaster<std::complex<double>>& plane) {
+    for (long i = 0; i < plane.size(); ++i) {
+      plane.data()[i] = 1;
+    }
+  };
+  const auto write = [&](long, const Fits::PtrRaster<const std::complex<double>>& plane) {
+    BOOST_TEST(std::abs(plane.data()[0] - std::complex<double>(16)) < 1e-9); // DC of unnormalized transform
+    ++written;
+  };
+  stream.run(0, read, write);
+  BOOST_TEST(written == 0);
+  stream.run(5, read, write);
+  BOOST_TEST(written == 5);
+}
+
+BOOST_AUTO_TEST_CASE(writing_overlaps_computing_test) {
+  DftStream<ComplexDft> stream({4, 4}, 1);
+  std::atomic<long> computed(0);
+  bool overlapped = false;
+  std::vector<long> order;
+  stream.run(
+      3,
+      [](long, Fits::PtrRaster<std::complex<double>>&) {},
+      [&](ComplexDft& plan, long) {
+        plan.transform();
+        ++computed;
+      },
+      [&](long index, const Fits::PtrRaster<const std::complex<double>>&) {
+        if (index == 0) { // Wait for batch 1 to be computed meanwhile
+          const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+          while (computed < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+          overlapped = computed >= 2;
+        }
+        order.push_back(index);
+      });
+  BOOST_TEST(overlapped);
+  BOOST_TEST(order == std::vector<long>({0, 1, 2})); // Writes remain sequential
+}
+
+BOOST_AUTO_TEST_CASE(in_place_is_rejected_test) {
+  BOOST_CHECK_THROW(DftStream<RealDft>({4, 4}, 2, PlanningPolicy().inPlace()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(exception_is_forwarded_test) {
+  DftStream<RealDft> stream({4, 4}, 2);
+  BOOST_CHECK_THROW(
+      stream.run(
+          5,
+          [](long index, Fits::PtrRaster<double>&) {
+            if (index == 3) {
+              throw std::runtime_error("Read failure");
+            }
+          },
+          [](long, const Fits::PtrRaster<const std::complex<double>>&) {}),
+      std::runtime_error);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -20,6 +20,10 @@
 #include "EleFourier/DftType.h"
 
 #include <boost/test/unit_test.hpp>
+#include <type_traits>
+
+using namespace Euclid;
+using namespace Fourier;
 
 //-----------------------------------------------------------------------------
 
@@ -27,9 +31,49 @@ BOOST_AUTO_TEST_SUITE(DftType_test)
 
 //-----------------------------------------------------------------------------
 
-BOOST_AUTO_TEST_CASE(example_test) {
+BOOST_AUTO_TEST_CASE(name_test) {
+  BOOST_TEST(RealDftType::name() == "RealDft");
+  BOOST_TEST(Inverse<RealDftType>::name() == "InverseRealDft");
+  BOOST_TEST(BasicComplexDftType<float>::name() == "ComplexDftF");
+  BOOST_TEST(Inverse<BasicComplexDftType<long double>>::name() == "InverseComplexDftL");
+}
+
+BOOST_AUTO_TEST_CASE(shape_test) {
+  const Fits::Position<2> shape {5, 3};
+  const Fits::Position<2> half {3, 3};
+  BOOST_TEST((BasicRealDftType<float>::inShape(shape) == shape));
+  BOOST_TEST((BasicRealDftType<float>::outShape(shape) == half));
+  BOOST_TEST((Inverse<BasicRealDftType<float>>::inShape(shape) == half));
+  BOOST_TEST((Inverse<BasicRealDftType<float>>::outShape(shape) == shape));
+  BOOST_TEST((HermitianComplexDftType::inShape(shape) == half));
+  BOOST_TEST((HermitianComplexDftType::outShape(shape) == shape));
+  BOOST_TEST((Inverse<HermitianComplexDftType>::inShape(shape) == shape));
+  BOOST_TEST((Inverse<HermitianComplexDftType>::outShape(shape) == half));
+}
+
+BOOST_AUTO_TEST_CASE(precision_test) {
+  BOOST_TEST((std::is_same<BasicRealDftType<float>::InValue, float>::value));
+  BOOST_TEST((std::is_same<BasicRealDftType<float>::OutValue, std::complex<float>>::value));
+  BOOST_TEST((std::is_same<Inverse<BasicRealDftType<long double>>::Real, long double>::value));
+  BOOST_TEST((std::is_same<FftwPlan<BasicComplexDftType<float>>, fftwf_plan>::value));
+  BOOST_TEST((std::is_same<FftwPlan<ComplexDftType>, fftw_plan>::value));
+  BOOST_TEST((std::is_same<BasicHermitianComplexDftType<float>::InValue, std::complex<float>>::value));
+  BOOST_TEST((std::is_same<BasicHermitianComplexDftType<float>::OutValue, float>::value));
+}
 
-  BOOST_FAIL("!!!! Please implement your tests !!!!");
+BOOST_AUTO_TEST_CASE(axis_and_stack_test) {
+  const Fits::Position<2> shape {5, 3};
+  BOOST_TEST(ComplexRowDftType::name() == "ComplexAxis0Dft");
+  BOOST_TEST((BasicRealAxisDftType<float, 1>::name() == "RealAxis1DftF"));
+  BOOST_TEST(Inverse<RealStackDftType>::name() == "InverseRealStackDft");
+  BOOST_TEST((RealRowDftType::outShape(shape) == Fits::Position<2> {3, 3}));
+  BOOST_TEST((RealColumnDftType::outShape(shape) == Fits::Position<2> {5, 2}));
+  BOOST_TEST((Inverse<RealColumnDftType>::inShape(shape) == Fits::Position<2> {5, 2}));
+  BOOST_TEST((RealStackDftType::outShape(shape) == Fits::Position<2> {3, 3}));
+  BOOST_TEST(RealDftType::normalizationFactor(shape, 4) == 15);
+  BOOST_TEST(ComplexRowDftType::normalizationFactor(shape, 4) == 5);
+  BOOST_TEST(Inverse<RealColumnDftType>::normalizationFactor(shape, 4) == 3);
+  BOOST_TEST(ComplexStackDftType::normalizationFactor(shape, 4) == 60);
 }
 
 //-----------------------------------------------------------------------------
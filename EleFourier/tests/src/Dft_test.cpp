@@ -152,10 +152,49 @@ BOOST_AUTO_TEST_CASE(real_inverse_composition_test) {
   checkComposition<RealDft::Inverse, RealDft>();
 }
 
-// BOOST_AUTO_TEST_CASE(real_complex_composition_test) {
-//   checkComposition<RealDft, HermitianComplexDft>();
-//   checkComposition<HermitianComplexDft::Inverse, RealDft::Inverse>();
-// }
+BOOST_AUTO_TEST_CASE(real_complex_composition_test) {
+  checkComposition<RealDft, HermitianComplexDft>();
+  checkComposition<HermitianComplexDft::Inverse, RealDft::Inverse>();
+}
+
+BOOST_AUTO_TEST_CASE(hermitian_test) {
+
+  // Transform twice
+  const Fits::Position<2> shape {5, 4};
+  const long count = 2;
+  RealDft dft(shape, count);
+  auto twice = dft.compose<HermitianComplexDft>(shape);
+  HermitianComplexDft::Inverse inverse(shape, count);
+  for (long i = 0; i < count; ++i) {
+    auto signal = dft.inBuffer(i);
+    auto copy = inverse.inBuffer(i);
+    for (const auto& p : signal.domain()) {
+      signal[p] = 1 + p[0] * p[1] + i;
+      copy[p] = signal[p];
+    }
+  }
+  dft.transform();
+  inverse.transform();
+
+  // Check the inverse transform is the conjugate of the real transform
+  for (long i = 0; i < count; ++i) {
+    const auto coefficients = dft.outBuffer(i);
+    const auto conjugates = inverse.outBuffer(i);
+    for (const auto& p : coefficients.domain()) {
+      BOOST_TEST(std::abs(conjugates[p] - std::conj(coefficients[p])) < 1e-9);
+    }
+  }
+
+  // Check that the signal is flipped
+  twice.transform().normalize();
+  for (long i = 0; i < count; ++i) {
+    const auto flipped = twice.outBuffer(i);
+    for (const auto& p : flipped.domain()) {
+      const Fits::Position<2> q {(shape[0] - p[0]) % shape[0], (shape[1] - p[1]) % shape[1]};
+      BOOST_TEST(std::abs(flipped[p] - (1 + q[0] * q[1] + i)) < 1e-9);
+    }
+  }
+}
 
 BOOST_AUTO_TEST_CASE(complex_inverse_composition_test) {
   checkComposition<ComplexDft, ComplexDft::Inverse>();
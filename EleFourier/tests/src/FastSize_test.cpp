@@ -0,0 +1,77 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/FastSize.h"
+
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include <vector>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(FastSize_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(is_fast_size_test) {
+  for (long size : {1, 2, 3, 5, 7, 8, 1000, 1024, 1536, 2 * 3 * 5 * 7}) {
+    BOOST_TEST(isFastSize(size));
+  }
+  for (long size : {0, -4, 11, 13, 1001, 1537, 2 * 11}) {
+    BOOST_TEST(not isFastSize(size));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(fast_size_test) {
+  BOOST_TEST(fastSize(1) == 1);
+  BOOST_TEST(fastSize(1000) == 1000);
+  BOOST_TEST(fastSize(1001) == 1008);
+  BOOST_TEST(fastSize(1537) == 1568);
+  BOOST_CHECK_THROW(fastSize(0), std::invalid_argument);
+  const auto shape = fastShape({1000, 1537});
+  BOOST_TEST(shape[0] == 1000);
+  BOOST_TEST(shape[1] == 1568);
+}
+
+BOOST_AUTO_TEST_CASE(fast_sizes_test) {
+  const std::vector<long> expected {9, 10, 12, 14, 15, 16};
+  BOOST_TEST(fastSizes(9, 16) == expected);
+  BOOST_TEST(fastSizes(11, 11).empty());
+}
+
+BOOST_AUTO_TEST_CASE(cost_test) {
+  auto powerOfTwo = [](long size) {
+    return (size & (size - 1)) == 0 ? 0. : 1.;
+  };
+  BOOST_TEST(fastSize(1001, powerOfTwo) == 1024);
+  BOOST_TEST(fastSize(1001, powerOfTwo, 1023) == 1008); // Equal costs, smallest size
+  auto identity = [](long size) {
+    return double(size);
+  };
+  const auto shape = fastShape({1001, 17}, identity);
+  BOOST_TEST(shape[0] == 1008);
+  BOOST_TEST(shape[1] == 18);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,118 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/FftwPlanner.h"
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(FftwPlanner_test)
+
+//-----------------------------------------------------------------------------
+
+template <typename TPlan>
+void fill(TPlan& plan, long offset) {
+  for (long i = 0; i < plan.count(); ++i) {
+    auto signal = plan.inBuffer(i);
+    for (const auto& p : signal.domain()) {
+      signal[p] = 1 + p[0] + p[1] + i + offset;
+    }
+  }
+}
+
+template <typename TPlan>
+void checkRoundTrip(TPlan& plan, long offset) {
+  auto inverse = plan.inverse();
+  fill(plan, offset);
+  plan.transform();
+  inverse.transform().normalize();
+  const double tolerance = sizeof(typename TPlan::Real) < sizeof(double) ? 1.e-4 : 1.e-6;
+  for (long i = 0; i < plan.count(); ++i) {
+    const auto signal = inverse.outBuffer(i);
+    for (const auto& p : signal.domain()) {
+      const double expected = 1 + p[0] + p[1] + i + offset;
+      BOOST_TEST(std::abs(signal[p] - expected) < tolerance * expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(deduplication_test) {
+  auto& planner = FftwPlanner::instance();
+  const auto initial = planner.size();
+  const Fits::Position<2> shape {5, 6};
+  {
+    RealDft a(shape, 2);
+    BOOST_TEST(planner.size() == initial + 1);
+    RealDft b(shape, 2);
+    BOOST_TEST(planner.size() == initial + 1); // Same geometry
+    RealDft c(shape, 3);
+    BOOST_TEST(planner.size() == initial + 2); // Different count
+    RealDft d(shape, 2, PlanningPolicy::estimate());
+    BOOST_TEST(planner.size() == initial + 3); // Different policy
+    checkRoundTrip(a, 0);
+    checkRoundTrip(b, 10); // Shared plan executed on b's buffers
+  }
+  BOOST_TEST(planner.size() == initial); // Plans are destroyed with their last user
+}
+
+BOOST_AUTO_TEST_CASE(precision_separation_test) {
+  auto& planner = FftwPlanner::instance();
+  const auto initial = planner.size();
+  const Fits::Position<2> shape {5, 6};
+  RealDft d(shape);
+  RealDftF f(shape);
+  RealDftL l(shape);
+  BOOST_TEST(planner.size() == initial + 3);
+  checkRoundTrip(f, 0);
+  checkRoundTrip(l, 0);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_planning_test) {
+  const Fits::Position<2> shape {5, 6};
+  const long threads = 8;
+  std::vector<int> success(threads, 0);
+#pragma omp parallel for
+  for (long t = 0; t < threads; ++t) {
+    RealDft dft({shape[0] + t % 2, shape[1]}, 1);
+    auto inverse = dft.inverse();
+    fill(dft, t);
+    dft.transform();
+    inverse.transform().normalize();
+    const auto signal = inverse.outBuffer();
+    bool ok = true;
+    for (const auto& p : signal.domain()) {
+      const double expected = 1 + p[0] + p[1] + t;
+      ok &= std::abs(signal[p] - expected) < 1.e-6 * expected;
+    }
+    success[t] = ok;
+  }
+  for (long t = 0; t < threads; ++t) {
+    BOOST_TEST(success[t]);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
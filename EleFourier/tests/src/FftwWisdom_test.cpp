@@ -0,0 +1,75 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/FftwWisdom.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(FftwWisdom_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(key_test) {
+  BOOST_TEST(FftwWisdom::key<RealDftType>({4, 3}, 2) == "RealDft_4x3x2_Measure");
+  BOOST_TEST(FftwWisdom::key<Inverse<ComplexDftType>>({4, 3}, 1) == "InverseComplexDft_4x3x1_Measure");
+  BOOST_TEST(FftwWisdom::key<RealDftType>({4, 3}, 2, PlanningPolicy::patient()) == "RealDft_4x3x2_Patient");
+}
+
+BOOST_AUTO_TEST_CASE(disabled_by_default_test) {
+  auto& wisdom = FftwWisdom::instance();
+  BOOST_TEST(not wisdom.enabled());
+  const auto key = FftwWisdom::key<RealDftType>({4, 3}, 1);
+  BOOST_TEST(not wisdom.load(key));
+  wisdom.record(key);
+  BOOST_TEST(wisdom.save() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(save_and_load_test) {
+  const auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  auto& wisdom = FftwWisdom::instance();
+  wisdom.enable(directory.string(), false);
+  BOOST_TEST(wisdom.enabled());
+  const Fits::Position<2> shape {4, 3};
+  const auto key = FftwWisdom::key<RealDftType>(shape, 2);
+  const auto inverseKey = FftwWisdom::key<RealDftType::InverseType>(shape, 2);
+  BOOST_TEST(not wisdom.load(key));
+  {
+    RealDft dft(shape, 2);
+    dft.inverse();
+  }
+  BOOST_TEST(wisdom.save() == 2);
+  BOOST_TEST(boost::filesystem::exists(wisdom.filename(key)));
+  BOOST_TEST(boost::filesystem::exists(wisdom.filename(inverseKey)));
+  BOOST_TEST(wisdom.load(key));
+  BOOST_TEST(wisdom.save() == 0); // Nothing new
+  wisdom.disable();
+  BOOST_TEST(not wisdom.enabled());
+  boost::filesystem::remove_all(directory);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,198 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/GpuDftPlan.h"
+#include "EleFourier/GpuPupilPhase.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(GpuDftPlan_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(device_buffer_test) {
+  DeviceBuffer<double> buffer(4);
+  BOOST_TEST(buffer.size() == 4);
+  const std::vector<double> host {1, 2, 3, 4};
+  buffer.upload(host.data(), 2, 1);
+  std::vector<double> back(2);
+  buffer.download(back.data(), 2, 1);
+  BOOST_TEST(back[0] == 1);
+  BOOST_TEST(back[1] == 2);
+  BOOST_CHECK_THROW(buffer.upload(host.data(), 4, 1), std::invalid_argument);
+  buffer.zero();
+  buffer.download(back.data(), 2);
+  BOOST_TEST(back[0] == 0);
+  DeviceBuffer<double> moved(std::move(buffer));
+  BOOST_TEST(moved.size() == 4);
+}
+
+BOOST_AUTO_TEST_CASE(real_round_trip_test) {
+  const Fits::Position<2> shape {5, 4};
+  const long count = 2;
+  GpuRealDft dft(shape, count);
+  auto inverse = dft.inverse();
+  BOOST_TEST((dft.outShape() == Fits::Position<2> {3, 4}));
+  BOOST_TEST((inverse.inShape() == dft.outShape()));
+  Fits::VecRaster<double, 3> signal({5, 4, count});
+  for (const auto& p : signal.domain()) {
+    signal[p] = 1 + p[0] + 2 * p[1] + p[2];
+  }
+  dft.upload(signal).transform();
+  inverse.transform().normalize();
+  Fits::VecRaster<double, 3> back({5, 4, count});
+  inverse.download(back);
+  for (const auto& p : signal.domain()) {
+    BOOST_TEST(std::abs(back[p] - signal[p]) < 1.e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(host_consistency_test) {
+  const Fits::Position<2> shape {6, 5};
+  ComplexDft host(shape);
+  GpuComplexDft device(shape);
+  Fits::VecRaster<std::complex<double>> signal(shape);
+  for (const auto& p : signal.domain()) {
+    signal[p] = {std::cos(p[0] + p[1]), 0.5 * p[0] - p[1]};
+    host.inBuffer()[p] = signal[p];
+  }
+  host.transform();
+  device.upload(signal).transform();
+  Fits::VecRaster<std::complex<double>> coefficients(shape);
+  device.download(coefficients);
+  for (const auto& p : coefficients.domain()) {
+    BOOST_TEST(std::abs(coefficients[p] - host.outBuffer()[p]) < 1.e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(single_precision_round_trip_test) {
+  const Fits::Position<2> shape {4, 4};
+  GpuComplexDftF dft(shape);
+  auto inverse = dft.inverse();
+  Fits::VecRaster<std::complex<float>> signal(shape);
+  for (const auto& p : signal.domain()) {
+    signal[p] = {float(p[0]), float(p[1])};
+  }
+  dft.upload(signal).transform();
+  inverse.transform().normalize();
+  Fits::VecRaster<std::complex<float>> back(shape);
+  inverse.download(back);
+  for (const auto& p : signal.domain()) {
+    BOOST_TEST(std::abs(back[p] - signal[p]) < 1.e-4);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pipe_and_accumulate_test) {
+  const Fits::Position<2> shape {4, 3};
+  GpuComplexDft pupilToPsf(shape);
+  GpuRealDft psfToMtf(shape);
+  DeviceBuffer<std::complex<double>> sum(psfToMtf.outDevice().size());
+  sum.zero();
+  Fits::VecRaster<std::complex<double>> amplitude(shape);
+  for (const auto& p : amplitude.domain()) {
+    amplitude[p] = {1. + p[0], -1. * p[1]};
+  }
+  for (int i = 0; i < 2; ++i) {
+    pupilToPsf.upload(amplitude).transform().pipe(psfToMtf, Norm2());
+    psfToMtf.transform().addTo(sum);
+  }
+
+  ComplexDft hostPupilToPsf(shape);
+  RealDft hostPsfToMtf(shape);
+  for (const auto& p : amplitude.domain()) {
+    hostPupilToPsf.inBuffer()[p] = amplitude[p];
+  }
+  hostPupilToPsf.transform().pipe(hostPsfToMtf, Norm2());
+  hostPsfToMtf.transform();
+
+  std::vector<std::complex<double>> values(sum.size());
+  sum.download(values.data(), values.size());
+  const auto expected = hostPsfToMtf.outBuffer();
+  const double tol = 1.e-9 * std::abs(expected[{0, 0}]);
+  long i = 0;
+  for (const auto& p : expected.domain()) {
+    BOOST_TEST(std::abs(values[i] - 2. * expected[p]) < tol);
+    ++i;
+  }
+
+  auto mtfToPsf = psfToMtf.inverse();
+  mtfToPsf.loadDevice(sum).transform().normalize();
+  Fits::VecRaster<double> psf(shape);
+  mtfToPsf.download(psf);
+  const auto hostPsf = hostPsfToMtf.inBuffer();
+  for (const auto& p : psf.domain()) {
+    BOOST_TEST(std::abs(psf[p] - 2. * hostPsf[p]) < tol);
+  }
+
+  GpuRealDft wrong({5, 3});
+  BOOST_CHECK_THROW(pupilToPsf.pipe(wrong, Norm2()), std::invalid_argument);
+  BOOST_CHECK_THROW(pupilToPsf.addTo(sum), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(shape_checks_test) {
+  GpuRealDft dft({4, 3}, 2);
+  Fits::VecRaster<double> wrong({3, 4});
+  BOOST_CHECK_THROW(dft.upload(wrong), std::invalid_argument);
+  Fits::VecRaster<double, 3> tooMany({4, 3, 3});
+  BOOST_CHECK_THROW(dft.upload(tooMany), std::invalid_argument);
+  Fits::VecRaster<double> plane({4, 3});
+  dft.upload(plane);
+  BOOST_CHECK_THROW(dft.loadDevice(DeviceBuffer<double>(25)), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(pupil_amplitude_test) {
+  Fits::VecRaster<double> mask({8, 6});
+  Fits::VecRaster<double, 3> cube({2, 8, 6});
+  for (const auto& p : mask.domain()) {
+    const double u = p[0] - 3.5;
+    const double v = p[1] - 2.5;
+    mask[p] = u * u + v * v < 9 ? .5 + .1 * p[1] : 0;
+  }
+  for (const auto& p : cube.domain()) {
+    cube[p] = std::cos(p[0] + .3 * p[1] - .7 * p[2]);
+  }
+  const SparsePupil pupil(mask, cube);
+  PupilPhase phase(pupil);
+  phase.evalOpd({.1, -.2});
+  GpuPupilPhase gpuPhase(phase);
+  const double lambda = .6;
+  GpuComplexDft dft(mask.shape(), 2);
+  gpuPhase.evalAmplitude(lambda, dft, 1);
+  Fits::VecRaster<std::complex<double>> expected(mask.shape());
+  phase.evalAmplitude(lambda, expected);
+  std::vector<std::complex<double>> values(dft.inDevice().size());
+  dft.inDevice().download(values.data(), values.size(), 0);
+  const long size = mask.shape()[0] * mask.shape()[1];
+  for (long i = 0; i < size; ++i) {
+    BOOST_TEST(std::abs(values[size + i] - expected.data()[i]) < 1.e-9);
+  }
+  GpuComplexDft wrong({6, 8});
+  BOOST_CHECK_THROW(gpuPhase.evalAmplitude(lambda, wrong), std::invalid_argument);
+  BOOST_CHECK_THROW(gpuPhase.evalAmplitude(lambda, dft, 2), std::invalid_argument);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,177 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/Kernels.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Kernels_test)
+
+//-----------------------------------------------------------------------------
+
+using Complex = std::complex<double>;
+
+Fits::VecRaster<Complex, 3> makeStack(const Fits::Position<3>& shape) {
+  Fits::VecRaster<Complex, 3> stack(shape);
+  for (const auto& p : stack.domain()) {
+    stack[p] = {1. + p[0] + p[2], 2. - p[1]};
+  }
+  return stack;
+}
+
+Fits::VecRaster<Complex, 2> makeFilter(const Fits::Position<2>& shape) {
+  Fits::VecRaster<Complex, 2> filter(shape);
+  for (const auto& p : filter.domain()) {
+    filter[p] = {0.5 * p[0], 1. + p[1]};
+  }
+  return filter;
+}
+
+BOOST_AUTO_TEST_CASE(scale_test) {
+  const Fits::Position<3> shape {4, 3, 2};
+  const auto expected = makeStack(shape);
+  auto stack = makeStack(shape);
+  scale(stack, 0.5);
+  for (const auto& p : stack.domain()) {
+    BOOST_TEST(stack[p] == expected[p] * 0.5);
+  }
+  std::vector<float> real {1, 2, 3};
+  scaleData(real.data(), 3, 2.); // Double factor on float data
+  BOOST_TEST(real[2] == 6.f);
+}
+
+BOOST_AUTO_TEST_CASE(multiply_scale_test) {
+  const Fits::Position<3> shape {4, 3, 2};
+  const auto filter = makeFilter({4, 3});
+  const auto input = makeStack(shape);
+  auto multiplied = makeStack(shape);
+  auto fused = makeStack(shape);
+  multiply(multiplied, filter);
+  multiplyScale(fused, filter, 0.25);
+  for (const auto& p : input.domain()) {
+    const auto expected = input[p] * filter[{p[0], p[1]}];
+    BOOST_TEST(std::abs(multiplied[p] - expected) < 1.e-12);
+    BOOST_TEST(std::abs(fused[p] - expected * 0.25) < 1.e-12);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(real_filter_test) {
+  const Fits::Position<3> shape {4, 3, 2};
+  Fits::VecRaster<double, 2> filter({4, 3});
+  for (long i = 0; i < filter.size(); ++i) {
+    filter.data()[i] = 1. + i;
+  }
+  const auto input = makeStack(shape);
+  auto stack = makeStack(shape);
+  multiplyScale(stack, filter, 2.);
+  for (const auto& p : input.domain()) {
+    BOOST_TEST(std::abs(stack[p] - input[p] * filter[{p[0], p[1]}] * 2.) < 1.e-12);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(norm2_and_accumulate_test) {
+  const Fits::Position<3> shape {4, 3, 2};
+  const auto filter = makeFilter({4, 3});
+  const auto input = makeStack(shape);
+  Fits::VecRaster<double, 3> intensity(shape);
+  norm2(input, intensity);
+  auto acc = makeStack(shape);
+  multiplyAccumulate(acc, input, filter);
+  for (const auto& p : input.domain()) {
+    BOOST_TEST(std::abs(intensity[p] - std::norm(input[p])) < 1.e-12);
+    BOOST_TEST(std::abs(acc[p] - (input[p] + input[p] * filter[{p[0], p[1]}])) < 1.e-12);
+  }
+}
+
+void checkNorm2Hermitian(const Fits::Position<2>& shape) {
+  RealDft real(shape);
+  ComplexDft complex(shape);
+  auto signal = real.inBuffer();
+  auto copy = complex.inBuffer();
+  for (const auto& p : signal.domain()) {
+    signal[p] = 1. + p[0] * p[0] - p[1];
+    copy[p] = signal[p];
+  }
+  const auto half = real.transform().outBuffer();
+  const auto full = complex.transform().outBuffer();
+  Fits::VecRaster<double> intensity(shape);
+  norm2HermitianData(half.data(), intensity.data(), shape[0], shape[1]);
+  for (const auto& p : intensity.domain()) {
+    BOOST_TEST(std::abs(intensity[p] - std::norm(full[p])) < 1.e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(norm2_hermitian_test) {
+  checkNorm2Hermitian({6, 4});
+  checkNorm2Hermitian({5, 3});
+}
+
+BOOST_AUTO_TEST_CASE(scalar_accumulate_test) {
+  const auto input = makeStack({4, 3, 2});
+  auto acc = makeStack({4, 3, 2});
+  const Complex factor {.5, -2.};
+  multiplyAccumulateData(acc.data(), input.data(), factor, acc.size());
+  for (const auto& p : input.domain()) {
+    BOOST_TEST(std::abs(acc[p] - (input[p] + factor * input[p])) < 1.e-12);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(conjugate_test) {
+  const auto input = makeStack({4, 3, 2});
+  auto output = makeStack({4, 3, 2});
+  conjugateData(output.data(), output.size());
+  for (const auto& p : input.domain()) {
+    BOOST_TEST(output[p] == std::conj(input[p]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(size_mismatch_test) {
+  auto stack = makeStack({4, 3, 2});
+  const auto filter = makeFilter({5, 3});
+  BOOST_CHECK_THROW(multiply(stack, filter), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(dft_plan_fusion_test) {
+  const Fits::Position<2> shape {6, 4};
+  RealDft dft(shape, 2);
+  auto inverse = dft.inverse();
+  for (const auto& p : dft.inStack().domain()) {
+    dft.inStack()[p] = 1. + p[0] * p[1] + p[2];
+  }
+  Fits::VecRaster<double, 2> identity(dft.outShape());
+  for (long i = 0; i < identity.size(); ++i) {
+    identity.data()[i] = 1;
+  }
+  dft.transform().multiplyScale(identity, 1. / dft.normalizationFactor());
+  inverse.transform(); // No normalize()
+  for (const auto& p : inverse.outStack().domain()) {
+    const double expected = 1. + p[0] * p[1] + p[2];
+    BOOST_TEST(std::abs(inverse.outStack()[p] - expected) < 1.e-6 * expected);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,198 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/MappedFits.h"
+
+#include <boost/test/unit_test.hpp>
+#include <cstdio> // remove
+#include <fstream>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(MappedFits_test)
+
+//-----------------------------------------------------------------------------
+
+/**
+ * @brief Make a fixed-format card.
+ */
+std::string card(const std::string& keyword, const std::string& value) {
+  std::string record = keyword;
+  record.resize(8, ' ');
+  record += "= " + std::string(value.size() < 20 ? 20 - value.size() : 0, ' ') + value + " / Comment";
+  record.resize(80, ' ');
+  return record;
+}
+
+/**
+ * @brief Pad a unit to the block size.
+ */
+std::string pad(std::string unit, char c) {
+  unit.resize((unit.size() + 2879) / 2880 * 2880, c);
+  return unit;
+}
+
+BOOST_AUTO_TEST_CASE(write_read_round_trip_test) {
+  const std::string filename = "/tmp/EleFourier_MappedFits_round_trip.fits";
+  const Fits::Position<2> shape {5, 3};
+  Fits::VecRaster<float> image(shape);
+  for (long i = 0; i < image.size(); ++i) {
+    image.data()[i] = 0.5F * i - 3;
+  }
+  {
+    auto output = MappedFits::create<float>(filename, shape, 2);
+    BOOST_TEST(output.hduCount() == 3);
+    output.write(1, image);
+    output.writeData(2, image.data());
+  }
+  MappedFits input(filename);
+  BOOST_TEST(input.hduCount() == 3);
+  BOOST_TEST(input.isImage(0));
+  BOOST_TEST(input.size(0) == 0);
+  BOOST_TEST(input.bitpix(1) == -32);
+  BOOST_TEST(input.shape(2) == std::vector<long>({5, 3}));
+  Fits::VecRaster<double> result(shape);
+  for (long i = 1; i < input.hduCount(); ++i) {
+    input.readTo(i, result);
+    for (long j = 0; j < image.size(); ++j) {
+      BOOST_TEST(result.data()[j] == image.data()[j]);
+    }
+  }
+  BOOST_CHECK_THROW(input.write(1, image), std::runtime_error); // Read-only
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(unsigned_integers_round_trip_test) {
+  const std::string filename = "/tmp/EleFourier_MappedFits_unsigned.fits";
+  const Fits::Position<2> shape {5, 1};
+  Fits::VecRaster<std::uint16_t> image(shape);
+  const std::vector<std::uint16_t> values {0, 1, 32767, 32768, 65535};
+  std::copy(values.begin(), values.end(), image.data());
+  Fits::VecRaster<std::uint32_t> wide(shape);
+  const std::vector<std::uint32_t> wideValues {0, 2147483647, 2147483648, 3000000000, 4294967295};
+  std::copy(wideValues.begin(), wideValues.end(), wide.data());
+  {
+    MappedFits::create<std::uint16_t>(filename, shape, 1).write(1, image);
+  }
+  MappedFits input(filename);
+  BOOST_TEST(input.bitpix(1) == 16);
+  Fits::VecRaster<std::uint16_t> result(shape);
+  input.readTo(1, result);
+  BOOST_TEST(std::vector<std::uint16_t>(result.data(), result.data() + result.size()) == values);
+  std::vector<double> physical(values.size());
+  input.readDataTo(1, physical.data());
+  BOOST_TEST(physical == std::vector<double>(values.begin(), values.end()));
+  {
+    MappedFits::create<std::uint32_t>(filename, shape, 1).write(1, wide);
+  }
+  Fits::VecRaster<std::uint32_t> wideResult(shape);
+  MappedFits(filename).readTo(1, wideResult);
+  BOOST_TEST(std::vector<std::uint32_t>(wideResult.data(), wideResult.data() + wideResult.size()) == wideValues);
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(scaled_integers_and_skipped_hdus_test) {
+  const std::string filename = "/tmp/EleFourier_MappedFits_scaled.fits";
+  {
+    std::ofstream file(filename, std::ios::binary);
+    file << pad(
+        card("SIMPLE", "T") + card("BITPIX", "16") + card("NAXIS", "2") + card("NAXIS1", "3") +
+            card("NAXIS2", "2") + card("BSCALE", "2.") + card("BZERO", "32768") + card("EXTEND", "T") + "END",
+        ' ');
+    std::string data;
+    for (int v : {-32768, -1, 0, 1, 2, 32767}) {
+      data += char((v >> 8) & 0xFF);
+      data += char(v & 0xFF);
+    }
+    file << pad(data, '\0');
+    file << pad(
+        card("XTENSION", "'BINTABLE'") + card("BITPIX", "8") + card("NAXIS", "2") + card("NAXIS1", "4") +
+            card("NAXIS2", "1000") + card("PCOUNT", "0") + card("GCOUNT", "1") + card("TFIELDS", "1") + "END",
+        ' ');
+    file << pad(std::string(4000, '\1'), '\0');
+    file << pad(
+        card("XTENSION", "'IMAGE   '") + card("BITPIX", "-64") + card("NAXIS", "1") + card("NAXIS1", "1") +
+            card("PCOUNT", "0") + card("GCOUNT", "1") + "END",
+        ' ');
+    file << pad(std::string("\x40\x09\x21\xfb\x54\x44\x2d\x18", 8), '\0'); // Pi
+  }
+  MappedFits input(filename);
+  BOOST_TEST(input.hduCount() == 3);
+  BOOST_TEST(input.shape(0) == std::vector<long>({3, 2}));
+  BOOST_TEST(not input.isImage(1));
+  BOOST_CHECK_THROW(input.size(1), std::runtime_error);
+  std::vector<double> values(6);
+  input.readDataTo(0, values.data());
+  const std::vector<double> expected {32768 - 65536, 32766, 32768, 32770, 32772, 32768 + 65534};
+  BOOST_TEST(values == expected);
+  double pi = 0;
+  input.readDataTo(2, &pi);
+  BOOST_TEST(std::abs(pi - 3.14159265358979) < 1e-12);
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(unsupported_bitpix_test) {
+  const std::string filename = "/tmp/EleFourier_MappedFits_bitpix.fits";
+  {
+    std::ofstream file(filename, std::ios::binary);
+    file << pad(card("SIMPLE", "T") + card("BITPIX", "24") + card("NAXIS", "1") + card("NAXIS1", "2") + "END", ' ');
+    file << pad(std::string(6, '\1'), '\0');
+  }
+  BOOST_CHECK_THROW(MappedFits input(filename), std::runtime_error); // Before any parallel decoding
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(padded_dft_buffer_test) {
+  const std::string filename = "/tmp/EleFourier_MappedFits_padded.fits";
+  const Fits::Position<2> shape {5, 4};
+  Fits::VecRaster<double> image(shape);
+  for (long i = 0; i < image.size(); ++i) {
+    image.data()[i] = i;
+  }
+  {
+    auto output = MappedFits::create<double>(filename, shape, 2);
+    output.write(1, image);
+    output.write(2, image);
+  }
+  MappedFits input(filename);
+  RealDft dft(shape, 2, PlanningPolicy().inPlace());
+  for (long i = 0; i < dft.count(); ++i) {
+    auto plane = dft.inBuffer(i);
+    BOOST_TEST(plane.shape()[0] == 6); // Padded rows
+    input.readTo(i + 1, plane);
+    for (long y = 0; y < shape[1]; ++y) {
+      for (long x = 0; x < shape[0]; ++x) {
+        BOOST_TEST((plane[{x, y}]) == x + y * shape[0]);
+      }
+    }
+  }
+  Fits::VecRaster<double> small({5, 3});
+  BOOST_CHECK_THROW(input.readTo(1, small), std::invalid_argument);
+  dft.transform();
+  BOOST_TEST(std::abs(dft.outBuffer(1)[{0, 0}] - 190.) < 1e-9);
+  std::remove(filename.c_str());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,124 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/MatrixDft.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(MatrixDft_test)
+
+//-----------------------------------------------------------------------------
+
+template <typename TRaster>
+void fill(TRaster& raster) {
+  for (long i = 0; i < raster.size(); ++i) {
+    raster.data()[i] = std::complex<double>((i * 3) % 7 - 3., (i * 5) % 11 % 3);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(naive_test) {
+  const Fits::Position<2> inShape {5, 4};
+  const Fits::Position<2> outShape {7, 3};
+  const std::array<double, 2> step {.13, .21};
+  MatrixDft mft(inShape, outShape, step, 2);
+  auto in = mft.inStack();
+  fill(in);
+  in[{1, 2, 0}] = 0; // Skipped value
+  mft.transform();
+  const auto out = mft.outStack();
+  const double twoPi = 2 * std::acos(-1.);
+  for (long k = 0; k < 2; ++k) {
+    for (long v = 0; v < outShape[1]; ++v) {
+      for (long u = 0; u < outShape[0]; ++u) {
+        std::complex<double> expected = 0;
+        for (long y = 0; y < inShape[1]; ++y) {
+          for (long x = 0; x < inShape[0]; ++x) {
+            const double phase = (x - 2) * (u - 3) * step[0] + (y - 2) * (v - 1) * step[1];
+            expected += in[{x, y, k}] * std::polar(1., -twoPi * phase);
+          }
+        }
+        BOOST_TEST(std::abs(out[{u, v, k}] - expected) < 1e-9);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dft_sampling_test) {
+  const Fits::Position<2> shape {8, 6};
+  MatrixDft mft(shape, shape, {1. / shape[0], 1. / shape[1]});
+  ComplexDft dft(shape);
+  auto in = mft.inBuffer();
+  fill(in);
+  std::copy_n(in.data(), in.size(), dft.inBuffer().data());
+  mft.transform();
+  dft.transform();
+  const auto out = mft.outBuffer();
+  const auto expected = dft.outBuffer();
+  for (long v = 0; v < shape[1]; ++v) {
+    for (long u = 0; u < shape[0]; ++u) {
+      const long fu = (u + shape[0] / 2) % shape[0];
+      const long fv = (v + shape[1] / 2) % shape[1];
+      BOOST_TEST(std::abs(std::abs(out[{u, v}]) - std::abs(expected[{fu, fv}])) < 1e-9); // Centering is a phase
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(inverse_test) {
+  const Fits::Position<2> shape {6, 6};
+  const std::array<double, 2> step {1. / shape[0], 1. / shape[1]};
+  MatrixDft direct(shape, shape, step);
+  MatrixDft inverse(shape, shape, {-step[0], -step[1]});
+  auto in = direct.inBuffer();
+  fill(in);
+  direct.transform();
+  std::copy_n(direct.outBuffer().data(), in.size(), inverse.inBuffer().data());
+  const auto out = inverse.transform().outBuffer();
+  for (long i = 0; i < in.size(); ++i) {
+    BOOST_TEST(std::abs(out.data()[i] / double(in.size()) - in.data()[i]) < 1e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(single_precision_phase_test) {
+  const Fits::Position<2> shape {601, 1};
+  const double step = .0123; // Up to 300 * 300 * step = 1107 turns
+  MatrixDftF mft(shape, shape, {step, 1.});
+  auto in = mft.inBuffer();
+  std::fill_n(in.data(), in.size(), 0.F);
+  in[{600, 0}] = 1; // Centered at 300
+  const auto out = mft.transform().outBuffer();
+  const double twoPi = 2 * std::acos(-1.);
+  for (long u = 0; u < shape[0]; ++u) {
+    const auto expected = std::polar(1., -twoPi * 300 * (u - 300) * step);
+    BOOST_TEST(std::abs(std::complex<double>(out[{u, 0}]) - expected) < 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(empty_shape_test) {
+  BOOST_CHECK_THROW(MatrixDft({0, 4}, {4, 4}, {.1, .1}), std::invalid_argument);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,114 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/MpiBroadbandPsf.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+/**
+ * @brief Initialize and finalize MPI around the test module.
+ */
+struct MpiFixture {
+  MpiFixture() {
+    MPI_Init(nullptr, nullptr);
+  }
+  ~MpiFixture() {
+    MPI_Finalize();
+  }
+};
+
+BOOST_GLOBAL_FIXTURE(MpiFixture);
+
+/**
+ * @brief A deterministic pupil function.
+ */
+void fillPupil(long p, long l, Fits::PtrRaster<std::complex<double>>& pupil) {
+  for (long y = 0; y < pupil.shape()[1]; ++y) {
+    for (long x = 0; x < pupil.shape()[0]; ++x) {
+      pupil[{x, y}] = std::complex<double>((x + 2 * y + p) % 5, (3 * x + y + l) % 7 - 3.);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(MpiBroadbandPsf_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(item_range_test) {
+  const long count = 11;
+  const int size = 4;
+  long begin = 0;
+  for (int r = 0; r < size; ++r) {
+    const auto range = MpiBroadbandPsf::itemRange(count, r, size);
+    BOOST_TEST(range.first == begin);
+    const long length = range.second - range.first;
+    BOOST_TEST((length == count / size || length == count / size + 1));
+    begin = range.second;
+  }
+  BOOST_TEST(begin == count);
+  const auto empty = MpiBroadbandPsf::itemRange(2, 0, 3);
+  BOOST_TEST(empty.first == empty.second);
+}
+
+BOOST_AUTO_TEST_CASE(serial_consistency_test) {
+  const long params = 3;
+  const long lambdas = 5;
+  MpiBroadbandPsf engine({8, 8}, {4, 4}, MPI_COMM_WORLD, 2);
+  long items = 0;
+  const auto psfs = engine.run(params, lambdas, [&](long p, long l, Fits::PtrRaster<std::complex<double>>& pupil) {
+#pragma omp atomic
+    ++items;
+    fillPupil(p, l, pupil);
+  });
+  const auto range = MpiBroadbandPsf::itemRange(params * lambdas, engine.rank(), engine.processes());
+  BOOST_TEST(items == range.second - range.first);
+  MPI_Allreduce(MPI_IN_PLACE, &items, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+  BOOST_TEST(items == params * lambdas);
+  if (engine.rank() == 0) {
+    BroadbandPsf serial({8, 8}, {4, 4}, 1);
+    const auto expected = serial.run(params, lambdas, fillPupil);
+    BOOST_TEST(psfs.shape()[2] == params);
+    for (long i = 0; i < psfs.size(); ++i) {
+      BOOST_TEST(psfs.data()[i] == expected.data()[i], boost::test_tools::tolerance(1e-9));
+    }
+  } else {
+    BOOST_TEST(psfs.shape()[2] == 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(remote_exception_test) {
+  MpiBroadbandPsf engine({4, 4}, {2, 2}, MPI_COMM_WORLD, 1);
+  // Item 0 belongs to process 0, which throws, and the others must throw too
+  BOOST_CHECK_THROW(
+      engine.run(2, 2, [](long p, long l, Fits::PtrRaster<std::complex<double>>&) {
+        if (p == 0 && l == 0) {
+          throw std::runtime_error("Invalid pupil");
+        }
+      }),
+      std::runtime_error);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/MpiDftPlan.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+/**
+ * @brief Initialize and finalize MPI around the test module.
+ */
+struct MpiFixture {
+  MpiFixture() {
+    MPI_Init(nullptr, nullptr);
+  }
+  ~MpiFixture() {
+    MPI_Finalize();
+  }
+};
+
+BOOST_GLOBAL_FIXTURE(MpiFixture);
+
+/**
+ * @brief Get the rank of the process in `MPI_COMM_WORLD`.
+ */
+int worldRank() {
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  return rank;
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(MpiDftPlan_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(slab_decomposition_test) {
+  const Fits::Position<2> shape {6, 7};
+  MpiRealDft dft(shape, PlanningPolicy::estimate());
+  BOOST_TEST((dft.outShape() == Fits::Position<2> {4, 7}));
+  const auto in = dft.inSlab();
+  const auto out = dft.outSlab();
+  BOOST_TEST(in.shape()[0] == 8); // Padded
+  BOOST_TEST(out.shape()[0] == 4);
+  BOOST_TEST(in.shape()[1] == dft.localRows());
+  BOOST_TEST(out.shape()[1] == dft.localRows());
+  long rows = dft.localRows();
+  MPI_Allreduce(MPI_IN_PLACE, &rows, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+  BOOST_TEST(rows == shape[1]);
+  long end = dft.firstRow() + dft.localRows();
+  long last = 0;
+  MPI_Allreduce(&end, &last, 1, MPI_LONG, MPI_MAX, MPI_COMM_WORLD);
+  BOOST_TEST(last == shape[1]);
+}
+
+BOOST_AUTO_TEST_CASE(complex_consistency_test) {
+  const Fits::Position<2> shape {5, 6};
+  MpiComplexDft dft(shape, PlanningPolicy::estimate());
+  ComplexDft reference(shape, 1, PlanningPolicy::estimate());
+  auto signal = reference.inBuffer();
+  for (const auto& p : signal.domain()) {
+    signal[p] = {std::cos(p[0] + 2. * p[1]), p[0] - .5 * p[1]};
+  }
+  Fits::VecRaster<std::complex<double>> coefficients(shape);
+  dft.scatter(signal).transform().gather(coefficients);
+  if (worldRank() == 0) {
+    const auto expected = reference.transform().outBuffer();
+    for (const auto& p : coefficients.domain()) {
+      BOOST_TEST(std::abs(coefficients[p] - expected[p]) < 1.e-9);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(real_round_trip_test) {
+  const Fits::Position<2> shape {7, 5};
+  MpiRealDft dft(shape, PlanningPolicy::estimate());
+  auto inverse = dft.inverse();
+  BOOST_TEST((inverse.inShape() == dft.outShape()));
+  BOOST_TEST(inverse.localRows() == dft.localRows());
+  auto slab = dft.inSlab();
+  for (long y = 0; y < slab.shape()[1]; ++y) {
+    for (long x = 0; x < shape[0]; ++x) {
+      slab[{x, y}] = 1 + x + 3 * (y + dft.firstRow());
+    }
+  }
+  dft.transform();
+  Fits::VecRaster<double> back(shape);
+  inverse.transform().normalize().gather(back);
+  if (worldRank() == 0) {
+    for (const auto& p : back.domain()) {
+      BOOST_TEST(std::abs(back[p] - (1 + p[0] + 3 * p[1])) < 1.e-9);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(single_precision_round_trip_test) {
+  const Fits::Position<2> shape {4, 6};
+  MpiComplexDftF dft(shape, PlanningPolicy::estimate());
+  auto inverse = dft.inverse();
+  Fits::VecRaster<std::complex<float>> signal(shape);
+  for (const auto& p : signal.domain()) {
+    signal[p] = {float(p[0]), float(p[1])};
+  }
+  Fits::VecRaster<std::complex<float>> back(shape);
+  dft.scatter(signal).transform();
+  inverse.transform().normalize().gather(back);
+  if (worldRank() == 0) {
+    for (const auto& p : back.domain()) {
+      BOOST_TEST(std::abs(back[p] - signal[p]) < 1.e-4);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(root_shape_check_test) {
+  MpiRealDft dft({4, 4}, PlanningPolicy::estimate());
+  Fits::VecRaster<double> wrong({3, 4});
+  BOOST_CHECK_THROW(dft.scatter(wrong), std::invalid_argument); // On all the processes
+  Fits::VecRaster<std::complex<double>> out({3, 4});
+  dft.gather(out);
+  Fits::VecRaster<std::complex<double>> transposed({4, 3});
+  BOOST_CHECK_THROW(dft.gather(transposed), std::invalid_argument);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/PlanStats.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(PlanStats_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(percentile_test) {
+  PlanCounters counters;
+  for (long i = 1; i <= 100; ++i) {
+    counters.recordTransform(i * 1.e-3, 10);
+  }
+  counters.recordPlanning(.5, 1.e6);
+  const auto summary = counters.summary();
+  BOOST_TEST(summary.plannings == 1);
+  BOOST_TEST(summary.planningTime == .5);
+  BOOST_TEST(summary.transforms == 100);
+  BOOST_TEST(summary.bytes == 1000);
+  BOOST_TEST(summary.mean() == .0505, boost::test_tools::tolerance(1.e-9));
+  BOOST_TEST(summary.p50 == .051, boost::test_tools::tolerance(1.e-9));
+  BOOST_TEST(summary.p90 == .090, boost::test_tools::tolerance(1.e-9));
+  BOOST_TEST(summary.p99 == .099, boost::test_tools::tolerance(1.e-9));
+  BOOST_TEST(summary.gflops() == 1.e6 * 100 / 5.05 * 1.e-9, boost::test_tools::tolerance(1.e-9));
+}
+
+BOOST_AUTO_TEST_CASE(circular_samples_test) {
+  PlanCounters counters;
+  for (long i = 0; i < PlanCounters::sampleCapacity; ++i) {
+    counters.recordTransform(1, 0);
+  }
+  for (long i = 0; i < PlanCounters::sampleCapacity; ++i) {
+    counters.recordTransform(2, 0);
+  }
+  const auto summary = counters.summary();
+  BOOST_TEST(summary.transforms == 2 * PlanCounters::sampleCapacity);
+  BOOST_TEST(summary.p50 == 2); // Oldest samples were overwritten
+}
+
+BOOST_AUTO_TEST_CASE(disabled_test) {
+  auto& stats = PlanStats::instance();
+  stats.disable();
+  stats.reset();
+  BOOST_TEST(not stats.counters("key"));
+  RealDft dft({8, 6});
+  dft.transform();
+  BOOST_TEST(stats.summaries().empty());
+}
+
+BOOST_AUTO_TEST_CASE(dft_plan_instrumentation_test) {
+  auto& stats = PlanStats::instance();
+  stats.reset();
+  stats.enable();
+  const Fits::Position<2> shape {10, 6};
+  const long count = 2;
+  {
+    ComplexDft dft(shape, count);
+    auto inverse = dft.inverse();
+    dft.transform();
+    dft.transform();
+    inverse.transform();
+  }
+  stats.disable();
+  const auto summaries = stats.summaries();
+  BOOST_TEST(summaries.size() == 2);
+  const auto& forward = summaries.at(FftwWisdom::key<ComplexDftType>(shape, count));
+  BOOST_TEST(forward.transforms == 2);
+  BOOST_TEST(forward.bytes == 2 * 2 * 16. * shape[0] * shape[1] * count);
+  BOOST_TEST(forward.flops > 0);
+  BOOST_TEST(forward.executeTime >= 0);
+  const auto& backward = summaries.at(FftwWisdom::key<Inverse<ComplexDftType>>(shape, count));
+  BOOST_TEST(backward.transforms == 1);
+  const auto json = stats.json();
+  BOOST_TEST(json.find("\"" + FftwWisdom::key<ComplexDftType>(shape, count) + "\": {") != std::string::npos);
+  BOOST_TEST(json.find("\"transforms\": 2") != std::string::npos);
+  BOOST_TEST(stats.report().find("2 transforms") != std::string::npos);
+  stats.reset();
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/PlanningPolicy.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(PlanningPolicy_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(default_is_measure_test) {
+  PlanningPolicy policy;
+  BOOST_TEST((policy.rigor == PlanningPolicy::Rigor::Measure));
+  BOOST_TEST(policy.timeLimit == FFTW_NO_TIMELIMIT);
+  BOOST_TEST(policy.flags() == FFTW_MEASURE);
+  BOOST_TEST(policy.name() == "Measure");
+}
+
+BOOST_AUTO_TEST_CASE(flags_test) {
+  BOOST_TEST(PlanningPolicy::estimate().flags() == FFTW_ESTIMATE);
+  BOOST_TEST(PlanningPolicy::patient().flags() == FFTW_PATIENT);
+  BOOST_TEST(PlanningPolicy::exhaustive().flags() == FFTW_EXHAUSTIVE);
+  BOOST_TEST(PlanningPolicy::estimate().preserveInput().flags() == (FFTW_ESTIMATE | FFTW_PRESERVE_INPUT));
+  BOOST_TEST(PlanningPolicy::patient().destroyInput().flags() == (FFTW_PATIENT | FFTW_DESTROY_INPUT));
+}
+
+BOOST_AUTO_TEST_CASE(time_limit_test) {
+  auto policy = PlanningPolicy::exhaustive().limit(2.5);
+  BOOST_TEST(policy.timeLimit == 2.5);
+  BOOST_TEST((policy == PlanningPolicy::exhaustive())); // Time limit is not part of the identity
+}
+
+BOOST_AUTO_TEST_CASE(parallelize_test) {
+  PlanningPolicy policy;
+  BOOST_TEST(policy.threads == 1);
+  policy.parallelize(4);
+  BOOST_TEST(policy.threads == 4);
+  BOOST_TEST(policy.name() == "Measure4Threads");
+  BOOST_TEST(policy.flags() == FFTW_MEASURE);
+  BOOST_TEST((policy != PlanningPolicy()));
+  policy.parallelize();
+  BOOST_TEST(policy.threads >= 1);
+}
+
+BOOST_AUTO_TEST_CASE(in_place_test) {
+  auto policy = PlanningPolicy::patient().inPlace();
+  BOOST_TEST(policy.isInPlace());
+  BOOST_TEST(not PlanningPolicy().isInPlace());
+  BOOST_TEST(policy.name() == "PatientInPlace");
+  BOOST_TEST(policy.flags() == FFTW_PATIENT);
+  BOOST_TEST((policy != PlanningPolicy::patient()));
+}
+
+BOOST_AUTO_TEST_CASE(name_round_trip_test) {
+  for (auto rigor :
+       {PlanningPolicy::Rigor::Estimate,
+        PlanningPolicy::Rigor::Measure,
+        PlanningPolicy::Rigor::Patient,
+        PlanningPolicy::Rigor::Exhaustive}) {
+    BOOST_TEST((PlanningPolicy::parseRigor(PlanningPolicy(rigor).name()) == rigor));
+  }
+  BOOST_CHECK_THROW(PlanningPolicy::parseRigor("Lazy"), std::invalid_argument);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,117 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/PrunedDft.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(PrunedDft_test)
+
+//-----------------------------------------------------------------------------
+
+/**
+ * @brief Check a pruned DFT against the full DFT, subsampled.
+ */
+template <typename TType>
+void checkPruned(
+    const Fits::Position<2>& shape,
+    const Fits::Position<2>& front,
+    const Fits::Position<2>& window,
+    long stride,
+    long count = 1) {
+  using Value = typename TType::InValue;
+  PrunedDft<TType> pruned(shape, front, window, stride, count);
+  DftPlan<TType> full(shape, count);
+  auto in = full.inStack();
+  std::fill_n(in.data(), in.size(), Value(0));
+  auto w = pruned.windowStack();
+  for (long k = 0; k < count; ++k) {
+    for (long y = 0; y < window[1]; ++y) {
+      for (long x = 0; x < window[0]; ++x) {
+        const Value v = Value(double((x * 3 + y * 5 + k * 7) % 13) - 6.);
+        w[{x, y, k}] = v;
+        in[{front[0] + x, front[1] + y, k}] = v;
+      }
+    }
+  }
+  pruned.transform().normalize();
+  full.transform().normalize();
+  const auto out = pruned.outStack();
+  const auto expected = full.outStack();
+  BOOST_TEST(out.shape()[0] == (full.outShape()[0] - 1) / stride + 1);
+  BOOST_TEST(out.shape()[1] == shape[1] / stride);
+  for (long k = 0; k < count; ++k) {
+    for (long v = 0; v < out.shape()[1]; ++v) {
+      for (long u = 0; u < out.shape()[0]; ++u) {
+        BOOST_TEST(std::abs(out[{u, v, k}] - expected[{u * stride, v * stride, k}]) < 1e-9);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(lazy_scaling_test) {
+  PrunedDft<ComplexDftType> pruned({8, 6}, {2, 1}, {4, 3}, 1);
+  auto w = pruned.windowStack();
+  std::fill_n(w.data(), w.size(), std::complex<double>(1));
+  pruned.transform().normalizeLazily();
+  BOOST_TEST(pruned.pendingScale() == 1. / 48);
+  BOOST_TEST(std::abs(pruned.outBuffer()[{0, 0}] - std::complex<double>(12)) < 1e-9); // Not applied yet
+  pruned.flush();
+  BOOST_TEST(pruned.pendingScale() == 1.);
+  BOOST_TEST(std::abs(pruned.outBuffer()[{0, 0}] - std::complex<double>(.25)) < 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(input_pruning_test) {
+  checkPruned<ComplexDftType>({8, 6}, {2, 1}, {4, 3}, 1);
+  checkPruned<RealDftType>({8, 6}, {2, 1}, {4, 3}, 1);
+}
+
+BOOST_AUTO_TEST_CASE(output_pruning_test) {
+  checkPruned<ComplexDftType>({8, 6}, {0, 0}, {8, 6}, 2);
+  checkPruned<RealDftType>({12, 6}, {0, 0}, {12, 6}, 3);
+}
+
+BOOST_AUTO_TEST_CASE(input_and_output_pruning_test) {
+  checkPruned<ComplexDftType>({8, 8}, {3, 1}, {5, 6}, 2, 2); // Window wraps around the folded plane
+  checkPruned<RealDftType>({8, 8}, {2, 2}, {4, 4}, 2, 2);
+}
+
+BOOST_AUTO_TEST_CASE(cost_ratio_test) {
+  const PrunedComplexDft windowed({16, 16}, {4, 4}, {8, 8});
+  BOOST_TEST(windowed.costRatio() < 1.);
+  const PrunedComplexDft subsampled({16, 16}, {4, 4}, {8, 8}, 2);
+  BOOST_TEST(subsampled.costRatio() < windowed.costRatio());
+  BOOST_TEST(subsampled.outShape()[0] == 8);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_parameters_test) {
+  BOOST_CHECK_THROW(PrunedComplexDft({8, 8}, {0, 0}, {8, 8}, 3), std::invalid_argument);
+  BOOST_CHECK_THROW(PrunedComplexDft({8, 8}, {4, 0}, {8, 8}), std::invalid_argument);
+  BOOST_CHECK_THROW(PrunedRealDft({8, 8}, {0, 0}, {0, 8}), std::invalid_argument);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,118 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/PupilPhase.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(PupilPhase_test)
+
+//-----------------------------------------------------------------------------
+
+struct PupilFixture {
+
+  PupilFixture() : mask({8, 6}), cube({3, 8, 6}), alphas {.1, -.2, .05} {
+    for (const auto& p : mask.domain()) {
+      const double u = p[0] - 3.5;
+      const double v = p[1] - 2.5;
+      mask[p] = u * u + v * v < 9 ? .5 + .1 * p[1] : 0;
+    }
+    for (const auto& p : cube.domain()) {
+      cube[p] = std::cos(p[0] + .3 * p[1] - .7 * p[2]);
+    }
+  }
+
+  /**
+   * @brief Reference scalar amplitude.
+   */
+  std::complex<double> expected(const Fits::Position<2>& p, double lambda) const {
+    double opd = 0;
+    for (long j = 0; j < 3; ++j) {
+      opd += cube[{j, p[0], p[1]}] * alphas[j];
+    }
+    return mask[p] * std::exp(std::complex<double>(0, -2 * std::acos(-1.) * opd / lambda));
+  }
+
+  Fits::VecRaster<double> mask;
+  Fits::VecRaster<double, 3> cube;
+  std::vector<double> alphas;
+};
+
+BOOST_FIXTURE_TEST_CASE(opd_test, PupilFixture) {
+  const SparsePupil sparse(mask, cube);
+  PupilPhase phase(sparse);
+  const auto& opd = phase.evalOpd(alphas);
+  BOOST_TEST(opd.size() == std::size_t(sparse.size()));
+  for (const auto& span : sparse.spans()) {
+    for (long i = 0; i < span.size; ++i) {
+      double sum = 0;
+      for (long j = 0; j < 3; ++j) {
+        sum += cube[{j, span.x + i, span.y}] * alphas[j];
+      }
+      BOOST_TEST(std::abs(opd[span.offset + i] - sum) < 1e-12);
+    }
+  }
+  BOOST_CHECK_THROW(phase.evalOpd({1., 2.}), std::invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE(amplitude_test, PupilFixture) {
+  const SparsePupil sparse(mask, cube);
+  PupilPhase phase(sparse);
+  phase.evalOpd(alphas);
+  Fits::VecRaster<std::complex<double>> plane({8, 6});
+  std::fill(plane.begin(), plane.end(), std::complex<double>(1, 1));
+  phase.evalAmplitude(.5, plane);
+  for (const auto& p : mask.domain()) {
+    BOOST_TEST(std::abs(plane[p] - expected(p, .5)) < 1e-12);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(amplitudes_test, PupilFixture) {
+  const SparsePupil sparse(mask, cube);
+  PupilPhase phase(sparse);
+  phase.evalOpd(alphas);
+  const std::vector<double> lambdas {.4, .6, .8};
+  Fits::VecRaster<std::complex<float>, 3> stack({9, 6, 3}); // Padded rows, single precision
+  phase.evalAmplitudes(lambdas, stack);
+  for (long k = 0; k < 3; ++k) {
+    for (const auto& p : mask.domain()) {
+      const std::complex<double> value = stack[{p[0], p[1], k}];
+      BOOST_TEST(std::abs(value - expected(p, lambdas[k])) < 1e-6);
+    }
+    BOOST_TEST((stack[{8, 0, k}]) == std::complex<float>(0));
+  }
+  Fits::VecRaster<std::complex<double>, 3> small({8, 6, 2});
+  BOOST_CHECK_THROW(phase.evalAmplitudes(lambdas, small), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(no_zernike_test) {
+  Fits::VecRaster<double> mask({2, 2});
+  mask[{0, 0}] = 1;
+  const SparsePupil sparse(mask);
+  BOOST_CHECK_THROW(PupilPhase {sparse}, std::invalid_argument);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,121 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/Dft.h"
+#include "EleFourier/Shift.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+/**
+ * @brief Make a stack whose values encode their position.
+ */
+Fits::VecRaster<double, 3> makeIndices(const Fits::Position<3>& shape) {
+  Fits::VecRaster<double, 3> raster(shape);
+  for (const auto& p : raster.domain()) {
+    raster[p] = p[0] + 10 * p[1] + 100 * p[2];
+  }
+  return raster;
+}
+
+/**
+ * @brief Check a centered crop against the periodic definition.
+ */
+void checkCenterCrop(const Fits::Position<3>& inShape, const Fits::Position<3>& outShape) {
+  const auto in = makeIndices(inShape);
+  Fits::VecRaster<double, 3> out(outShape);
+  centerCrop(in, out);
+  for (const auto& p : out.domain()) {
+    const long x = (p[0] - outShape[0] / 2 + inShape[0]) % inShape[0];
+    const long y = (p[1] - outShape[1] / 2 + inShape[1]) % inShape[1];
+    BOOST_TEST(out[p] == (in[{x, y, p[2]}]));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Shift_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(fftshift_test) {
+  checkCenterCrop({6, 4, 2}, {6, 4, 2});
+  checkCenterCrop({5, 3, 2}, {5, 3, 2});
+  const auto in = makeIndices({3, 1, 1});
+  Fits::VecRaster<double, 3> out({3, 1, 1});
+  centerCrop(in, out);
+  BOOST_TEST((out[{0, 0, 0}]) == 2); // Like numpy.fft.fftshift([0, 1, 2]) == [2, 0, 1]
+  BOOST_TEST((out[{1, 0, 0}]) == 0);
+  BOOST_TEST((out[{2, 0, 0}]) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(crop_test) {
+  checkCenterCrop({8, 6, 2}, {4, 3, 2});
+  checkCenterCrop({7, 5, 3}, {2, 5, 1});
+  const auto in = makeIndices({4, 4, 1});
+  Fits::VecRaster<double, 3> large({5, 4, 1});
+  BOOST_CHECK_THROW(centerCrop(in, large), std::invalid_argument);
+  Fits::VecRaster<double, 3> deep({4, 4, 2});
+  BOOST_CHECK_THROW(centerCrop(in, deep), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(fused_function_test) {
+  ComplexDft dft({5, 4});
+  auto in = dft.inBuffer();
+  for (const auto& p : in.domain()) {
+    in[p] = {double(p[0] * p[1]), double(p[0] - p[1])};
+  }
+  const auto amplitude = dft.transform().outBuffer();
+  Fits::VecRaster<double> intensity({5, 4});
+  centerCrop(amplitude, intensity, Norm2());
+  for (const auto& p : intensity.domain()) {
+    const Fits::Position<2> q {(p[0] + 3) % 5, (p[1] + 2) % 4};
+    BOOST_TEST(std::abs(intensity[p] - std::norm(amplitude[q])) < 1.e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(checkerboard_test) {
+  const Fits::Position<2> shape {6, 4};
+  ComplexDft modulated(shape);
+  ComplexDft reference(shape);
+  auto in = modulated.inBuffer();
+  auto ref = reference.inBuffer();
+  for (const auto& p : in.domain()) {
+    in[p] = {double(p[0] * p[1]), double(p[0] + 1)};
+    ref[p] = in[p];
+  }
+  checkerboard(in);
+  BOOST_TEST((in[{1, 0}]) == (-ref[{1, 0}]));
+  BOOST_TEST((in[{1, 1}]) == (ref[{1, 1}]));
+  const auto centered = modulated.transform().outBuffer();
+  auto shifted = reference.transform().outBuffer();
+  Fits::VecRaster<std::complex<double>> expected(shape);
+  centerCrop(shifted, expected);
+  for (const auto& p : expected.domain()) {
+    BOOST_TEST(std::abs(centered[p] - expected[p]) < 1.e-9);
+  }
+  Fits::VecRaster<double> odd({5, 4});
+  BOOST_CHECK_THROW(checkerboard(odd), std::invalid_argument);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+/**
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "EleFourier/SparsePupil.h"
+
+#include <algorithm> // find_if
+#include <boost/test/unit_test.hpp>
+
+using namespace Euclid;
+using namespace Fourier;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(SparsePupil_test)
+
+//-----------------------------------------------------------------------------
+
+Fits::VecRaster<double> makeMask() {
+  Fits::VecRaster<double> mask({6, 4});
+  for (const auto& p : mask.domain()) {
+    const double u = p[0] - 2.5;
+    const double v = p[1] - 1.5;
+    if (u * u + v * v < 4) {
+      mask[p] = 1. + p[0];
+    }
+  }
+  mask[{0, 3}] = 5; // Isolated point
+  return mask;
+}
+
+BOOST_AUTO_TEST_CASE(support_test) {
+  const auto mask = makeMask();
+  const SparsePupil sparse(mask);
+  long count = 0;
+  for (const auto& v : mask) {
+    count += v != 0;
+  }
+  BOOST_TEST(sparse.size() == count);
+  BOOST_TEST(sparse.fillFactor() == double(count) / mask.size());
+  BOOST_TEST(sparse.zernikeCount() == 0);
+  long offset = 0;
+  for (const auto& span : sparse.spans()) {
+    BOOST_TEST(span.offset == offset);
+    for (long i = 0; i < span.size; ++i) {
+      BOOST_TEST(sparse.values()[offset + i] == (mask[{span.x + i, span.y}]));
+    }
+    offset += span.size;
+  }
+  BOOST_TEST(offset == count);
+  const auto isolated = std::find_if(sparse.spans().begin(), sparse.spans().end(), [](const auto& span) {
+    return span.y == 3 && span.x == 0;
+  });
+  BOOST_TEST((isolated != sparse.spans().end()));
+  BOOST_TEST(isolated->size == 1);
+}
+
+BOOST_AUTO_TEST_CASE(zernike_compaction_test) {
+  const auto mask = makeMask();
+  Fits::VecRaster<double, 3> cube({3, 6, 4});
+  for (const auto& p : cube.domain()) {
+    cube[p] = p[0] + 10 * p[1] + 100 * p[2];
+  }
+  const SparsePupil sparse(mask, cube);
+  BOOST_TEST(sparse.zernikeCount() == 3);
+  for (const auto& span : sparse.spans()) {
+    for (long i = 0; i < span.size; ++i) {
+      for (long j = 0; j < 3; ++j) {
+        BOOST_TEST(sparse.zernike()[(span.offset + i) * 3 + j] == (cube[{j, span.x + i, span.y}]));
+      }
+    }
+  }
+  Fits::VecRaster<double, 3> wrong({3, 4, 6});
+  BOOST_CHECK_THROW(SparsePupil(mask, wrong), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(scatter_gather_test) {
+  const auto mask = makeMask();
+  const SparsePupil sparse(mask);
+  Fits::VecRaster<double> plane({8, 4}); // Padded rows
+  std::fill(plane.begin(), plane.end(), -1.);
+  sparse.scatter(sparse.values().data(), plane);
+  for (const auto& p : mask.domain()) {
+    BOOST_TEST((plane[p]) == (mask[p]));
+  }
+  BOOST_TEST((plane[{7, 0}]) == 0);
+  std::vector<double> values(sparse.size());
+  sparse.gather(plane, values.data());
+  BOOST_TEST(values == sparse.values());
+  Fits::VecRaster<double> small({5, 4});
+  BOOST_CHECK_THROW(sparse.scatter(values.data(), small), std::invalid_argument);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
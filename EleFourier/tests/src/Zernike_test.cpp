@@ -21,6 +21,7 @@
 #include "EleFourier/Zernike.h"
 
 #include <boost/test/unit_test.hpp>
+#include <cstdio> // remove
 
 using namespace Euclid;
 
@@ -46,6 +47,67 @@ BOOST_AUTO_TEST_CASE(save_zernikes_test) {
   f.writeRaster(zernike);
 }
 
+BOOST_AUTO_TEST_CASE(ansi_orders_test) {
+  for (long j = 0; j < 100; ++j) {
+    const auto orders = Zernike::ansiOrders(j);
+    BOOST_TEST(std::abs(orders.m) <= orders.n);
+    BOOST_TEST(Zernike::ansiIndex(orders.n, orders.m) == j);
+  }
+  BOOST_TEST(Zernike::ansiOrders(4).n == 2);
+  BOOST_TEST(Zernike::ansiOrders(4).m == 0);
+  BOOST_CHECK_THROW(Zernike::ansiIndex(3, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(recurrence_matches_explicit_polynomials_test) {
+  constexpr long side = 32;
+  constexpr long count = Zernike::LocalZernikeSeries::JCount;
+  const auto expected = Zernike::ansiCube(side, count);
+  const auto basis = Zernike::ansiBasis(side, count);
+  BOOST_TEST(basis.shape() == expected.shape());
+  for (long i = 0; i < basis.size(); ++i) {
+    BOOST_TEST(std::abs(basis.data()[i] - expected.data()[i]) < 1e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(arbitrary_order_test) {
+  constexpr long side = 24;
+  constexpr long count = 78; // Up to order 11
+  const auto basis = Zernike::ansiBasis(side, count);
+  const auto prefix = Zernike::ansiBasis(side, 10);
+  for (long v = 0; v < side; ++v) {
+    for (long u = 0; u < side; ++u) {
+      const double x = (u - .5 * side) / (.5 * side);
+      const double y = (v - .5 * side) / (.5 * side);
+      for (long j = 0; j < count; ++j) {
+        const auto value = basis[{j, u, v}];
+        if (x * x + y * y > 1) {
+          BOOST_TEST(value == 0);
+        } else {
+          BOOST_TEST(std::abs(value) <= 1 + 1e-9); // Unnormalized
+        }
+        if (j < 10) {
+          BOOST_TEST(value == (prefix[{j, u, v}]));
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(cache_test) {
+  const std::string directory = "/tmp";
+  const auto filename = Zernike::ansiBasisFilename(16, 12, directory);
+  std::remove(filename.c_str());
+  const auto generated = Zernike::cachedAnsiBasis(16, 12, directory);
+  const auto cached = Zernike::cachedAnsiBasis(16, 12, directory);
+  const auto expected = Zernike::ansiBasis(16, 12);
+  BOOST_TEST(cached.shape() == expected.shape());
+  for (long i = 0; i < expected.size(); ++i) {
+    BOOST_TEST(generated.data()[i] == expected.data()[i]);
+    BOOST_TEST(cached.data()[i] == expected.data()[i]);
+  }
+  std::remove(filename.c_str());
+}
+
 //-----------------------------------------------------------------------------
 
 BOOST_AUTO_TEST_SUITE_END()